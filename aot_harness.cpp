@@ -0,0 +1,234 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <csignal>
+#include <sys/wait.h>
+
+#include "compiler_pipeline.cpp"
+#include "sample_programs.cpp"
+#include "assembly_backend.cpp"
+#include "text_interpreter.cpp"
+#include "execution_outcome.cpp"
+
+/*
+    Prueba del backend de ensamblador con la herramienta del sistema.
+
+    Cada programa (los de sample_programs() y loop_programs() o los archivos fuente que se
+    pasen como argumentos) se compila dos veces a código nativo: el código intermedio sin
+    optimizar y el de optimize_code(). Cada versión se traduce con AssemblyBackend y se
+    enlaza con un programa en C generado que llama a la función indicada en la línea de
+    comandos e imprime su resultado. El compilador de C se toma de la variable CC (por
+    defecto cc). Los ejemplos optimizados suelen quedar reducidos a constantes, así que el
+    código sin optimizar es el que ejercita la mayor parte de la selección de instrucciones.
+
+    Cada función se ejecuta con los mismos argumentos fijos que use_example --check
+    (3, 5, 7, ...) y se compara con TextInterpreter sobre el código sin optimizar. Un
+    error en la referencia (por ejemplo una división entre cero) debe terminar el proceso
+    nativo con un código distinto de 0 o una señal. Si la referencia agota su pila o el
+    proceso nativo termina con SIGSEGV (agotó la suya) la función se informa con [LÍMITE]
+    y no cuenta como diferencia. El proceso termina con código 1 si alguna función no
+    coincide o si, con los programas incluidos, el backend no emitió nunca un salto con cmp,
+    un lea o un producto por constante.
+
+    Uso: aot_harness [programa.src ...]
+*/
+
+static const std::string symbol_prefix = "ir_";
+
+static void write_file(const std::string& path, const std::string& content) {
+    std::ofstream file(path);
+    if (!file) {
+        throw std::runtime_error("No se pudo escribir " + path);
+    }
+    file << content;
+}
+
+// Programa en C que llama a la función cuyo nombre recibe en argv[1] con los argumentos argv[2..]
+static std::string driver_source(const std::vector<Instruction>& functions) {
+    size_t max_parameters = 1;
+    for (const auto& function : functions) max_parameters = std::max(max_parameters, function.parameters.size());
+
+    std::ostringstream c;
+    c << "#include <stdio.h>\n#include <stdlib.h>\n#include <string.h>\n\n";
+    for (const auto& function : functions) {
+        c << "long long " << symbol_prefix << function.result << "(";
+        for (size_t i = 0; i < function.parameters.size(); i++) c << (i ? ", " : "") << "long long";
+        c << (function.parameters.empty() ? "void" : "") << ");\n";
+    }
+    c << "\nint main(int argc, char** argv) {\n";
+    c << "    long long a[" << max_parameters << "] = {0};\n";
+    c << "    if (argc < 2) return 2;\n";
+    c << "    for (int i = 2; i < argc && i - 2 < " << max_parameters << "; i++) a[i - 2] = strtoll(argv[i], 0, 10);\n";
+    for (const auto& function : functions) {
+        c << "    if (strcmp(argv[1], \"" << function.result << "\") == 0) {\n";
+        c << "        printf(\"%lld\\n\", " << symbol_prefix << function.result << "(";
+        for (size_t i = 0; i < function.parameters.size(); i++) c << (i ? ", " : "") << "a[" << i << "]";
+        c << "));\n        return 0;\n    }\n";
+    }
+    c << "    return 2;\n}\n";
+    return c.str();
+}
+
+// Función para ejecutar el binario y leer el valor impreso; salida distinta de 0 o señal -> error,
+// SIGSEGV (la pila del proceso agotada, directamente o informada por el shell) -> exhausted
+static Outcome run_native(const std::string& binary, const std::string& name, const std::vector<int64_t>& args) {
+    std::string command = binary + " " + name;
+    for (int64_t arg : args) command += " " + std::to_string(arg);
+    command += " 2>/dev/null";
+
+    Outcome outcome;
+    FILE* pipe = popen(command.c_str(), "r");
+    if (!pipe) {
+        outcome.error = true;
+        return outcome;
+    }
+    std::string output;
+    char buffer[256];
+    while (fgets(buffer, sizeof(buffer), pipe)) output += buffer;
+    int status = pclose(pipe);
+    if (status != -1 && ((WIFSIGNALED(status) && WTERMSIG(status) == SIGSEGV) ||
+                         (WIFEXITED(status) && WEXITSTATUS(status) == 128 + SIGSEGV))) {
+        outcome.error = outcome.exhausted = true;
+        return outcome;
+    }
+    if (status == -1 || !WIFEXITED(status) || WEXITSTATUS(status) != 0 || output.empty()) {
+        outcome.error = true;
+        return outcome;
+    }
+    outcome.value = std::stoll(output);
+    return outcome;
+}
+
+// Función para ensamblar una versión del código de un programa y comparar cada función con la referencia
+static int check_version(const std::string& label, const std::vector<std::string>& version,
+                         const std::vector<Instruction>& functions, TextInterpreter& reference,
+                         const std::string& prefix, AssemblyBackend::Stats& totals) {
+    AssemblyBackend::Options options;
+    options.symbol_prefix = symbol_prefix;
+    AssemblyBackend backend(options);
+    std::string assembly = backend.emit(version);
+
+    write_file(prefix + ".s", assembly);
+    write_file(prefix + ".c", driver_source(functions));
+    const char* cc = std::getenv("CC");
+    std::string command = std::string(cc ? cc : "cc") + " -o " + prefix + " " + prefix + ".c " + prefix + ".s";
+    if (std::system(command.c_str()) != 0) {
+        std::cout << "[FALLA] " << label << ": no se pudo ensamblar " << prefix << ".s" << std::endl;
+        return 1;
+    }
+
+    int failures = 0;
+    for (const auto& function : functions) {
+        // Argumentos fijos para que la prueba sea determinista
+        std::vector<int64_t> args;
+        for (size_t i = 0; i < function.parameters.size(); i++) args.push_back(static_cast<int64_t>(3 + 2 * i));
+
+        const std::string& name = function.result;
+        Outcome expected = execute([&] { return reference.run(name, args); });
+        Outcome native = run_native(prefix, name, args);
+
+        if (expected.exhausted || native.exhausted) {
+            // Límite de pila del intérprete o del proceso: no se puede comparar, pero no es una falla
+            std::cout << "[LÍMITE] " << label << ", " << name << ": referencia " << expected.to_string()
+                      << ", nativo " << native.to_string() << std::endl;
+        }
+        else if (native == expected) {
+            std::cout << "[OK] " << label << ", " << name << " = " << expected.to_string() << std::endl;
+        }
+        else {
+            std::cout << "[FALLA] " << label << ", " << name << ": referencia " << expected.to_string()
+                      << ", nativo " << native.to_string() << std::endl;
+            failures++;
+        }
+    }
+
+    const AssemblyBackend::Stats& stats = backend.last_stats();
+    std::cout << "    " << stats.instructions << " instrucciones, " << stats.fused_branches << " saltos con cmp, "
+              << stats.lea << " lea, " << stats.constant_multiplies << " por constante, " << stats.spill_slots
+              << " ranuras de derrame" << std::endl;
+    totals.fused_branches += stats.fused_branches;
+    totals.lea += stats.lea;
+    totals.constant_multiplies += stats.constant_multiplies;
+    return failures;
+}
+
+// Función para compilar un programa a código nativo, sin optimizar y optimizado
+static int check_program(size_t number, const std::string& program, const std::string& directory,
+                         AssemblyBackend::Stats& totals) {
+    std::vector<std::string> code = compile_source(program);
+    std::vector<std::string> optimized_code = optimize_code(code);
+
+    std::vector<Instruction> functions;
+    for (const auto& inst : parse_instructions(code)) {
+        if (inst.kind == InstructionKind::Proc) functions.push_back(inst);
+    }
+
+    TextInterpreter reference(code);
+    std::string label = "programa " + std::to_string(number);
+    std::string prefix = directory + "/programa" + std::to_string(number);
+    return check_version(label + " sin optimizar", code, functions, reference, prefix + "_original", totals) +
+           check_version(label, optimized_code, functions, reference, prefix, totals);
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<std::string> programs;
+    for (int i = 1; i < argc; i++) {
+        std::ifstream file(argv[i]);
+        if (!file) {
+            std::cerr << "No se pudo leer " << argv[i] << std::endl;
+            return 1;
+        }
+        std::stringstream source;
+        source << file.rdbuf();
+        programs.push_back(source.str());
+    }
+    bool builtin = programs.empty();
+    if (builtin) {
+        programs = sample_programs();
+        for (const auto& program : loop_programs()) programs.push_back(program.source);
+    }
+
+    char directory[] = "/tmp/aot_harness_XXXXXX";
+    if (!mkdtemp(directory)) {
+        std::cerr << "No se pudo crear el directorio temporal" << std::endl;
+        return 1;
+    }
+
+    int failures = 0;
+    AssemblyBackend::Stats totals;
+    for (size_t i = 0; i < programs.size(); i++) {
+        try {
+            failures += check_program(i, programs[i], directory, totals);
+        }
+        catch (const std::exception& e) {
+            std::cout << "[FALLA] programa " << i << ": " << e.what() << std::endl;
+            failures++;
+        }
+    }
+
+    // Los programas incluidos tienen comparaciones, sumas y productos por constante: si alguna
+    // selección no se usó nunca, el backend dejó de reconocer esos patrones
+    if (builtin) {
+        for (const auto& [count, selection] : {std::pair<int, const char*>{totals.fused_branches, "saltos con cmp"},
+                                               {totals.lea, "lea"},
+                                               {totals.constant_multiplies, "productos por constante"}}) {
+            if (count == 0) {
+                std::cout << "[FALLA] ningún programa usó " << selection << std::endl;
+                failures++;
+            }
+        }
+    }
+
+    if (failures == 0) {
+        std::system(("rm -rf " + std::string(directory)).c_str());
+    }
+    else {
+        std::cout << "Archivos generados en " << directory << std::endl;
+    }
+    std::cout << failures << " funciones con diferencias" << std::endl;
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,942 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <sstream>
+#include <cstdint>
+#include <stdexcept>
+
+#include "ir_instruction.cpp"
+#include "control_flow.cpp"
+#include "register_allocation.cpp"
+
+/*
+    Backend de código ensamblador x86-64 (sintaxis AT&T de GNU as) para el código intermedio.
+
+    A diferencia de JitCompiler, el resultado es texto que se ensambla con la herramienta del
+    sistema (cc -c programa.s) y se enlaza con cualquier programa en C. Cada PROC nombre es
+    un símbolo global con la convención System V (argumentos en rdi, rsi, rdx, rcx, r8, r9 y
+    en la pila a partir del séptimo, resultado en rax); cada ALIAS es otro símbolo global con
+    la misma dirección.
+
+    Asignación de ubicaciones:
+      - Los temporales pasan por LinearScanAllocator: los registros virtuales %rN van a los
+        registros rsi, rdi, r8, r9, r10, r11 (no preservados, se guardan en la pila solo si
+        siguen vivos después de un CALL) y las ranuras %sN al marco de la función.
+      - Las variables más usadas (cada uso dentro de un bucle pesa 8 veces más) van a los
+        registros preservados rbx, r12-r15; el resto vive en el marco.
+      - rax, rcx y rdx son registros de trabajo.
+
+    Selección de instrucciones: sumas y productos por 2, 3, 4, 5, 8 y 9 con lea, productos por
+    otras potencias de dos con shl y por constantes con imul de tres operandos, divisiones
+    entre potencias de dos con desplazamientos, comparaciones unidas a su salto (cmp + jcc,
+    incluido "t = a < b" seguido de "IF t GOTO") y comparaciones como valor con setcc. Un
+    temporal que solo se copia a una variable ("t = a + 1 / x = t") se calcula directamente
+    en la ubicación de la variable, y el prólogo solo pone en 0 las variables que el código
+    podría leer antes de escribirlas.
+
+    Una división entre cero ejecuta ud2 (el proceso termina con SIGILL); a / -1 se calcula
+    como -a, igual que en VirtualMachine.
+*/
+
+class AssemblyBackend {
+public:
+    struct Options {
+        std::string symbol_prefix;   // Prefijo de los símbolos globales (evita choques con main, printf...)
+        int temp_registers = 6;      // Registros para temporales (1 a 6); el resto se derrama al marco
+        int variable_registers = 5;  // Variables en registros preservados (0 a 5)
+    };
+
+    // Estadísticas de la última llamada a emit()
+    struct Stats {
+        int functions = 0;
+        int instructions = 0;        // Instrucciones de máquina emitidas
+        int fused_branches = 0;      // Comparaciones resueltas con cmp + jcc, sin valor intermedio
+        int lea = 0;                 // Sumas y productos por constante calculados con lea
+        int constant_multiplies = 0; // Productos y divisiones por constante con shl, sar o imul
+        int spill_slots = 0;         // Ranuras de derrame de temporales (suma de todas las funciones)
+        int register_variables = 0;  // Variables asignadas a registros preservados
+        int memory_variables = 0;    // Variables guardadas en el marco
+    };
+
+    AssemblyBackend() {}
+    AssemblyBackend(Options options) : options(options) {}
+
+    // Función para traducir el código intermedio a un archivo de ensamblador
+    std::string emit(const std::vector<std::string>& code) {
+        if (options.temp_registers < 1 || options.temp_registers > 6) {
+            throw std::runtime_error("temp_registers debe estar entre 1 y 6");
+        }
+        stats = Stats();
+        out.str("");
+        out.clear();
+        functions.clear();
+        local_labels = 0;
+
+        // Las comparaciones que solo alimentan un salto se unen a él antes de asignar registros
+        std::vector<Instruction> instructions = fuse_conditions(parse_instructions(code));
+        LinearScanAllocator::Options allocation;
+        allocation.max_registers = options.temp_registers;
+        LinearScanAllocator allocator(allocation);
+        instructions = parse_instructions(allocator.allocate(format_instructions(instructions)));
+        std::vector<std::pair<size_t, size_t>> ranges = function_ranges(instructions);
+
+        for (const auto& range : ranges) {
+            const Instruction& header = instructions[range.first];
+            if (functions.count(header.result)) {
+                throw std::runtime_error("Función " + header.result + " definida más de una vez");
+            }
+            functions[header.result] = static_cast<int>(header.parameters.size());
+        }
+        std::vector<std::pair<std::string, std::string>> aliases;
+        for (const auto& inst : instructions) {
+            if (inst.kind != InstructionKind::Alias) continue;
+            auto target = functions.find(inst.callee);
+            if (target == functions.end()) {
+                throw std::runtime_error("ALIAS " + inst.result + " hacia una función inexistente: " + inst.callee);
+            }
+            aliases.push_back({inst.result, inst.callee});
+        }
+        for (const auto& [alias, target] : aliases) functions[alias] = functions[target];
+
+        out << "\t.text\n";
+        for (const auto& range : ranges) {
+            emit_function(instructions, range.first, range.second);
+        }
+        for (const auto& [alias, target] : aliases) {
+            std::string symbol = options.symbol_prefix + alias;
+            out << "\t.globl " << symbol << "\n";
+            out << "\t.type " << symbol << ", @function\n";
+            out << "\t.set " << symbol << ", " << options.symbol_prefix << target << "\n";
+        }
+        out << "\t.section .note.GNU-stack,\"\",@progbits\n";
+
+        stats.functions = static_cast<int>(ranges.size());
+        return out.str();
+    }
+
+    const Stats& last_stats() const {
+        return stats;
+    }
+
+private:
+    Options options;
+    Stats stats;
+    std::ostringstream out;
+    std::unordered_map<std::string, int> functions; // Nombre (o alias) -> número de parámetros
+    int local_labels = 0;
+
+    enum Reg { RAX = 0, RCX, RDX, RBX, RSP, RBP, RSI, RDI, R8, R9, R10, R11, R12, R13, R14, R15 };
+
+    static constexpr int argument_registers[6] = {RDI, RSI, RDX, RCX, R8, R9};
+    static constexpr int temp_register_set[6] = {RSI, RDI, R8, R9, R10, R11};
+    static constexpr int variable_registers[5] = {RBX, R12, R13, R14, R15};
+
+    static std::string reg64(int reg) {
+        static const char* names[] = {"rax", "rcx", "rdx", "rbx", "rsp", "rbp", "rsi", "rdi",
+                                      "r8",  "r9",  "r10", "r11", "r12", "r13", "r14", "r15"};
+        return std::string("%") + names[reg];
+    }
+
+    static std::string reg32(int reg) {
+        static const char* names[] = {"eax", "ecx", "edx", "ebx", "esp", "ebp", "esi", "edi",
+                                      "r8d", "r9d", "r10d", "r11d", "r12d", "r13d", "r14d", "r15d"};
+        return std::string("%") + names[reg];
+    }
+
+    static bool fits_int32(int64_t value) { return value >= INT32_MIN && value <= INT32_MAX; }
+
+    // Exponente de value si es una potencia de dos positiva, -1 si no lo es
+    static int power_of_two(int64_t value) {
+        if (value <= 0 || (value & (value - 1)) != 0) return -1;
+        int shift = 0;
+        while ((int64_t(1) << shift) != value) shift++;
+        return shift;
+    }
+
+    // Ubicación de un operando: constante, registro o posición en el marco (disp(%rbp))
+    struct Location {
+        enum Kind { Immediate, Register, Memory } kind = Immediate;
+        int64_t value = 0;
+        int reg = RAX;
+        int32_t disp = 0;
+
+        bool is_register(int r) const { return kind == Register && reg == r; }
+        bool is_immediate() const { return kind == Immediate; }
+    };
+
+    static Location in_register(int reg) {
+        Location loc;
+        loc.kind = Location::Register;
+        loc.reg = reg;
+        return loc;
+    }
+
+    static Location immediate(int64_t value) {
+        Location loc;
+        loc.value = value;
+        return loc;
+    }
+
+    // Texto del operando; las constantes deben caber en 32 bits (ver operand())
+    static std::string text(const Location& loc) {
+        if (loc.kind == Location::Immediate) return "$" + std::to_string(loc.value);
+        if (loc.kind == Location::Register) return reg64(loc.reg);
+        return std::to_string(loc.disp) + "(%rbp)";
+    }
+
+    struct FunctionState {
+        std::string name;
+        std::unordered_map<std::string, Location> variables; // Variables, %rN y %sN
+        std::vector<int> saved_registers;
+        int32_t pending_base = 0; // disp del primer argumento pendiente (PARAM)
+        bool division_by_zero = false;
+    };
+
+    // Sección de emisión de texto -> begin
+
+    void instruction(const std::string& mnemonic, const std::string& operands = "") {
+        out << "\t" << mnemonic;
+        if (!operands.empty()) out << "\t" << operands;
+        out << "\n";
+        stats.instructions++;
+    }
+
+    void label(const std::string& name) {
+        out << name << ":\n";
+    }
+
+    std::string local_label(const FunctionState& state, const std::string& name) const {
+        return ".L" + options.symbol_prefix + state.name + "_" + name;
+    }
+
+    std::string new_local_label(const FunctionState& state) {
+        return local_label(state, "x" + std::to_string(local_labels++));
+    }
+
+    std::string division_label(FunctionState& state) {
+        state.division_by_zero = true;
+        return local_label(state, "div0");
+    }
+
+    // Nota: con valor 0 se usa xor, que modifica las banderas
+    void load(int reg, const Location& loc) {
+        if (loc.kind == Location::Immediate) {
+            if (loc.value == 0) instruction("xorl", reg32(reg) + ", " + reg32(reg));
+            else if (fits_int32(loc.value)) instruction("movq", text(loc) + ", " + reg64(reg));
+            else instruction("movabsq", "$" + std::to_string(loc.value) + ", " + reg64(reg));
+        }
+        else if (!loc.is_register(reg)) {
+            instruction("movq", text(loc) + ", " + reg64(reg));
+        }
+    }
+
+    void store(const Location& dst, int reg) {
+        if (!dst.is_register(reg)) instruction("movq", reg64(reg) + ", " + text(dst));
+    }
+
+    // Operando fuente de una instrucción ALU: las constantes de más de 32 bits pasan por scratch
+    Location operand(const Location& loc, int scratch) {
+        if (loc.kind == Location::Immediate && !fits_int32(loc.value)) {
+            load(scratch, loc);
+            return in_register(scratch);
+        }
+        return loc;
+    }
+
+    // Deja las banderas como "test a, a" (las constantes pasan por scratch)
+    void test(const Location& a, int scratch = RAX) {
+        if (a.kind == Location::Register) {
+            instruction("testq", reg64(a.reg) + ", " + reg64(a.reg));
+        }
+        else if (a.kind == Location::Memory) {
+            instruction("cmpq", "$0, " + text(a));
+        }
+        else {
+            load(scratch, a);
+            instruction("testq", reg64(scratch) + ", " + reg64(scratch));
+        }
+    }
+
+    // Sección de emisión de texto -> end
+
+    // Sección de preparación -> begin
+
+    // Función para unir "t = a relop b" con el "IF t GOTO" / "IF_FALSE t GOTO" siguiente
+    // cuando t es un temporal que no se usa en ningún otro lugar de la función
+    std::vector<Instruction> fuse_conditions(const std::vector<Instruction>& code) {
+        std::vector<Instruction> result;
+        std::vector<std::pair<size_t, size_t>> ranges = function_ranges(code);
+        size_t next = 0;
+        for (const auto& range : ranges) {
+            for (; next < range.first; next++) result.push_back(code[next]);
+
+            std::unordered_map<std::string, int> uses;
+            for (size_t i = range.first; i < range.second; i++) {
+                for (const auto& name : code[i].uses()) {
+                    if (is_temp(name)) uses[name]++;
+                }
+            }
+            for (size_t i = range.first; i < range.second; i++) {
+                const Instruction& inst = code[i];
+                std::string cc;
+                if (inst.kind == InstructionKind::Binary && is_temp(inst.result) && uses[inst.result] == 1 &&
+                    relational_condition(canonical_operator(inst.op), cc) && i + 1 < range.second) {
+                    const Instruction& branch = code[i + 1];
+                    if ((branch.kind == InstructionKind::If || branch.kind == InstructionKind::IfFalse) &&
+                        branch.op.empty() && branch.arg1 == inst.result) {
+                        Instruction fused = branch;
+                        fused.arg1 = inst.arg1;
+                        fused.op = inst.op;
+                        fused.arg2 = inst.arg2;
+                        result.push_back(fused);
+                        i++;
+                        continue;
+                    }
+                }
+                result.push_back(inst);
+            }
+            next = range.second;
+        }
+        for (; next < code.size(); next++) result.push_back(code[next]);
+        return result;
+    }
+
+    // Índice del registro de temporales para un nombre %rN, -1 si no es un registro asignado
+    int temp_index(const std::string& name) const {
+        long long n = register_number(name);
+        return (n >= 0 && n < options.temp_registers) ? static_cast<int>(n) : -1;
+    }
+
+    // Registros de temporales vivos después de cada instrucción (máscara de bits por posición)
+    std::vector<uint32_t> live_registers(const std::vector<Instruction>& code, size_t begin, size_t end) const {
+        std::vector<uint32_t> live_after(end - begin, 0);
+        ControlFlowGraph cfg(code, begin, end);
+        size_t block_count = cfg.blocks.size();
+
+        auto mask = [&](const std::string& name) -> uint32_t {
+            int index = temp_index(name);
+            return (index >= 0) ? (uint32_t(1) << index) : 0;
+        };
+        auto uses_mask = [&](const Instruction& inst) {
+            uint32_t bits = 0;
+            for (const auto& name : inst.uses()) bits |= mask(name);
+            return bits;
+        };
+
+        std::vector<uint32_t> use(block_count, 0), def(block_count, 0);
+        for (size_t b = 0; b < block_count; b++) {
+            for (size_t i = cfg.blocks[b].begin; i < cfg.blocks[b].end; i++) {
+                use[b] |= uses_mask(code[i]) & ~def[b];
+                def[b] |= mask(code[i].defined());
+            }
+        }
+
+        std::vector<uint32_t> live_in(block_count, 0), live_out(block_count, 0);
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            for (size_t b = block_count; b-- > 0;) {
+                uint32_t out_bits = 0;
+                for (size_t s : cfg.blocks[b].successors) out_bits |= live_in[s];
+                uint32_t in_bits = use[b] | (out_bits & ~def[b]);
+                if (in_bits != live_in[b] || out_bits != live_out[b]) {
+                    live_in[b] = in_bits;
+                    live_out[b] = out_bits;
+                    changed = true;
+                }
+            }
+        }
+
+        for (size_t b = 0; b < block_count; b++) {
+            uint32_t live = live_out[b];
+            for (size_t i = cfg.blocks[b].end; i-- > cfg.blocks[b].begin;) {
+                live_after[i - begin] = live;
+                live = (live & ~mask(code[i].defined())) | uses_mask(code[i]);
+            }
+        }
+        return live_after;
+    }
+
+    // Variables que el código que empieza la función (hasta la primera etiqueta o salto)
+    // escribe antes de leerlas: no hace falta ponerlas en 0 en el prólogo
+    static std::unordered_map<std::string, bool> assigned_before_read(const std::vector<Instruction>& code,
+                                                                      size_t begin, size_t end) {
+        std::unordered_map<std::string, bool> assigned; // Nombre -> escrito antes de leerse
+        for (size_t i = begin + 1; i + 1 < end; i++) {
+            const Instruction& inst = code[i];
+            if (inst.kind == InstructionKind::Label || inst.is_jump() || inst.ends_flow()) break;
+            for (const auto& name : inst.uses()) assigned.emplace(name, false);
+            std::string def = inst.defined();
+            if (!def.empty()) assigned.emplace(def, true);
+        }
+        for (auto it = assigned.begin(); it != assigned.end();) {
+            if (it->second) ++it;
+            else it = assigned.erase(it);
+        }
+        return assigned;
+    }
+
+    // Indica si inst escribe un registro de temporales que solo lee la copia siguiente
+    bool copied_and_dead(const Instruction& inst, const Instruction& copy, uint32_t live_after_copy) const {
+        if (inst.kind != InstructionKind::Binary && inst.kind != InstructionKind::Unary &&
+            inst.kind != InstructionKind::Copy && inst.kind != InstructionKind::Call) {
+            return false;
+        }
+        int index = temp_index(inst.result);
+        return index >= 0 && copy.kind == InstructionKind::Copy && copy.arg1 == inst.result &&
+               copy.result != inst.result && !(live_after_copy & (uint32_t(1) << index));
+    }
+
+    // Sección de preparación -> end
+
+    void emit_function(const std::vector<Instruction>& code, size_t begin, size_t end) {
+        FunctionState state;
+        state.name = code[begin].result;
+        const std::vector<std::string>& parameters = code[begin].parameters;
+
+        // Profundidad de bucle de cada instrucción: un salto hacia atrás delimita un bucle
+        std::unordered_map<std::string, size_t> label_positions;
+        for (size_t i = begin + 1; i + 1 < end; i++) {
+            if (code[i].kind == InstructionKind::Label) label_positions[code[i].label] = i;
+        }
+        std::vector<int> depth(end - begin, 0);
+        for (size_t i = begin + 1; i + 1 < end; i++) {
+            if (!code[i].is_jump()) continue;
+            auto target = label_positions.find(code[i].label);
+            if (target == label_positions.end() || target->second > i) continue;
+            for (size_t j = target->second; j <= i; j++) depth[j - begin]++;
+        }
+
+        // Variables del programa (no %rN/%sN) con su peso y temporales derramados
+        std::vector<std::string> names(parameters.begin(), parameters.end());
+        std::unordered_map<std::string, uint64_t> weights;
+        for (const auto& param : parameters) weights[param] = 0;
+        long long spill_slots = 0;
+        int pending = 0, max_pending = 0;
+        for (size_t i = begin + 1; i + 1 < end; i++) {
+            const Instruction& inst = code[i];
+            if (inst.kind == InstructionKind::Raw || inst.kind == InstructionKind::Proc || inst.kind == InstructionKind::Alias) {
+                throw std::runtime_error("Instrucción no soportada por el backend: " + inst.to_string());
+            }
+            uint64_t weight = uint64_t(1) << (3 * std::min(depth[i - begin], 6));
+            std::vector<std::string> operands = inst.uses();
+            if (!inst.defined().empty()) operands.push_back(inst.defined());
+            for (const auto& name : operands) {
+                if (!is_variable(name) || temp_index(name) >= 0) continue;
+                long long slot = spill_slot_number(name);
+                if (slot >= 0) {
+                    spill_slots = std::max(spill_slots, slot + 1);
+                    continue;
+                }
+                if (!weights.count(name)) names.push_back(name);
+                weights[name] += weight;
+            }
+            if (inst.kind == InstructionKind::Param) max_pending = std::max(max_pending, ++pending);
+            if (inst.kind == InstructionKind::Call) pending = std::max(0, pending - inst.arg_count);
+        }
+
+        std::vector<std::string> by_weight = names;
+        std::stable_sort(by_weight.begin(), by_weight.end(), [&](const std::string& a, const std::string& b) {
+            return weights[a] > weights[b];
+        });
+        int register_count = std::min<int>({options.variable_registers, 5, static_cast<int>(by_weight.size())});
+        register_count = std::max(register_count, 0);
+        for (int r = 0; r < register_count; r++) {
+            state.variables[by_weight[r]] = in_register(variable_registers[r]);
+            state.saved_registers.push_back(variable_registers[r]);
+        }
+
+        // Marco: registros preservados, variables, ranuras de derrame y argumentos pendientes.
+        // Los parámetros a partir del séptimo se quedan en la pila del llamador.
+        int32_t saved_bytes = 8 * static_cast<int32_t>(state.saved_registers.size());
+        int32_t slots = 0;
+        auto frame_slot = [&]() {
+            Location loc;
+            loc.kind = Location::Memory;
+            loc.disp = -(saved_bytes + 8 * (++slots));
+            return loc;
+        };
+        for (size_t i = 6; i < parameters.size(); i++) {
+            if (state.variables.count(parameters[i])) continue;
+            Location loc;
+            loc.kind = Location::Memory;
+            loc.disp = static_cast<int32_t>(16 + 8 * (i - 6));
+            state.variables[parameters[i]] = loc;
+        }
+        for (const auto& name : names) {
+            if (!state.variables.count(name)) state.variables[name] = frame_slot();
+        }
+        for (long long s = 0; s < spill_slots; s++) state.variables[spill_slot_name(s)] = frame_slot();
+        for (int r = 0; r < options.temp_registers; r++) {
+            state.variables[register_name(r)] = in_register(temp_register_set[r]);
+        }
+        state.pending_base = -(saved_bytes + 8 * (slots + max_pending));
+        slots += max_pending;
+        stats.register_variables += register_count;
+        stats.memory_variables += static_cast<int>(names.size()) - register_count;
+        stats.spill_slots += static_cast<int>(spill_slots);
+
+        // Prólogo: marco alineado a 16 bytes, parámetros y variables en 0 (salvo las que el
+        // comienzo de la función escribe antes de leerlas)
+        std::string symbol = options.symbol_prefix + state.name;
+        out << "\t.p2align 4\n";
+        out << "\t.globl " << symbol << "\n";
+        out << "\t.type " << symbol << ", @function\n";
+        label(symbol);
+        instruction("pushq", "%rbp");
+        instruction("movq", "%rsp, %rbp");
+        for (int reg : state.saved_registers) instruction("pushq", reg64(reg));
+        int32_t frame = 8 * slots;
+        if ((saved_bytes + frame) % 16) frame += 8;
+        if (frame) instruction("subq", "$" + std::to_string(frame) + ", %rsp");
+
+        for (size_t i = 0; i < parameters.size(); i++) {
+            const Location& loc = state.variables.at(parameters[i]);
+            if (i < 6) {
+                store(loc, argument_registers[i]);
+            }
+            else if (loc.kind == Location::Register) {
+                instruction("movq", std::to_string(16 + 8 * (i - 6)) + "(%rbp), " + reg64(loc.reg));
+            }
+        }
+        std::unordered_map<std::string, bool> assigned_first = assigned_before_read(code, begin, end);
+        for (size_t v = parameters.size(); v < names.size(); v++) {
+            if (assigned_first.count(names[v])) continue;
+            const Location& loc = state.variables.at(names[v]);
+            if (loc.kind == Location::Register) load(loc.reg, immediate(0));
+            else instruction("movq", "$0, " + text(loc));
+        }
+
+        std::vector<uint32_t> live_after = live_registers(code, begin, end);
+        pending = 0;
+        for (size_t i = begin + 1; i + 1 < end; i++) {
+            // "%rN = ..." seguido de "x = %rN" con %rN muerto después: se calcula directamente en x
+            if (i + 2 < end && copied_and_dead(code[i], code[i + 1], live_after[i + 1 - begin])) {
+                Instruction fused = code[i];
+                fused.result = code[i + 1].result;
+                emit_instruction(fused, state, pending, live_after[i + 1 - begin], i + 3 == end);
+                i++;
+                continue;
+            }
+            bool last = (i + 2 == end);
+            emit_instruction(code[i], state, pending, live_after[i - begin], last);
+        }
+
+        // Llegar a ENDP devuelve 0; luego el epílogo común de los RETURN
+        if (!(end - begin > 2 && code[end - 2].kind == InstructionKind::Return)) {
+            instruction("xorl", "%eax, %eax");
+        }
+        label(local_label(state, "ret"));
+        if (!state.saved_registers.empty()) {
+            instruction("leaq", std::to_string(-saved_bytes) + "(%rbp), %rsp");
+            for (auto it = state.saved_registers.rbegin(); it != state.saved_registers.rend(); ++it) {
+                instruction("popq", reg64(*it));
+            }
+        }
+        else {
+            instruction("movq", "%rbp, %rsp");
+        }
+        instruction("popq", "%rbp");
+        instruction("ret");
+        if (state.division_by_zero) {
+            label(division_label(state));
+            instruction("ud2");
+        }
+        out << "\t.size " << symbol << ", .-" << symbol << "\n";
+    }
+
+    Location location(const FunctionState& state, const std::string& operand) const {
+        if (operand.empty()) return immediate(0); // RETURN sin valor
+        if (is_constant(operand)) return immediate(std::stoll(operand));
+        auto it = state.variables.find(operand);
+        if (it == state.variables.end()) {
+            throw std::runtime_error("Operando sin ubicación en la función " + state.name + ": " + operand);
+        }
+        return it->second;
+    }
+
+    void emit_instruction(const Instruction& inst, FunctionState& state, int& pending, uint32_t live_after, bool last) {
+        switch (inst.kind) {
+            case InstructionKind::Label:
+                label(local_label(state, inst.label));
+                break;
+            case InstructionKind::Goto:
+                instruction("jmp", local_label(state, inst.label));
+                break;
+            case InstructionKind::If:
+            case InstructionKind::IfFalse:
+                emit_branch(inst, state);
+                break;
+            case InstructionKind::Return:
+                load(RAX, location(state, inst.arg1));
+                if (!last) instruction("jmp", local_label(state, "ret"));
+                break;
+            case InstructionKind::Copy: {
+                Location dst = location(state, inst.result);
+                Location src = location(state, inst.arg1);
+                if (dst.kind == Location::Register) {
+                    load(dst.reg, src);
+                }
+                else if (src.kind == Location::Register || (src.is_immediate() && fits_int32(src.value))) {
+                    instruction("movq", text(src) + ", " + text(dst));
+                }
+                else if (!(src.kind == Location::Memory && src.disp == dst.disp)) {
+                    load(RAX, src);
+                    store(dst, RAX);
+                }
+                break;
+            }
+            case InstructionKind::Binary:
+                emit_binary(canonical_operator(inst.op), location(state, inst.arg1), location(state, inst.arg2),
+                            location(state, inst.result), state);
+                break;
+            case InstructionKind::Unary: {
+                Location dst = location(state, inst.result);
+                Location src = location(state, inst.arg1);
+                int reg = (dst.kind == Location::Register) ? dst.reg : RAX;
+                if (src.is_immediate()) {
+                    long long value = 0;
+                    evaluate_unary(inst.op, src.value, value);
+                    load(reg, immediate(value));
+                }
+                else if (inst.op == "-") {
+                    load(reg, src);
+                    instruction("negq", reg64(reg));
+                }
+                else {
+                    test(src);
+                    instruction("sete", "%al");
+                    instruction("movzbl", "%al, " + reg32(reg));
+                }
+                store(dst, reg);
+                break;
+            }
+            case InstructionKind::Param: {
+                Location src = location(state, inst.arg1);
+                Location slot;
+                slot.kind = Location::Memory;
+                slot.disp = state.pending_base + 8 * pending++;
+                if (src.kind == Location::Register || (src.is_immediate() && fits_int32(src.value))) {
+                    instruction("movq", text(src) + ", " + text(slot));
+                }
+                else {
+                    load(RAX, src);
+                    store(slot, RAX);
+                }
+                break;
+            }
+            case InstructionKind::Call:
+                emit_call(inst, state, pending, live_after);
+                break;
+            default:
+                throw std::runtime_error("Instrucción no soportada por el backend: " + inst.to_string());
+        }
+    }
+
+    void emit_call(const Instruction& inst, FunctionState& state, int& pending, uint32_t live_after) {
+        auto callee = functions.find(inst.callee);
+        if (callee == functions.end()) {
+            throw std::runtime_error("Llamada a una función no definida: " + inst.callee);
+        }
+        int n = inst.arg_count;
+        if (n != callee->second) {
+            throw std::runtime_error("La función " + inst.callee + " espera " + std::to_string(callee->second) +
+                                     " argumentos y se llama con " + std::to_string(n));
+        }
+        if (n > pending) {
+            throw std::runtime_error("CALL " + inst.callee + " sin sus PARAM en la función " + state.name);
+        }
+
+        // Se guardan los registros de temporales que siguen vivos después de la llamada
+        int result = temp_index(inst.result);
+        if (result >= 0) live_after &= ~(uint32_t(1) << result);
+        std::vector<int> saved;
+        for (int r = 0; r < options.temp_registers; r++) {
+            if (live_after & (uint32_t(1) << r)) saved.push_back(temp_register_set[r]);
+        }
+        for (int reg : saved) instruction("pushq", reg64(reg));
+
+        int first = pending - n;
+        int extra = std::max(0, n - 6);
+        int32_t cleanup = 8 * extra;
+        if ((extra + saved.size()) % 2) {
+            instruction("subq", "$8, %rsp");
+            cleanup += 8;
+        }
+        for (int a = n - 1; a >= 6; a--) {
+            instruction("pushq", std::to_string(state.pending_base + 8 * (first + a)) + "(%rbp)");
+        }
+        for (int a = 0; a < std::min(n, 6); a++) {
+            instruction("movq", std::to_string(state.pending_base + 8 * (first + a)) + "(%rbp), " +
+                                reg64(argument_registers[a]));
+        }
+        instruction("call", options.symbol_prefix + inst.callee);
+        if (cleanup) instruction("addq", "$" + std::to_string(cleanup) + ", %rsp");
+        for (auto it = saved.rbegin(); it != saved.rend(); ++it) instruction("popq", reg64(*it));
+        if (!inst.result.empty()) store(location(state, inst.result), RAX);
+        pending = first;
+    }
+
+    static bool relational_condition(const std::string& op, std::string& cc) {
+        if (op == "==") cc = "e";
+        else if (op == "!=") cc = "ne";
+        else if (op == "<") cc = "l";
+        else if (op == ">") cc = "g";
+        else if (op == "<=") cc = "le";
+        else if (op == ">=") cc = "ge";
+        else return false;
+        return true;
+    }
+
+    static std::string negate(const std::string& cc) {
+        static const std::unordered_map<std::string, std::string> opposite = {
+            {"e", "ne"}, {"ne", "e"}, {"l", "ge"}, {"ge", "l"}, {"g", "le"}, {"le", "g"}};
+        return opposite.at(cc);
+    }
+
+    // Condición equivalente al intercambiar los operandos (a < b  <=>  b > a)
+    static std::string mirror(const std::string& cc) {
+        static const std::unordered_map<std::string, std::string> swapped = {
+            {"e", "e"}, {"ne", "ne"}, {"l", "g"}, {"g", "l"}, {"le", "ge"}, {"ge", "le"}};
+        return swapped.at(cc);
+    }
+
+    // Emite "cmp" entre a y b y devuelve la condición que corresponde a "a cc b"
+    std::string compare(Location a, Location b, std::string cc) {
+        if (a.is_immediate()) {
+            std::swap(a, b);
+            cc = mirror(cc);
+        }
+        if (a.kind == Location::Memory && b.kind == Location::Memory) {
+            load(RAX, a);
+            a = in_register(RAX);
+        }
+        if (b.is_immediate() && b.value == 0 && a.kind == Location::Register) {
+            instruction("testq", reg64(a.reg) + ", " + reg64(a.reg));
+        }
+        else {
+            instruction("cmpq", text(operand(b, RCX)) + ", " + text(a));
+        }
+        return cc;
+    }
+
+    // Función para calcular dst = a op b
+    void emit_binary(const std::string& op, Location a, Location b, const Location& dst, FunctionState& state) {
+        int r = (dst.kind == Location::Register) ? dst.reg : RAX;
+
+        if (a.is_immediate() && b.is_immediate()) {
+            long long value;
+            if (evaluate_binary(op, a.value, b.value, value)) {
+                load(r, immediate(value));
+                store(dst, r);
+            }
+            else if (op == "/") {
+                instruction("jmp", division_label(state));
+            }
+            else {
+                throw std::runtime_error("Operador no soportado por el backend: " + op);
+            }
+            return;
+        }
+
+        std::string cc;
+        if (relational_condition(op, cc)) {
+            cc = compare(a, b, cc);
+            instruction("set" + cc, "%al");
+            instruction("movzbl", "%al, " + reg32(r));
+            store(dst, r);
+            return;
+        }
+        if (op == "&&" || op == "||") {
+            test(a);
+            instruction("setne", "%al");
+            test(b, RCX);
+            instruction("setne", "%cl");
+            instruction(op == "&&" ? "andb" : "orb", "%cl, %al");
+            instruction("movzbl", "%al, " + reg32(r));
+            store(dst, r);
+            return;
+        }
+        if (op == "+") {
+            emit_add(a, b, r);
+        }
+        else if (op == "-") {
+            if (b.is_immediate() && fits_int32(b.value) && fits_int32(-b.value)) {
+                emit_add(a, immediate(-b.value), r);
+            }
+            else if (a.is_immediate() && a.value == 0) {
+                load(r, b);
+                instruction("negq", reg64(r));
+            }
+            else if (b.is_register(r) && !a.is_register(r)) {
+                load(RAX, a);
+                instruction("subq", text(b) + ", %rax");
+                r = RAX;
+            }
+            else {
+                load(r, a);
+                instruction("subq", text(operand(b, RCX)) + ", " + reg64(r));
+            }
+        }
+        else if (op == "*") {
+            emit_multiply(a, b, r);
+        }
+        else if (op == "/") {
+            r = emit_divide(a, b, r, state);
+        }
+        else {
+            throw std::runtime_error("Operador no soportado por el backend: " + op);
+        }
+        store(dst, r);
+    }
+
+    void emit_add(Location a, Location b, int r) {
+        if (a.is_immediate() || (b.is_register(r) && !a.is_register(r))) std::swap(a, b);
+        if (b.is_immediate() && fits_int32(b.value)) {
+            if (a.kind == Location::Register && a.reg != r) {
+                instruction("leaq", std::to_string(b.value) + "(" + reg64(a.reg) + "), " + reg64(r));
+                stats.lea++;
+                return;
+            }
+            load(r, a);
+            if (b.value != 0) instruction("addq", text(b) + ", " + reg64(r));
+            return;
+        }
+        if (a.kind == Location::Register && b.kind == Location::Register && a.reg != r && b.reg != r) {
+            instruction("leaq", "(" + reg64(a.reg) + ", " + reg64(b.reg) + "), " + reg64(r));
+            stats.lea++;
+            return;
+        }
+        load(r, a);
+        instruction("addq", text(operand(b, RCX)) + ", " + reg64(r));
+    }
+
+    void emit_multiply(Location a, Location b, int r) {
+        if (a.is_immediate() || (b.is_register(r) && !a.is_register(r))) std::swap(a, b);
+        if (!b.is_immediate()) {
+            load(r, a);
+            instruction("imulq", text(b) + ", " + reg64(r));
+            return;
+        }
+
+        int64_t k = b.value;
+        int shift = power_of_two(k);
+        if (k == 0) {
+            load(r, immediate(0));
+        }
+        else if (k == 1) {
+            load(r, a);
+        }
+        else if (k == -1) {
+            load(r, a);
+            instruction("negq", reg64(r));
+        }
+        else if (k == 3 || k == 5 || k == 9) {
+            int base = (a.kind == Location::Register) ? a.reg : r;
+            load(base, a);
+            instruction("leaq", "(" + reg64(base) + ", " + reg64(base) + ", " + std::to_string(k - 1) + "), " + reg64(r));
+            stats.lea++;
+        }
+        else if ((k == 2 || k == 4 || k == 8) && a.kind == Location::Register && a.reg != r) {
+            if (k == 2) instruction("leaq", "(" + reg64(a.reg) + ", " + reg64(a.reg) + "), " + reg64(r));
+            else instruction("leaq", "0(, " + reg64(a.reg) + ", " + std::to_string(k) + "), " + reg64(r));
+            stats.lea++;
+        }
+        else if (shift > 0) {
+            load(r, a);
+            instruction("shlq", "$" + std::to_string(shift) + ", " + reg64(r));
+            stats.constant_multiplies++;
+        }
+        else if (fits_int32(k)) {
+            instruction("imulq", text(b) + ", " + text(a) + ", " + reg64(r));
+            stats.constant_multiplies++;
+        }
+        else {
+            load(r, a);
+            instruction("imulq", text(operand(b, RCX)) + ", " + reg64(r));
+        }
+    }
+
+    // Devuelve el registro que contiene el cociente
+    int emit_divide(const Location& a, const Location& b, int r, FunctionState& state) {
+        if (b.is_immediate()) {
+            int64_t k = b.value;
+            int shift = power_of_two(k);
+            if (k == 0) {
+                instruction("jmp", division_label(state));
+                return r;
+            }
+            if (k == 1 || k == -1) {
+                load(r, a);
+                if (k == -1) instruction("negq", reg64(r));
+                return r;
+            }
+            if (shift > 0 && shift <= 30) {
+                // Redondeo hacia cero: a los negativos se les suma k - 1 antes de desplazar
+                load(RAX, a);
+                instruction("leaq", std::to_string(k - 1) + "(%rax), %rcx");
+                instruction("testq", "%rax, %rax");
+                instruction("cmovnsq", "%rax, %rcx");
+                instruction("sarq", "$" + std::to_string(shift) + ", %rcx");
+                stats.constant_multiplies++;
+                return RCX;
+            }
+            load(RAX, a);
+            load(RCX, b);
+            instruction("cqto");
+            instruction("idivq", "%rcx");
+            return RAX;
+        }
+
+        load(RAX, a);
+        load(RCX, b);
+        instruction("testq", "%rcx, %rcx");
+        instruction("je", division_label(state));
+        std::string divide = new_local_label(state);
+        std::string done = new_local_label(state);
+        instruction("cmpq", "$-1, %rcx");
+        instruction("jne", divide);
+        instruction("negq", "%rax"); // a / -1 = -a (idiv fallaría con el mínimo entero)
+        instruction("jmp", done);
+        label(divide);
+        instruction("cqto");
+        instruction("idivq", "%rcx");
+        label(done);
+        return RAX;
+    }
+
+    void emit_branch(const Instruction& inst, FunctionState& state) {
+        bool negated = inst.kind == InstructionKind::IfFalse;
+        std::string target = local_label(state, inst.label);
+        Location a = location(state, inst.arg1);
+
+        if (inst.op.empty()) {
+            if (a.is_immediate()) {
+                // Condición constante: salto incondicional o nada
+                if ((a.value != 0) != negated) instruction("jmp", target);
+                return;
+            }
+            test(a);
+            instruction(negated ? "je" : "jne", target);
+            return;
+        }
+
+        Location b = location(state, inst.arg2);
+        std::string op = canonical_operator(inst.op);
+        std::string cc;
+        if (relational_condition(op, cc) && !(a.is_immediate() && b.is_immediate())) {
+            // cmp y jcc juntos, sin materializar la comparación
+            cc = compare(a, b, cc);
+            instruction("j" + (negated ? negate(cc) : cc), target);
+            stats.fused_branches++;
+            return;
+        }
+
+        emit_binary(op, a, b, in_register(RAX), state);
+        instruction("testq", "%rax, %rax");
+        instruction(negated ? "je" : "jne", target);
+    }
+};
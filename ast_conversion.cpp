@@ -0,0 +1,111 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <stdexcept>
+
+#include "parser.cpp"
+#include "intermediate_code.cpp"
+
+/*
+    Conversión del AST de Parser (nodos con punteros) a las estructuras por valor que recibe
+    IntermediateCodeGenerator (Function, Statement, Expression), equivalentes a los
+    diccionarios que usa la versión en Python.
+*/
+
+inline Expression convert_expression(const ExpressionNode* node) {
+    Expression expr;
+    if (!node) return expr; // Expresión omitida (condición vacía de un for)
+
+    expr.type = node->type;
+    expr.op = node->op;
+    if (node->type == "id" || node->type == "call") {
+        expr.name = node->value.id_name;
+    }
+    else if (node->type == "number") {
+        expr.value = node->value.int_val;
+    }
+    else if (node->type == "boolean") {
+        expr.value = node->value.bool_val ? 1 : 0;
+    }
+
+    if (node->left) expr.left = std::make_shared<Expression>(convert_expression(node->left));
+    if (node->right) expr.right = std::make_shared<Expression>(convert_expression(node->right));
+    if (node->operand) expr.operand = std::make_shared<Expression>(convert_expression(node->operand));
+    for (const ExpressionNode* arg : node->args) {
+        expr.args.push_back(convert_expression(arg));
+    }
+    return expr;
+}
+
+inline Statement convert_statement(const StatementNode* node);
+
+inline std::vector<Statement> convert_body(const std::vector<StatementNode*>& body) {
+    std::vector<Statement> statements;
+    for (const StatementNode* node : body) {
+        statements.push_back(convert_statement(node));
+    }
+    return statements;
+}
+
+inline Statement convert_statement(const StatementNode* node) {
+    Statement stmt;
+    stmt.type = node->type;
+    stmt.line = node->line;
+    stmt.column = node->column;
+
+    if (auto declaration = dynamic_cast<const DeclarationNode*>(node)) {
+        stmt.target = declaration->var_name;
+        stmt.expr = convert_expression(declaration->init);
+    }
+    else if (auto assignment = dynamic_cast<const AssignmentNode*>(node)) {
+        stmt.target = assignment->target;
+        stmt.expr = convert_expression(assignment->expr);
+    }
+    else if (auto if_node = dynamic_cast<const IfNode*>(node)) {
+        stmt.condition = convert_expression(if_node->condition);
+        stmt.if_body = convert_body(if_node->if_body);
+        stmt.else_body = convert_body(if_node->else_body);
+    }
+    else if (auto while_node = dynamic_cast<const WhileNode*>(node)) {
+        stmt.condition = convert_expression(while_node->condition);
+        stmt.body = convert_body(while_node->body);
+    }
+    else if (auto do_while = dynamic_cast<const DoWhileNode*>(node)) {
+        stmt.condition = convert_expression(do_while->condition);
+        stmt.body = convert_body(do_while->body);
+    }
+    else if (auto for_node = dynamic_cast<const ForNode*>(node)) {
+        if (for_node->init) stmt.init = std::make_shared<Statement>(convert_statement(for_node->init));
+        stmt.condition = convert_expression(for_node->condition);
+        if (for_node->step) stmt.increment = std::make_shared<Statement>(convert_statement(for_node->step));
+        stmt.body = convert_body(for_node->body);
+    }
+    else if (auto return_node = dynamic_cast<const ReturnNode*>(node)) {
+        stmt.expr = convert_expression(return_node->expr);
+    }
+    else if (auto call = dynamic_cast<const CallNode*>(node)) {
+        stmt.expr = convert_expression(call->call);
+    }
+    else {
+        throw std::runtime_error("Tipo de declaración desconocido: " + node->type);
+    }
+    return stmt;
+}
+
+inline std::vector<Function> convert_program(const ProgramNode* ast) {
+    std::vector<Function> functions;
+    for (const FunctionNode* node : ast->functions) {
+        Function function;
+        function.name = node->name;
+        function.line = node->line;
+        function.column = node->column;
+        for (const auto& param : node->parameters) {
+            function.parameters.push_back(param.var_name);
+        }
+        function.body = convert_body(node->body);
+        functions.push_back(function);
+    }
+    return functions;
+}
@@ -0,0 +1,163 @@
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <memory>
+
+#include "batch_compiler.cpp"
+#include "program_generator.cpp"
+
+/*
+    Compilación por lotes con BatchCompiler.
+
+    Compila los archivos fuente que se pasen como argumentos, o --generate=N programas de
+    ProgramGenerator (semillas consecutivas desde --seed, de unos --size bytes cada uno), y
+    muestra cuántos programas fallaron y el rendimiento del lote. Con --output=directorio
+    escribe el código intermedio de cada programa en programaN.ir, en el orden de entrada.
+
+    Con --scaling compila el mismo lote con 1, 2, 4, ... hilos hasta --threads (por defecto
+    todos los núcleos), informa la aceleración respecto de un hilo y comprueba que todas las
+    corridas producen exactamente el mismo código. El proceso termina con código 1 si algún
+    programa falla o si las corridas no coinciden.
+
+    Con --cache=directorio los programas pasan por CompileCache (--cache-size=MB limita su
+    tamaño) y al final se muestran sus aciertos y fallos.
+
+    Uso: batch_compile [--threads=N] [--no-optimize] [--output=dir] [--scaling]
+             [--cache=dir] [--cache-size=256] [--generate=N] [--size=2048] [--seed=1]
+             [programa.src ...]
+*/
+
+static void print_row(const std::string& label, const BatchCompiler::Stats& stats, size_t bytes, double base_seconds) {
+    std::cout << std::left << std::setw(10) << label << std::right << std::fixed << std::setprecision(3)
+              << std::setw(12) << stats.seconds << std::setprecision(0) << std::setw(16)
+              << stats.programs / stats.seconds << std::setprecision(2) << std::setw(10) << bytes / stats.seconds / 1e6
+              << std::setw(14) << base_seconds / stats.seconds << "x" << std::setw(10) << stats.tasks << std::setw(10)
+              << stats.stolen_tasks << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    BatchCompiler::Options options;
+    options.threads = std::max(1u, std::thread::hardware_concurrency());
+    std::string output;
+    bool scaling = false;
+    size_t generate = 0;
+    size_t size = 2048;
+    uint64_t seed = 1;
+    CompileCache::Options cache_options;
+    std::vector<std::string> sources;
+
+    try {
+        for (int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+            size_t equals = arg.find('=');
+            std::string flag = arg.substr(0, equals);
+            std::string value = equals == std::string::npos ? "" : arg.substr(equals + 1);
+            if (flag == "--threads") options.threads = static_cast<unsigned>(std::stoul(value));
+            else if (flag == "--no-optimize") options.optimize = false;
+            else if (flag == "--output") output = value;
+            else if (flag == "--scaling") scaling = true;
+            else if (flag == "--cache") cache_options.directory = value;
+            else if (flag == "--cache-size") cache_options.max_bytes = std::stoull(value) << 20;
+            else if (flag == "--generate") generate = std::stoul(value);
+            else if (flag == "--size") size = std::stoul(value);
+            else if (flag == "--seed") seed = std::stoull(value);
+            else if (arg.rfind("--", 0) == 0) throw std::runtime_error("Opción desconocida: " + arg);
+            else {
+                std::ifstream file(arg);
+                if (!file) throw std::runtime_error("No se pudo leer " + arg);
+                std::stringstream source;
+                source << file.rdbuf();
+                sources.push_back(source.str());
+            }
+        }
+    }
+    catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    std::unique_ptr<CompileCache> cache;
+    if (!cache_options.directory.empty()) {
+        cache_options.optimize = options.optimize;
+        try {
+            cache = std::make_unique<CompileCache>(cache_options);
+        }
+        catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+        options.cache = cache.get();
+    }
+
+    for (size_t i = 0; i < generate; i++) {
+        ProgramGenerator::Options generator_options;
+        generator_options.seed = seed + i;
+        sources.push_back(ProgramGenerator(generator_options).generate_bytes(size));
+    }
+    if (sources.empty()) {
+        std::cerr << "No hay programas para compilar (archivos o --generate=N)" << std::endl;
+        return 1;
+    }
+    size_t bytes = 0;
+    for (const auto& source : sources) bytes += source.size();
+
+    std::vector<unsigned> thread_counts = {options.threads};
+    if (scaling) {
+        thread_counts.clear();
+        for (unsigned threads = 1; threads < options.threads; threads *= 2) thread_counts.push_back(threads);
+        thread_counts.push_back(options.threads);
+    }
+
+    std::cout << sources.size() << " programas, " << bytes << " bytes" << std::endl;
+    std::cout << std::left << std::setw(10) << "Hilos" << std::right << std::setw(12) << "Tiempo (s)" << std::setw(16)
+              << "Programas/s" << std::setw(10) << "MB/s" << std::setw(15) << "Aceleración" << std::setw(10) << "Tareas"
+              << std::setw(10) << "Robadas" << std::endl;
+
+    std::vector<BatchCompiler::Result> first;
+    double base_seconds = 0;
+    bool mismatch = false;
+    for (unsigned threads : thread_counts) {
+        BatchCompiler::Options run_options = options;
+        run_options.threads = threads;
+        BatchCompiler compiler(run_options);
+        std::vector<BatchCompiler::Result> results = compiler.compile(sources);
+        const BatchCompiler::Stats& stats = compiler.last_stats();
+        if (first.empty()) {
+            first = std::move(results);
+            base_seconds = stats.seconds;
+        }
+        else {
+            for (size_t i = 0; i < results.size(); i++) {
+                if (results[i].ok != first[i].ok || results[i].code != first[i].code || results[i].error != first[i].error) {
+                    std::cout << "[FALLA] programa " << i << ": el resultado con " << threads
+                              << " hilos no coincide con el de " << thread_counts.front() << std::endl;
+                    mismatch = true;
+                }
+            }
+        }
+        print_row(std::to_string(threads), stats, bytes, base_seconds);
+    }
+
+    size_t failures = 0;
+    for (size_t i = 0; i < first.size(); i++) {
+        if (!first[i].ok) {
+            std::cout << "[FALLA] programa " << i << ": " << first[i].error << std::endl;
+            failures++;
+        }
+        else if (!output.empty()) {
+            std::ofstream file(output + "/programa" + std::to_string(i) + ".ir");
+            if (!file) {
+                std::cerr << "No se pudo escribir en " << output << std::endl;
+                return 1;
+            }
+            for (const auto& line : first[i].code) file << line << "\n";
+        }
+    }
+    std::cout << failures << " programas con errores" << std::endl;
+    if (cache) std::cout << cache->report();
+    return (failures || mismatch) ? 1 : 0;
+}
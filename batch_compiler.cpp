@@ -0,0 +1,118 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <stdexcept>
+
+#include "compiler_pipeline.cpp"
+#include "thread_pool.cpp"
+#include "compile_cache.cpp"
+
+/*
+    Compilación por lotes de muchos programas independientes en paralelo.
+
+    BatchCompiler reparte los programas en tareas de ThreadPool (grupos de programas
+    consecutivos, para que las tareas no sean demasiado pequeñas y a la vez alcancen para
+    repartir con robo de trabajo). Cada programa se compila con compile_source() y, si se
+    pide, optimize_code(): su propio Lexer, Parser, AST e IntermediateCodeGenerator, así que
+    los temporales y las etiquetas se numeran desde 0 en cada programa y el resultado es el
+    mismo que al compilarlo solo, sin importar el hilo ni el orden.
+
+    Cada tarea escribe únicamente en las posiciones del resultado que le tocan; fuera del
+    grupo de hilos no hay estado compartido. Los resultados se devuelven en el orden de la
+    entrada y un error en un programa (léxico, sintáctico, ...) queda en su resultado sin
+    afectar a los demás.
+
+    Con Options::cache los programas pasan por CompileCache (que puede usarse desde varios
+    hilos); en ese caso la optimización la deciden las opciones de la caché.
+*/
+
+class BatchCompiler {
+public:
+    struct Options {
+        unsigned threads = 0;    // 0: un hilo por núcleo
+        bool optimize = true;
+        size_t chunk = 0;        // Programas por tarea (0: automático)
+        CompileCache* cache = nullptr;
+    };
+
+    struct Result {
+        bool ok = false;
+        std::vector<std::string> code;
+        std::string error;
+    };
+
+    // Estadísticas de la última llamada a compile()
+    struct Stats {
+        size_t programs = 0;
+        size_t failures = 0;
+        size_t tasks = 0;
+        uint64_t stolen_tasks = 0;
+        double seconds = 0;
+    };
+
+    BatchCompiler() : BatchCompiler(Options()) {}
+    explicit BatchCompiler(const Options& options) : options(options), pool(std::make_unique<ThreadPool>(options.threads)) {}
+
+    std::vector<Result> compile(const std::vector<std::string>& sources) {
+        stats = Stats();
+        stats.programs = sources.size();
+        auto start = std::chrono::steady_clock::now();
+        uint64_t stolen_before = pool->stats().stolen;
+
+        // Varias tareas por hilo para que el robo pueda equilibrar programas de distinto tamaño
+        size_t chunk = options.chunk;
+        if (chunk == 0) chunk = std::max<size_t>(1, sources.size() / (pool->size() * 16));
+
+        std::vector<Result> results(sources.size());
+        for (size_t first = 0; first < sources.size(); first += chunk) {
+            size_t last = std::min(sources.size(), first + chunk);
+            pool->submit([this, &sources, &results, first, last] {
+                for (size_t i = first; i < last; i++) results[i] = compile_program(sources[i], options.optimize, options.cache);
+            });
+            stats.tasks++;
+        }
+        pool->wait();
+
+        for (const auto& result : results) {
+            if (!result.ok) stats.failures++;
+        }
+        stats.stolen_tasks = pool->stats().stolen - stolen_before;
+        stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return results;
+    }
+
+    // Compilación de un solo programa, igual a la que hace cada tarea
+    static Result compile_program(const std::string& source, bool optimize, CompileCache* cache = nullptr) {
+        Result result;
+        try {
+            if (cache) {
+                result.code = cache->compile(source);
+            }
+            else {
+                result.code = compile_source(source);
+                if (optimize) result.code = optimize_code(result.code);
+            }
+            result.ok = true;
+        }
+        catch (const std::exception& e) {
+            result.error = e.what();
+        }
+        return result;
+    }
+
+    size_t threads() const {
+        return pool->size();
+    }
+
+    const Stats& last_stats() const {
+        return stats;
+    }
+
+private:
+    Options options;
+    Stats stats;
+    std::unique_ptr<ThreadPool> pool;
+};
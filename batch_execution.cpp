@@ -0,0 +1,468 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <climits>
+#include <cstring>
+#include <stdexcept>
+#include <new>
+
+#include "bytecode_vm.cpp"
+
+/*
+    Ejecución por lotes: una misma función evaluada sobre muchos registros de entrada.
+
+    Los argumentos se reciben por columnas (columns[i][r] es el argumento i del registro r)
+    y el resultado se escribe en otra columna. Los registros se procesan en grupos de
+    BatchExecutor::lanes: cada ranura del marco de BytecodeCompiler guarda un vector con el
+    valor de esa ranura en cada carril, de modo que una instrucción del bytecode se ejecuta
+    para todo el grupo a la vez con operaciones SIMD (extensiones vectoriales de GCC y Clang).
+
+    Conjunto de instrucciones: con la arquitectura por defecto de x86-64 (SSE2) no hay
+    comparaciones con signo ni productos de 64 bits en vectores y el compilador los hace
+    elemento a elemento. Por eso el intérprete de un grupo se compila además con
+    target("avx512f,avx512dq") y el constructor elige esa versión si el procesador la
+    admite (__builtin_cpu_supports): un grupo de 8 carriles ocupa un solo registro zmm, las
+    comparaciones dejan una máscara y el producto es vpmullq. Una versión AVX2 (dos
+    registros ymm, producto armado con vpmuludq) medía igual o algo peor que la genérica
+    en vm_benchmark, así que no se incluye. La división es elemento a elemento en todas.
+
+    Saltos divergentes: cada carril tiene su propio contador de programa. Siempre se ejecuta
+    la posición más baja entre los carriles que no terminaron, con una máscara de los
+    carriles que están en ella; los demás esperan más adelante en el código. Cuando la
+    ejecución llega a la posición donde espera otro grupo de carriles, las máscaras se unen
+    (reconvergencia). Como el código intermedio es lineal, así se respetan tanto los if/else
+    (los carriles se juntan después del else) como los bucles (los carriles que siguen en el
+    bucle vuelven hacia atrás y se ejecutan antes que los que ya salieron).
+
+    Control uniforme: mientras ningún carril espera en otra posición (al entrar a la función
+    y después de reconverger) las instrucciones se ejecutan sin buscar la posición más baja
+    ni mezclar los resultados con la máscara; solo los saltos condicionales revisan si los
+    carriles se separan. Los carriles son de 64 bits porque el código intermedio usa
+    aritmética circular de 64 bits: con carriles de 32 bits los resultados serían otros en
+    cuanto un valor intermedio no cupiera, y el bytecode no tiene información de rangos
+    para saber de antemano que eso no pasa.
+
+    Los CALL que quedan después del inliner se ejecutan carril por carril en VirtualMachine.
+    Una división entre cero en cualquier registro lanza std::runtime_error para todo el lote
+    (el mensaje indica el registro).
+*/
+
+#if defined(__GNUC__) || defined(__clang__)
+#define BATCH_VECTOR_EXTENSIONS 1
+// Las funciones del intérprete de un grupo se expanden dentro de cada versión compilada
+// para un conjunto de instrucciones, que es donde se eligen las instrucciones vectoriales
+#define BATCH_INLINE __attribute__((always_inline)) inline
+#if defined(__x86_64__)
+#define BATCH_TARGET_DISPATCH 1
+#endif
+#else
+#define BATCH_INLINE inline
+#endif
+
+class BatchExecutor {
+public:
+    static constexpr int lanes = 8;
+
+    // Estadísticas de la última llamada a run()
+    struct Stats {
+        size_t records = 0;
+        size_t groups = 0;              // Grupos de carriles ejecutados
+        size_t instructions = 0;        // Instrucciones ejecutadas (cada una sobre un grupo)
+        size_t divergent_branches = 0;  // Saltos donde los carriles activos tomaron caminos distintos
+        size_t scalar_calls = 0;        // Llamadas resueltas carril por carril
+    };
+
+    struct Options {
+        bool dispatch = true; // false -> siempre la versión genérica (para comparar)
+    };
+
+    BatchExecutor(const std::vector<std::string>& code) : BatchExecutor(code, Options()) {}
+
+    BatchExecutor(const std::vector<std::string>& code, Options options) {
+        BytecodeCompiler compiler;
+        module = compiler.compile(code);
+        target = options.dispatch ? detect_target() : Target::Generic;
+        fill(zero, 0);
+        fill(one, 1);
+        fill(minus_one, -1);
+        fill(finished, done);
+        for (int l = 0; l < lanes; l++) lane_index[l] = l;
+    }
+
+    // Función para evaluar name sobre records registros; cada columna tiene records valores
+    void run(const std::string& name, const std::vector<const int64_t*>& columns, size_t records, int64_t* results) {
+        int index = module.find_function(name);
+        if (index < 0) {
+            throw std::runtime_error("La función " + name + " no existe");
+        }
+        const BytecodeFunction& function = module.functions[index];
+        if (static_cast<int>(columns.size()) != function.parameter_count) {
+            throw std::runtime_error("La función " + name + " espera " + std::to_string(function.parameter_count) +
+                                     " columnas de argumentos");
+        }
+
+        stats = Stats();
+        stats.records = records;
+        frame_template.resize(function.slot_count);
+        for (int s = 0; s < function.slot_count; s++) fill(frame_template[s], function.initial_slots[s]);
+        slots.resize(function.slot_count);
+
+        for (size_t first = 0; first < records; first += lanes) {
+            int count = static_cast<int>(std::min<size_t>(lanes, records - first));
+            for (size_t s = columns.size(); s < slots.size(); s++) slots[s] = frame_template[s];
+            for (size_t p = 0; p < columns.size(); p++) {
+                // Las columnas no tienen por qué estar alineadas: se copian con memcpy (con tamaño
+                // constante en los grupos completos para que sea una sola carga vectorial)
+                if (count == lanes) {
+                    std::memcpy(&slots[p], columns[p] + first, sizeof(Lanes));
+                }
+                else {
+                    slots[p] = frame_template[p];
+                    std::memcpy(&slots[p], columns[p] + first, count * sizeof(int64_t));
+                }
+            }
+            execute_group(function, first, count, results + first);
+            stats.groups++;
+        }
+    }
+
+    std::vector<int64_t> run(const std::string& name, const std::vector<std::vector<int64_t>>& columns) {
+        size_t records = columns.empty() ? 0 : columns[0].size();
+        std::vector<const int64_t*> pointers;
+        for (const auto& column : columns) {
+            if (column.size() != records) {
+                throw std::runtime_error("Las columnas de argumentos tienen tamaños distintos");
+            }
+            pointers.push_back(column.data());
+        }
+        std::vector<int64_t> results(records);
+        run(name, pointers, records, results.data());
+        return results;
+    }
+
+    const Stats& last_stats() const {
+        return stats;
+    }
+
+    // Conjunto de instrucciones de la versión que se usa en run()
+    const char* instruction_set() const {
+        return target == Target::Avx512 ? "AVX-512" : "genérico";
+    }
+
+private:
+    enum class Target { Generic, Avx512 };
+
+    static Target detect_target() {
+#ifdef BATCH_TARGET_DISPATCH
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq")) return Target::Avx512;
+#endif
+        return Target::Generic;
+    }
+
+    // Sección de vectores de carriles -> begin
+
+#ifdef BATCH_VECTOR_EXTENSIONS
+    typedef int64_t LaneValues __attribute__((vector_size(lanes * sizeof(int64_t))));
+    typedef uint64_t UnsignedLanes __attribute__((vector_size(lanes * sizeof(int64_t))));
+
+    // La alineación de un vector depende de la arquitectura de destino (16 bytes con SSE2,
+    // 64 con AVX-512): se fija en el tamaño completo para que la versión AVX-512 pueda usar
+    // cargas alineadas sobre los vectores que reserva el código genérico
+    typedef LaneValues Lanes __attribute__((aligned(sizeof(LaneValues))));
+
+    // std::vector no ve el atributo aligned del tipo: sus elementos se reservan aparte
+    template <typename T>
+    struct LaneAllocator {
+        typedef T value_type;
+
+        LaneAllocator() = default;
+        template <typename U>
+        LaneAllocator(const LaneAllocator<U>&) {}
+
+        T* allocate(size_t n) {
+            return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(sizeof(LaneValues))));
+        }
+        void deallocate(T* p, size_t) {
+            ::operator delete(p, std::align_val_t(sizeof(LaneValues)));
+        }
+        bool operator==(const LaneAllocator&) const { return true; }
+        bool operator!=(const LaneAllocator&) const { return false; }
+    };
+    typedef std::vector<LaneValues, LaneAllocator<LaneValues>> LaneVector;
+
+    // Las operaciones aritméticas se hacen sin signo para que el desbordamiento sea circular
+#define BATCH_UNSIGNED(x) ((UnsignedLanes)(x))
+#define BATCH_SIGNED(x) ((Lanes)(x))
+#else
+    // Sin extensiones vectoriales: las mismas operaciones elemento a elemento
+    template <typename T>
+    struct LaneArray {
+        T v[lanes];
+
+        T& operator[](int l) { return v[l]; }
+        T operator[](int l) const { return v[l]; }
+
+        template <typename Op>
+        static LaneArray map(const LaneArray& a, const LaneArray& b, Op op) {
+            LaneArray r;
+            for (int l = 0; l < lanes; l++) r.v[l] = op(a.v[l], b.v[l]);
+            return r;
+        }
+        LaneArray operator+(const LaneArray& o) const { return map(*this, o, [](T x, T y) { return T(x + y); }); }
+        LaneArray operator-(const LaneArray& o) const { return map(*this, o, [](T x, T y) { return T(x - y); }); }
+        LaneArray operator*(const LaneArray& o) const { return map(*this, o, [](T x, T y) { return T(x * y); }); }
+        LaneArray operator/(const LaneArray& o) const { return map(*this, o, [](T x, T y) { return T(x / y); }); }
+        LaneArray operator&(const LaneArray& o) const { return map(*this, o, [](T x, T y) { return T(x & y); }); }
+        LaneArray operator|(const LaneArray& o) const { return map(*this, o, [](T x, T y) { return T(x | y); }); }
+        LaneArray operator~() const { return map(*this, *this, [](T x, T) { return T(~x); }); }
+        LaneArray operator==(const LaneArray& o) const { return map(*this, o, [](T x, T y) { return T(x == y ? -1 : 0); }); }
+        LaneArray operator!=(const LaneArray& o) const { return map(*this, o, [](T x, T y) { return T(x != y ? -1 : 0); }); }
+        LaneArray operator<(const LaneArray& o) const { return map(*this, o, [](T x, T y) { return T(x < y ? -1 : 0); }); }
+        LaneArray operator>(const LaneArray& o) const { return map(*this, o, [](T x, T y) { return T(x > y ? -1 : 0); }); }
+        LaneArray operator<=(const LaneArray& o) const { return map(*this, o, [](T x, T y) { return T(x <= y ? -1 : 0); }); }
+        LaneArray operator>=(const LaneArray& o) const { return map(*this, o, [](T x, T y) { return T(x >= y ? -1 : 0); }); }
+
+        template <typename U>
+        LaneArray<U> as() const {
+            LaneArray<U> r;
+            for (int l = 0; l < lanes; l++) r[l] = static_cast<U>(v[l]);
+            return r;
+        }
+    };
+    typedef LaneArray<int64_t> Lanes;
+    typedef LaneArray<uint64_t> UnsignedLanes;
+    typedef std::vector<Lanes> LaneVector;
+
+#define BATCH_UNSIGNED(x) ((x).template as<uint64_t>())
+#define BATCH_SIGNED(x) ((x).template as<int64_t>())
+#endif
+
+    // Nota: ninguna función recibe ni devuelve vectores por valor (cambia la ABI sin AVX-512)
+    BATCH_INLINE static void fill(Lanes& v, int64_t value) {
+        for (int l = 0; l < lanes; l++) v[l] = value;
+    }
+
+    // Escribe value en dst solo en los carriles de la máscara (-1 seleccionado, 0 no)
+    BATCH_INLINE static void assign(Lanes& dst, const Lanes& mask, const Lanes& value) {
+        dst = (value & mask) | (dst & ~mask);
+    }
+
+    // Escribe el resultado de una instrucción: con control uniforme, en todos los carriles
+    template <bool uniform>
+    BATCH_INLINE static void store(Lanes& dst, const Lanes& mask, const Lanes& value) {
+        if (uniform) dst = value;
+        else assign(dst, mask, value);
+    }
+
+    BATCH_INLINE static bool any(const Lanes& mask) {
+        int64_t bits = 0;
+        for (int l = 0; l < lanes; l++) bits |= mask[l];
+        return bits != 0;
+    }
+
+    BATCH_INLINE static int64_t minimum(const Lanes& v) {
+        int64_t result = v[0];
+        for (int l = 1; l < lanes; l++) result = std::min(result, v[l]);
+        return result;
+    }
+
+    BATCH_INLINE static bool same(const Lanes& a, const Lanes& b) {
+        for (int l = 0; l < lanes; l++) {
+            if (a[l] != b[l]) return false;
+        }
+        return true;
+    }
+
+    // Sección de vectores de carriles -> end
+
+    static constexpr int64_t done = INT64_MAX; // Contador de programa de un carril que ya terminó
+
+    BytecodeModule module;
+    VirtualMachine vm;
+    Stats stats;
+    Target target = Target::Generic;
+    Lanes zero, one, minus_one, finished, lane_index;
+    LaneVector frame_template;
+    LaneVector slots;
+    LaneVector pending; // Argumentos pendientes (PARAM) de cada carril
+
+    void execute_group(const BytecodeFunction& function, size_t first, int count, int64_t* results) {
+#ifdef BATCH_TARGET_DISPATCH
+        if (target == Target::Avx512) {
+            execute_group_avx512(function, first, count, results);
+            return;
+        }
+#endif
+        execute_group_lanes(function, first, count, results);
+    }
+
+#ifdef BATCH_TARGET_DISPATCH
+    __attribute__((target("avx512f,avx512dq")))
+    void execute_group_avx512(const BytecodeFunction& function, size_t first, int count, int64_t* results) {
+        execute_group_lanes(function, first, count, results);
+    }
+#endif
+
+    BATCH_INLINE void execute_group_lanes(const BytecodeFunction& function, size_t first, int count, int64_t* results) {
+        pending.clear();
+        Lanes limit;
+        fill(limit, count);
+        Lanes active = lane_index < limit;
+        Lanes lane_pc = finished; // Contador de programa de cada carril
+        size_t executed = 0;
+
+        // Al empezar todos los carriles están en la entrada: no hace falta buscar la posición
+        // más baja hasta el primer salto divergente
+        bool returned = execute_lanes<true>(function.entry, active, done, lane_pc, first, results, executed);
+        while (!returned) {
+            // Posición más baja entre los carriles activos y siguiente posición donde esperan otros
+            int64_t pc = minimum(lane_pc);
+            if (pc == done) break;
+            Lanes position;
+            fill(position, pc);
+            Lanes mask = lane_pc == position;
+            Lanes others = lane_pc;
+            assign(others, mask, finished);
+            int64_t waiting = minimum(others);
+
+            // Control uniforme: ningún carril espera en otra posición
+            if (waiting == done) {
+                returned = execute_lanes<true>(pc, mask, waiting, lane_pc, first, results, executed);
+            }
+            else {
+                execute_lanes<false>(pc, mask, waiting, lane_pc, first, results, executed);
+            }
+        }
+        stats.instructions += executed;
+    }
+
+    // Ejecuta con la misma máscara desde pc hasta un salto divergente, un RETURN o la posición
+    // waiting donde esperan otros carriles, y deja en lane_pc dónde sigue cada carril.
+    // Con uniform todos los carriles que no terminaron están en pc: los resultados se
+    // escriben en todos los carriles sin mezclarlos con la máscara (los que terminaron ya no
+    // se leen) y no hace falta comparar con waiting. Devuelve true si los carriles terminaron
+    template <bool uniform>
+    BATCH_INLINE bool execute_lanes(int64_t pc, const Lanes& mask, int64_t waiting, Lanes& lane_pc, size_t first,
+                       int64_t* results, size_t& executed) {
+        const Bytecode* code = module.code.data();
+        Lanes* s = slots.data();
+        size_t steps = 0; // Contador local: executed está en memoria y no se actualiza en cada instrucción
+        for (;;) {
+            const Bytecode& ins = code[pc];
+            steps++;
+            int64_t next = pc + 1;
+            bool conditional = false;
+            Lanes taken;
+            switch (ins.op) {
+                case Opcode::Move: store<uniform>(s[ins.a], mask, s[ins.b]); break;
+                case Opcode::Neg: store<uniform>(s[ins.a], mask, BATCH_SIGNED(BATCH_UNSIGNED(zero) - BATCH_UNSIGNED(s[ins.b]))); break;
+                case Opcode::Not: store<uniform>(s[ins.a], mask, (s[ins.b] == zero) & one); break;
+                case Opcode::Add: store<uniform>(s[ins.a], mask, BATCH_SIGNED(BATCH_UNSIGNED(s[ins.b]) + BATCH_UNSIGNED(s[ins.c]))); break;
+                case Opcode::Sub: store<uniform>(s[ins.a], mask, BATCH_SIGNED(BATCH_UNSIGNED(s[ins.b]) - BATCH_UNSIGNED(s[ins.c]))); break;
+                case Opcode::Mul: store<uniform>(s[ins.a], mask, BATCH_SIGNED(BATCH_UNSIGNED(s[ins.b]) * BATCH_UNSIGNED(s[ins.c]))); break;
+                case Opcode::Div: divide(s[ins.a], s[ins.b], s[ins.c], mask, first); break;
+                case Opcode::Eq: store<uniform>(s[ins.a], mask, (s[ins.b] == s[ins.c]) & one); break;
+                case Opcode::Ne: store<uniform>(s[ins.a], mask, (s[ins.b] != s[ins.c]) & one); break;
+                case Opcode::Lt: store<uniform>(s[ins.a], mask, (s[ins.b] < s[ins.c]) & one); break;
+                case Opcode::Gt: store<uniform>(s[ins.a], mask, (s[ins.b] > s[ins.c]) & one); break;
+                case Opcode::Le: store<uniform>(s[ins.a], mask, (s[ins.b] <= s[ins.c]) & one); break;
+                case Opcode::Ge: store<uniform>(s[ins.a], mask, (s[ins.b] >= s[ins.c]) & one); break;
+                case Opcode::And: store<uniform>(s[ins.a], mask, (s[ins.b] != zero) & (s[ins.c] != zero) & one); break;
+                case Opcode::Or: store<uniform>(s[ins.a], mask, ((s[ins.b] != zero) | (s[ins.c] != zero)) & one); break;
+                case Opcode::Jump: next = ins.a; break;
+                case Opcode::JumpIf: taken = mask & (s[ins.b] != zero); conditional = true; break;
+                case Opcode::JumpIfNot: taken = mask & (s[ins.b] == zero); conditional = true; break;
+                case Opcode::JumpEq: taken = mask & (s[ins.b] == s[ins.c]); conditional = true; break;
+                case Opcode::JumpNe: taken = mask & (s[ins.b] != s[ins.c]); conditional = true; break;
+                case Opcode::JumpLt: taken = mask & (s[ins.b] < s[ins.c]); conditional = true; break;
+                case Opcode::JumpGt: taken = mask & (s[ins.b] > s[ins.c]); conditional = true; break;
+                case Opcode::JumpLe: taken = mask & (s[ins.b] <= s[ins.c]); conditional = true; break;
+                case Opcode::JumpGe: taken = mask & (s[ins.b] >= s[ins.c]); conditional = true; break;
+                case Opcode::Param: pending.push_back(s[ins.a]); break;
+                case Opcode::Call: call(ins, mask, first); break;
+                case Opcode::Return:
+                    for (int l = 0; l < lanes; l++) {
+                        if (mask[l]) results[l] = s[ins.a][l];
+                    }
+                    assign(lane_pc, mask, finished);
+                    executed += steps;
+                    return true;
+            }
+
+            if (conditional) {
+                if (same(taken, mask)) {
+                    next = ins.a;
+                }
+                else if (any(taken)) {
+                    // Los carriles se separan: cada uno guarda su destino y se vuelve a elegir
+                    stats.divergent_branches++;
+                    Lanes target, fallthrough;
+                    fill(target, ins.a);
+                    fill(fallthrough, next);
+                    assign(lane_pc, mask, fallthrough);
+                    assign(lane_pc, taken, target);
+                    executed += steps;
+                    return false;
+                }
+            }
+
+            pc = next;
+            if (!uniform && pc >= waiting) {
+                // Se llegó (o se saltó más allá) de donde esperan otros carriles
+                Lanes position;
+                fill(position, pc);
+                assign(lane_pc, mask, position);
+                executed += steps;
+                return false;
+            }
+        }
+    }
+
+    // División con la semántica de VirtualMachine (a / -1 = -a) solo en los carriles activos
+    BATCH_INLINE void divide(Lanes& dst, const Lanes& a, const Lanes& b, const Lanes& mask, size_t first) {
+        Lanes by_zero = mask & (b == zero);
+        if (any(by_zero)) {
+            for (int l = 0; l < lanes; l++) {
+                if (by_zero[l]) throw std::runtime_error("División entre cero en el registro " + std::to_string(first + l));
+            }
+        }
+        Lanes negate = b == minus_one;
+        Lanes divisor = b;
+        assign(divisor, (b == zero) | negate, one);
+        Lanes quotient = a / divisor;
+        assign(quotient, negate, BATCH_SIGNED(BATCH_UNSIGNED(zero) - BATCH_UNSIGNED(a)));
+        assign(dst, mask, quotient);
+    }
+
+    void call(const Bytecode& ins, const Lanes& mask, size_t first) {
+        const BytecodeFunction& callee = module.functions[ins.a];
+        size_t base = pending.size() - ins.c;
+        Lanes result = zero;
+        for (int l = 0; l < lanes; l++) {
+            if (!mask[l]) continue;
+            std::vector<int64_t> args;
+            for (int i = 0; i < ins.c; i++) args.push_back(pending[base + i][l]);
+            try {
+                result[l] = vm.run(module, callee.name, args);
+            }
+            catch (const StackOverflowError& e) {
+                throw StackOverflowError(std::string(e.what()) + " (registro " + std::to_string(first + l) + ")");
+            }
+            catch (const std::runtime_error& e) {
+                throw std::runtime_error(std::string(e.what()) + " (registro " + std::to_string(first + l) + ")");
+            }
+            stats.scalar_calls++;
+        }
+        pending.resize(base);
+        if (ins.b >= 0) assign(slots[ins.b], mask, result);
+    }
+};
+
+#undef BATCH_UNSIGNED
+#undef BATCH_SIGNED
+#undef BATCH_INLINE
+
@@ -0,0 +1,312 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <sstream>
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+
+#include "ir_instruction.cpp"
+#include "control_flow.cpp"
+
+/*
+    Orden de bloques guiado por perfil (PGO).
+
+    IntermediateCodeGenerator escribe los bloques en el orden del fuente: en un if el
+    cuerpo del then siempre sigue a la condición y el IF_FALSE salta al else, aunque el
+    camino frecuente sea el else. BlockLayoutOptimizer reordena los bloques de cada
+    función con las frecuencias de una ejecución de entrenamiento (BlockProfile, que
+    produce ExecutionProfiler::block_profile()):
+
+        - Cadenas de Pettis y Hansen: se recorren las aristas de mayor a menor frecuencia y
+          se une la cadena que termina en el origen con la que empieza en el destino, de
+          modo que el sucesor más frecuente de cada bloque quede a continuación.
+        - El bloque de entrada sigue primero; después van las cadenas que se ejecutaron, en
+          el orden original de su primer bloque, y al final los bloques fríos (nunca
+          ejecutados en el entrenamiento).
+        - Los saltos se corrigen: un salto condicional cuyo destino queda a continuación se
+          invierte (IF <-> IF_FALSE) para que el camino frecuente no salte, un GOTO al
+          bloque siguiente se elimina y donde se separó un bloque de su sucesor original
+          se agrega un GOTO (o una etiqueta nueva si el destino no tenía).
+
+    El perfil debe tomarse sobre el mismo código que se reordena (normalmente la salida
+    de optimize_code()); los bloques se identifican por la posición de su primera
+    instrucción relativa a PROC. Las funciones sin perfil o que no se ejecutaron quedan
+    igual.
+*/
+
+// Frecuencias de bloques y aristas de una ejecución de entrenamiento
+struct BlockProfile {
+    struct Function {
+        std::map<size_t, uint64_t> blocks;                   // Inicio del bloque (desde PROC) -> ejecuciones
+        std::map<std::pair<size_t, size_t>, uint64_t> edges; // (bloque origen, bloque destino) -> veces
+    };
+
+    std::map<std::string, Function> functions;
+
+    // Formato de texto, una línea por dato:
+    //     FUNCTION nombre
+    //     BLOCK inicio ejecuciones
+    //     EDGE origen destino veces
+    std::string to_string() const {
+        std::ostringstream out;
+        for (const auto& [name, function] : functions) {
+            out << "FUNCTION " << name << "\n";
+            for (const auto& [begin, count] : function.blocks) {
+                out << "BLOCK " << begin << " " << count << "\n";
+            }
+            for (const auto& [edge, count] : function.edges) {
+                out << "EDGE " << edge.first << " " << edge.second << " " << count << "\n";
+            }
+        }
+        return out.str();
+    }
+
+    static BlockProfile parse(const std::string& text) {
+        BlockProfile profile;
+        Function* current = nullptr;
+        std::istringstream in(text);
+        std::string line;
+        int number = 0;
+        while (std::getline(in, line)) {
+            number++;
+            std::istringstream words(line);
+            std::string kind;
+            if (!(words >> kind)) continue;
+            bool ok = true;
+            if (kind == "FUNCTION") {
+                std::string name;
+                ok = static_cast<bool>(words >> name);
+                if (ok) current = &profile.functions[name];
+            }
+            else if (kind == "BLOCK" && current) {
+                size_t begin;
+                uint64_t count;
+                ok = static_cast<bool>(words >> begin >> count);
+                if (ok) current->blocks[begin] = count;
+            }
+            else if (kind == "EDGE" && current) {
+                size_t from, to;
+                uint64_t count;
+                ok = static_cast<bool>(words >> from >> to >> count);
+                if (ok) current->edges[{from, to}] = count;
+            }
+            else {
+                ok = false;
+            }
+            if (!ok) {
+                throw std::runtime_error("Línea " + std::to_string(number) + " del perfil no válida: " + line);
+            }
+        }
+        return profile;
+    }
+};
+
+class BlockLayoutOptimizer {
+public:
+    // Estadísticas de la última llamada a optimize()
+    struct Stats {
+        int functions = 0;          // Funciones reordenadas
+        int moved_blocks = 0;       // Bloques que cambiaron de posición
+        int cold_blocks = 0;        // Bloques no ejecutados, movidos al final
+        int inverted_branches = 0;
+        int removed_jumps = 0;      // GOTO al bloque siguiente eliminados
+        int added_jumps = 0;        // GOTO agregados donde se separó un bloque de su sucesor
+    };
+
+    BlockLayoutOptimizer() {}
+
+    std::vector<std::string> optimize(const std::vector<std::string>& code, const BlockProfile& profile) {
+        stats = Stats();
+        std::vector<Instruction> instructions = parse_instructions(code);
+
+        // Las etiquetas nuevas continúan la numeración global
+        next_label = 0;
+        for (const auto& inst : instructions) {
+            next_label = std::max(next_label, name_number(inst.label, 'L') + 1);
+        }
+
+        std::vector<Instruction> result;
+        result.reserve(instructions.size());
+        size_t copied = 0;
+        for (const auto& range : function_ranges(instructions)) {
+            // Las líneas fuera de funciones se conservan sin cambios
+            result.insert(result.end(), instructions.begin() + copied, instructions.begin() + range.first);
+            std::vector<Instruction> function(instructions.begin() + range.first, instructions.begin() + range.second);
+            auto it = profile.functions.find(function.front().result);
+            if (it != profile.functions.end()) {
+                layout_function(function, it->second);
+            }
+            result.insert(result.end(), function.begin(), function.end());
+            copied = range.second;
+        }
+        result.insert(result.end(), instructions.begin() + copied, instructions.end());
+        return format_instructions(result);
+    }
+
+    const Stats& last_stats() const {
+        return stats;
+    }
+
+private:
+    Stats stats;
+    long long next_label = 0;
+
+    static constexpr size_t end_block = SIZE_MAX; // Sucesor de un bloque que llega a ENDP
+
+    void layout_function(std::vector<Instruction>& function, const BlockProfile::Function& profile) {
+        ControlFlowGraph cfg(function, 0, function.size());
+        size_t count = cfg.blocks.size();
+        if (count < 2) return;
+
+        // Frecuencias por índice de bloque
+        std::map<size_t, size_t> block_at;
+        for (size_t b = 0; b < count; b++) block_at[cfg.blocks[b].begin] = b;
+        auto block_index = [&](size_t begin) {
+            auto it = block_at.find(begin);
+            if (it == block_at.end()) {
+                throw std::runtime_error("El perfil de " + function.front().result + " no corresponde al código");
+            }
+            return it->second;
+        };
+        std::vector<uint64_t> frequency(count, 0);
+        for (const auto& [begin, executions] : profile.blocks) frequency[block_index(begin)] = executions;
+        if (frequency[0] == 0) return;
+
+        struct Edge {
+            size_t from;
+            size_t to;
+            uint64_t count;
+        };
+        std::vector<Edge> edges;
+        for (const auto& [edge, executions] : profile.edges) {
+            edges.push_back({block_index(edge.first), block_index(edge.second), executions});
+        }
+        std::stable_sort(edges.begin(), edges.end(), [](const Edge& a, const Edge& b) { return a.count > b.count; });
+
+        // Cadenas de Pettis y Hansen: cada bloque empieza en su propia cadena
+        std::vector<std::vector<size_t>> chains(count);
+        std::vector<size_t> chain_of(count);
+        for (size_t b = 0; b < count; b++) {
+            chains[b] = {b};
+            chain_of[b] = b;
+        }
+        for (const auto& edge : edges) {
+            size_t from = chain_of[edge.from];
+            size_t to = chain_of[edge.to];
+            if (edge.count == 0 || edge.to == 0 || from == to) continue;
+            if (chains[from].back() != edge.from || chains[to].front() != edge.to) continue;
+            for (size_t b : chains[to]) {
+                chains[from].push_back(b);
+                chain_of[b] = from;
+            }
+            chains[to].clear();
+        }
+
+        // Orden final: la cadena de entrada, las cadenas calientes y los bloques fríos
+        std::vector<size_t> heads;
+        for (size_t c = 0; c < count; c++) {
+            if (!chains[c].empty() && c != chain_of[0]) heads.push_back(c);
+        }
+        std::sort(heads.begin(), heads.end(), [&](size_t a, size_t b) { return chains[a].front() < chains[b].front(); });
+        std::vector<size_t> order = chains[chain_of[0]];
+        std::vector<size_t> cold;
+        for (size_t c : heads) {
+            bool hot = false;
+            for (size_t b : chains[c]) hot = hot || frequency[b] > 0;
+            std::vector<size_t>& destination = hot ? order : cold;
+            destination.insert(destination.end(), chains[c].begin(), chains[c].end());
+        }
+        stats.cold_blocks += static_cast<int>(cold.size());
+        order.insert(order.end(), cold.begin(), cold.end());
+
+        bool moved = false;
+        for (size_t k = 0; k < count; k++) {
+            if (order[k] != k) {
+                stats.moved_blocks++;
+                moved = true;
+            }
+        }
+        if (!moved) return;
+        stats.functions++;
+
+        // Etiqueta de cada bloque (se crea una si hace falta saltar a un bloque sin etiqueta)
+        std::vector<std::string> labels(count);
+        for (size_t b = 0; b < count; b++) {
+            if (function[cfg.blocks[b].begin].kind == InstructionKind::Label) {
+                labels[b] = function[cfg.blocks[b].begin].label;
+            }
+        }
+        std::vector<bool> new_label(count, false);
+        std::string end_label;
+        auto label_of = [&](size_t b) {
+            std::string& label = (b == end_block) ? end_label : labels[b];
+            if (label.empty()) {
+                label = "L" + std::to_string(next_label++);
+                if (b != end_block) new_label[b] = true;
+            }
+            return label;
+        };
+
+        std::vector<std::vector<Instruction>> blocks(count);
+        for (size_t k = 0; k < count; k++) {
+            size_t b = order[k];
+            size_t next = (k + 1 < count) ? order[k + 1] : end_block;
+            size_t fallthrough = (b + 1 < count) ? b + 1 : end_block;
+            const BasicBlock& block = cfg.blocks[b];
+            std::vector<Instruction>& out = blocks[b];
+            out.assign(function.begin() + block.begin, function.begin() + block.end - 1);
+            Instruction last = function[block.end - 1];
+
+            if (last.is_conditional_jump()) {
+                size_t target = cfg.target_block(last.label);
+                if (next == target && next != fallthrough) {
+                    // El destino queda a continuación: se invierte para saltar al otro camino
+                    last.kind = (last.kind == InstructionKind::If) ? InstructionKind::IfFalse : InstructionKind::If;
+                    last.label = label_of(fallthrough);
+                    out.push_back(last);
+                    stats.inverted_branches++;
+                }
+                else {
+                    out.push_back(last);
+                    if (next != fallthrough) out.push_back(goto_instruction(label_of(fallthrough)));
+                }
+            }
+            else if (last.kind == InstructionKind::Goto) {
+                if (next == cfg.target_block(last.label)) {
+                    stats.removed_jumps++;
+                }
+                else {
+                    out.push_back(last);
+                }
+            }
+            else {
+                out.push_back(last);
+                if (!last.ends_flow() && next != fallthrough) out.push_back(goto_instruction(label_of(fallthrough)));
+            }
+        }
+
+        std::vector<Instruction> result;
+        result.reserve(function.size() + 2 * count);
+        result.push_back(function.front());
+        for (size_t b : order) {
+            if (new_label[b]) result.push_back(label_instruction(labels[b]));
+            result.insert(result.end(), blocks[b].begin(), blocks[b].end());
+        }
+        // Una etiqueta antes de ENDP para los bloques que llegaban al final de la función
+        if (!end_label.empty()) result.push_back(label_instruction(end_label));
+        result.push_back(function.back());
+        function = result;
+    }
+
+    Instruction goto_instruction(const std::string& label) {
+        stats.added_jumps++;
+        return parse_instruction("GOTO " + label);
+    }
+
+    static Instruction label_instruction(const std::string& label) {
+        return parse_instruction(label + ":");
+    }
+};
@@ -0,0 +1,644 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <chrono>
+
+#include "ir_instruction.cpp"
+#include "execution_outcome.cpp"
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define BYTECODE_PROFILE_RDTSC 1
+#endif
+
+/*
+    Máquina virtual de registros para ejecutar el código intermedio.
+
+    BytecodeCompiler traduce cada función (PROC ... ENDP) a instrucciones de tamaño fijo
+    donde los operandos ya no son nombres sino índices de ranura dentro del marco de la
+    función: primero los parámetros, luego las variables y temporales en orden de aparición
+    y al final las constantes. El marco inicial de cada función (ceros y constantes) se
+    prepara una sola vez, así que una llamada solo copia esa plantilla y las instrucciones
+    nunca distinguen entre constantes y variables.
+
+    VirtualMachine ejecuta el bytecode con despacho por "computed goto" (extensión de GCC
+    y Clang; con otros compiladores se usa un switch). La pila de valores y la pila de
+    llamadas se reservan al crear la máquina y no se vuelve a pedir memoria al ejecutar.
+
+    Semántica: enteros de 64 bits con desbordamiento circular, comparaciones y operadores
+    lógicos producen 1 o 0, las variables empiezan en 0, una función que llega a ENDP sin
+    RETURN devuelve 0 y la división entre cero lanza std::runtime_error.
+
+    VirtualMachine::profile() ejecuta igual que run() pero además llena un BytecodeProfile:
+    ejecuciones de cada posición del bytecode, veces que se tomó cada salto y tiempo inclusivo
+    y exclusivo de cada contexto de llamada. El intérprete es una plantilla con el perfilado
+    como parámetro, así que run() se compila sin ninguna de esas instrucciones. Si la
+    ejecución termina con un error, las llamadas en curso se cierran en ese momento.
+    ExecutionProfiler (execution_profiler.cpp) traduce los contadores al código intermedio.
+*/
+
+#if defined(__GNUC__) || defined(__clang__)
+#define BYTECODE_COMPUTED_GOTO 1
+#endif
+
+// El orden de los códigos de operación debe coincidir con la tabla de despacho de VirtualMachine
+enum class Opcode : uint16_t {
+    Move,       // a = b
+    Neg,        // a = -b
+    Not,        // a = !b
+    Add,        // a = b + c
+    Sub,        // a = b - c
+    Mul,        // a = b * c
+    Div,        // a = b / c
+    Eq,         // a = b == c
+    Ne,         // a = b != c
+    Lt,         // a = b < c
+    Gt,         // a = b > c
+    Le,         // a = b <= c
+    Ge,         // a = b >= c
+    And,        // a = b && c
+    Or,         // a = b || c
+    Jump,       // pc = a
+    JumpIf,     // si b != 0: pc = a
+    JumpIfNot,  // si b == 0: pc = a
+    JumpEq,     // si b == c: pc = a
+    JumpNe,     // si b != c: pc = a
+    JumpLt,     // si b < c: pc = a
+    JumpGt,     // si b > c: pc = a
+    JumpLe,     // si b <= c: pc = a
+    JumpGe,     // si b >= c: pc = a
+    Param,      // argumento pendiente = a
+    Call,       // a = función, b = ranura del resultado (-1 si se descarta), c = cantidad de argumentos
+    Return      // devuelve a
+};
+
+struct Bytecode {
+    Opcode op;
+    int32_t a = 0;
+    int32_t b = 0;
+    int32_t c = 0;
+};
+
+struct BytecodeFunction {
+    std::string name;
+    size_t entry = 0;                    // Posición de la primera instrucción en BytecodeModule::code
+    int parameter_count = 0;
+    int slot_count = 0;
+    std::vector<int64_t> initial_slots;  // Plantilla del marco: ceros y constantes
+    std::vector<std::string> slot_names; // Nombre de cada ranura (para depurar)
+};
+
+struct BytecodeModule {
+    std::vector<Bytecode> code;
+    std::vector<BytecodeFunction> functions;
+    std::unordered_map<std::string, int> function_index; // Incluye los alias
+
+    // Posición en code donde empieza cada instrucción del código intermedio compilado. Una
+    // etiqueta apunta a la instrucción que la sigue y ENDP al RETURN implícito de la función
+    std::vector<size_t> instruction_positions;
+
+    int find_function(const std::string& name) const {
+        auto it = function_index.find(name);
+        return (it == function_index.end()) ? -1 : it->second;
+    }
+};
+
+class BytecodeCompiler {
+public:
+    // Estadísticas de la última llamada a compile()
+    struct Stats {
+        int functions = 0;
+        int instructions = 0;
+        int slots = 0;      // Total de ranuras de todas las funciones
+        int constants = 0;  // Constantes distintas guardadas en las plantillas de marco
+    };
+
+    BytecodeCompiler() {}
+
+    BytecodeModule compile(const std::vector<std::string>& code) {
+        stats = Stats();
+        std::vector<Instruction> instructions = parse_instructions(code);
+        std::vector<std::pair<size_t, size_t>> ranges = function_ranges(instructions);
+
+        // Primero se registran los nombres para poder resolver llamadas hacia adelante
+        BytecodeModule module;
+        for (const auto& range : ranges) {
+            const std::string& name = instructions[range.first].result;
+            if (module.function_index.count(name)) {
+                throw std::runtime_error("Función " + name + " definida más de una vez");
+            }
+            module.function_index[name] = static_cast<int>(module.functions.size());
+            BytecodeFunction function;
+            function.name = name;
+            function.parameter_count = static_cast<int>(instructions[range.first].parameters.size());
+            module.functions.push_back(function);
+        }
+        for (const auto& inst : instructions) {
+            if (inst.kind != InstructionKind::Alias) continue;
+            auto target = module.function_index.find(inst.callee);
+            if (target == module.function_index.end()) {
+                throw std::runtime_error("ALIAS " + inst.result + " hacia una función inexistente: " + inst.callee);
+            }
+            module.function_index[inst.result] = target->second;
+        }
+
+        module.instruction_positions.assign(instructions.size(), 0);
+        for (size_t f = 0; f < ranges.size(); f++) {
+            compile_function(instructions, ranges[f].first, ranges[f].second, module, module.functions[f]);
+        }
+
+        stats.functions = static_cast<int>(module.functions.size());
+        stats.instructions = static_cast<int>(module.code.size());
+        return module;
+    }
+
+    const Stats& last_stats() const {
+        return stats;
+    }
+
+private:
+    Stats stats;
+
+    struct FunctionState {
+        std::unordered_map<std::string, int> slots;
+        std::unordered_map<long long, int> constants;
+        std::unordered_map<std::string, size_t> labels;
+        std::vector<std::pair<size_t, std::string>> pending_jumps; // Posición del salto -> etiqueta
+        int scratch = -1; // Ranura auxiliar para condiciones que no son comparaciones
+    };
+
+    void compile_function(const std::vector<Instruction>& code, size_t begin, size_t end,
+                          BytecodeModule& module, BytecodeFunction& function) {
+        FunctionState state;
+        function.entry = module.code.size();
+
+        // Los parámetros ocupan las primeras ranuras, en orden
+        for (const auto& param : code[begin].parameters) {
+            if (state.slots.count(param)) {
+                throw std::runtime_error("Parámetro " + param + " repetido en la función " + function.name);
+            }
+            state.slots[param] = static_cast<int>(function.slot_names.size());
+            function.slot_names.push_back(param);
+        }
+
+        // Las variables y temporales siguen a los parámetros y las constantes van al final
+        for (size_t i = begin + 1; i + 1 < end; i++) {
+            for (const std::string* name : {&code[i].result, &code[i].arg1, &code[i].arg2}) {
+                if (name->empty() || is_constant(*name)) continue;
+                if (name == &code[i].result && code[i].defined().empty()) continue;
+                if (!state.slots.count(*name)) {
+                    state.slots[*name] = static_cast<int>(function.slot_names.size());
+                    function.slot_names.push_back(*name);
+                }
+            }
+        }
+        function.initial_slots.assign(function.slot_names.size(), 0);
+
+        module.instruction_positions[begin] = function.entry;
+        for (size_t i = begin + 1; i + 1 < end; i++) {
+            module.instruction_positions[i] = module.code.size();
+            compile_instruction(code[i], module, function, state);
+        }
+
+        // Una función que llega a ENDP devuelve 0
+        module.instruction_positions[end - 1] = module.code.size();
+        emit(module, Opcode::Return, operand(function, state, "0"));
+
+        for (const auto& [position, label] : state.pending_jumps) {
+            auto it = state.labels.find(label);
+            if (it == state.labels.end()) {
+                throw std::runtime_error("Etiqueta " + label + " no definida en la función " + function.name);
+            }
+            module.code[position].a = static_cast<int32_t>(it->second);
+        }
+
+        function.slot_count = static_cast<int>(function.initial_slots.size());
+        stats.slots += function.slot_count;
+    }
+
+    void compile_instruction(const Instruction& inst, BytecodeModule& module,
+                             BytecodeFunction& function, FunctionState& state) {
+        switch (inst.kind) {
+            case InstructionKind::Label:
+                state.labels[inst.label] = module.code.size();
+                break;
+            case InstructionKind::Goto:
+                jump(module, state, Opcode::Jump, inst.label, 0, 0);
+                break;
+            case InstructionKind::If:
+            case InstructionKind::IfFalse: {
+                bool negate = inst.kind == InstructionKind::IfFalse;
+                int left = operand(function, state, inst.arg1);
+                if (inst.op.empty()) {
+                    jump(module, state, negate ? Opcode::JumpIfNot : Opcode::JumpIf, inst.label, left, 0);
+                    break;
+                }
+                int right = operand(function, state, inst.arg2);
+                std::string c = canonical_operator(inst.op);
+                Opcode compare;
+                if (compare_jump(c, negate, compare)) {
+                    jump(module, state, compare, inst.label, left, right);
+                }
+                else {
+                    // Condición con operador lógico o aritmético: se evalúa en una ranura auxiliar
+                    if (state.scratch < 0) state.scratch = new_slot(function, "%cond", 0);
+                    emit(module, binary_opcode(c), state.scratch, left, right);
+                    jump(module, state, negate ? Opcode::JumpIfNot : Opcode::JumpIf, inst.label, state.scratch, 0);
+                }
+                break;
+            }
+            case InstructionKind::Return:
+                emit(module, Opcode::Return, operand(function, state, inst.arg1.empty() ? "0" : inst.arg1));
+                break;
+            case InstructionKind::Copy:
+                emit(module, Opcode::Move, state.slots.at(inst.result), operand(function, state, inst.arg1));
+                break;
+            case InstructionKind::Binary:
+                emit(module, binary_opcode(canonical_operator(inst.op)), state.slots.at(inst.result),
+                     operand(function, state, inst.arg1), operand(function, state, inst.arg2));
+                break;
+            case InstructionKind::Unary:
+                emit(module, inst.op == "-" ? Opcode::Neg : Opcode::Not, state.slots.at(inst.result),
+                     operand(function, state, inst.arg1));
+                break;
+            case InstructionKind::Param:
+                emit(module, Opcode::Param, operand(function, state, inst.arg1));
+                break;
+            case InstructionKind::Call: {
+                int callee = module.find_function(inst.callee);
+                if (callee < 0) {
+                    throw std::runtime_error("Llamada a una función no definida: " + inst.callee);
+                }
+                if (inst.arg_count != module.functions[callee].parameter_count) {
+                    throw std::runtime_error("La función " + inst.callee + " espera " +
+                                             std::to_string(module.functions[callee].parameter_count) +
+                                             " argumentos y se llama con " + std::to_string(inst.arg_count));
+                }
+                int result = inst.result.empty() ? -1 : state.slots.at(inst.result);
+                emit(module, Opcode::Call, callee, result, inst.arg_count);
+                break;
+            }
+            default:
+                throw std::runtime_error("Instrucción no soportada por la máquina virtual: " + inst.to_string());
+        }
+    }
+
+    static bool compare_jump(const std::string& op, bool negate, Opcode& opcode) {
+        // IF_FALSE a < b equivale a IF a >= b
+        if (op == "==") opcode = negate ? Opcode::JumpNe : Opcode::JumpEq;
+        else if (op == "!=") opcode = negate ? Opcode::JumpEq : Opcode::JumpNe;
+        else if (op == "<") opcode = negate ? Opcode::JumpGe : Opcode::JumpLt;
+        else if (op == ">") opcode = negate ? Opcode::JumpLe : Opcode::JumpGt;
+        else if (op == "<=") opcode = negate ? Opcode::JumpGt : Opcode::JumpLe;
+        else if (op == ">=") opcode = negate ? Opcode::JumpLt : Opcode::JumpGe;
+        else return false;
+        return true;
+    }
+
+    static Opcode binary_opcode(const std::string& op) {
+        if (op == "+") return Opcode::Add;
+        if (op == "-") return Opcode::Sub;
+        if (op == "*") return Opcode::Mul;
+        if (op == "/") return Opcode::Div;
+        if (op == "==") return Opcode::Eq;
+        if (op == "!=") return Opcode::Ne;
+        if (op == "<") return Opcode::Lt;
+        if (op == ">") return Opcode::Gt;
+        if (op == "<=") return Opcode::Le;
+        if (op == ">=") return Opcode::Ge;
+        if (op == "&&") return Opcode::And;
+        if (op == "||") return Opcode::Or;
+        throw std::runtime_error("Operador no soportado por la máquina virtual: " + op);
+    }
+
+    // Ranura de un operando; las constantes se guardan una sola vez en la plantilla del marco
+    int operand(BytecodeFunction& function, FunctionState& state, const std::string& name) {
+        if (!is_constant(name)) {
+            return state.slots.at(name);
+        }
+        long long value = std::stoll(name);
+        auto it = state.constants.find(value);
+        if (it != state.constants.end()) return it->second;
+        int slot = new_slot(function, name, value);
+        state.constants[value] = slot;
+        stats.constants++;
+        return slot;
+    }
+
+    static int new_slot(BytecodeFunction& function, const std::string& name, int64_t value) {
+        function.slot_names.push_back(name);
+        function.initial_slots.push_back(value);
+        return static_cast<int>(function.initial_slots.size()) - 1;
+    }
+
+    static void emit(BytecodeModule& module, Opcode op, int a = 0, int b = 0, int c = 0) {
+        Bytecode bytecode;
+        bytecode.op = op;
+        bytecode.a = a;
+        bytecode.b = b;
+        bytecode.c = c;
+        module.code.push_back(bytecode);
+    }
+
+    static void jump(BytecodeModule& module, FunctionState& state, Opcode op, const std::string& label, int b, int c) {
+        state.pending_jumps.push_back({module.code.size(), label});
+        emit(module, op, 0, b, c);
+    }
+};
+
+// Contadores que llena VirtualMachine::profile(); se acumulan entre ejecuciones del mismo módulo
+struct BytecodeProfile {
+    // Nodo del árbol de contextos de llamada: una función alcanzada por una cadena de llamadas
+    struct Context {
+        int function = -1;
+        int parent = -1;       // -1 para la función ejecutada desde fuera de la máquina
+        uint64_t calls = 0;
+        uint64_t inclusive = 0; // Tiempo incluyendo las funciones llamadas
+        uint64_t exclusive = 0; // Tiempo propio
+        std::vector<std::pair<int, int>> children; // Función llamada -> contexto
+    };
+
+    std::vector<uint64_t> instructions; // Ejecuciones de cada posición de BytecodeModule::code
+    std::vector<uint64_t> taken;        // Veces que se tomó el salto de cada posición
+    std::vector<Context> contexts;
+
+    // Contexto de function llamada desde parent (se crea la primera vez)
+    int context(int parent, int function) {
+        if (parent >= 0) {
+            for (const auto& [callee, child] : contexts[parent].children) {
+                if (callee == function) return child;
+            }
+        }
+        else {
+            for (size_t c = 0; c < contexts.size(); c++) {
+                if (contexts[c].parent < 0 && contexts[c].function == function) return static_cast<int>(c);
+            }
+        }
+        Context context;
+        context.function = function;
+        context.parent = parent;
+        contexts.push_back(context);
+        int index = static_cast<int>(contexts.size()) - 1;
+        if (parent >= 0) contexts[parent].children.push_back({function, index});
+        return index;
+    }
+
+    // Marca de tiempo para inclusive/exclusive: ciclos (rdtsc) en x86, si no nanosegundos
+    static uint64_t now() {
+#ifdef BYTECODE_PROFILE_RDTSC
+        return __rdtsc();
+#else
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+    }
+
+    static const char* time_unit() {
+#ifdef BYTECODE_PROFILE_RDTSC
+        return "ciclos";
+#else
+        return "ns";
+#endif
+    }
+};
+
+class VirtualMachine {
+public:
+    struct Options {
+        size_t stack_slots = 1 << 20;  // Ranuras de la pila de valores (marcos de todas las llamadas)
+        size_t max_call_depth = 1 << 16;
+    };
+
+    VirtualMachine() : VirtualMachine(Options()) {}
+    VirtualMachine(Options options) : options(options) {
+        stack.resize(options.stack_slots);
+        arguments.resize(options.stack_slots);
+        frames.resize(options.max_call_depth);
+    }
+
+    // Función para ejecutar una función del módulo y obtener el valor de su RETURN
+    int64_t run(const BytecodeModule& module, const std::string& name, const std::vector<int64_t>& args = {}) {
+        int index = prepare(module, name, args);
+        return execute<false>(module, index, args.size(), nullptr);
+    }
+
+    // Igual que run(), sumando los contadores de la ejecución a profile
+    int64_t profile(const BytecodeModule& module, const std::string& name, const std::vector<int64_t>& args,
+                    BytecodeProfile& profile) {
+        int index = prepare(module, name, args);
+        if (profile.instructions.size() != module.code.size()) {
+            profile = BytecodeProfile();
+            profile.instructions.assign(module.code.size(), 0);
+            profile.taken.assign(module.code.size(), 0);
+        }
+        try {
+            return execute<true>(module, index, args.size(), &profile);
+        }
+        catch (...) {
+            // Las llamadas que terminan por un error suman su tiempo hasta que el error sale de la máquina
+            while (!profile_frames.empty()) leave(&profile, profile_frames);
+            throw;
+        }
+    }
+
+private:
+    struct Frame {
+        const Bytecode* return_pc;
+        int64_t* slots;
+        int32_t result;
+    };
+
+    // Llamada en curso mientras se perfila
+    struct ProfileFrame {
+        int context;
+        uint64_t start;
+        uint64_t children; // Tiempo inclusivo de las llamadas que ya terminaron
+    };
+
+    Options options;
+    std::vector<int64_t> stack;
+    std::vector<int64_t> arguments;
+    std::vector<Frame> frames;
+    std::vector<ProfileFrame> profile_frames;
+
+    int prepare(const BytecodeModule& module, const std::string& name, const std::vector<int64_t>& args) {
+        int index = module.find_function(name);
+        if (index < 0) {
+            throw std::runtime_error("La función " + name + " no existe");
+        }
+        const BytecodeFunction& function = module.functions[index];
+        if (static_cast<int>(args.size()) != function.parameter_count) {
+            throw std::runtime_error("La función " + name + " espera " + std::to_string(function.parameter_count) +
+                                     " argumentos");
+        }
+        for (size_t i = 0; i < args.size(); i++) arguments[i] = args[i];
+        return index;
+    }
+
+    static void enter(BytecodeProfile* profile, std::vector<ProfileFrame>& active, int function) {
+        int parent = active.empty() ? -1 : active.back().context;
+        int context = profile->context(parent, function);
+        profile->contexts[context].calls++;
+        active.push_back({context, BytecodeProfile::now(), 0});
+    }
+
+    static void leave(BytecodeProfile* profile, std::vector<ProfileFrame>& active) {
+        ProfileFrame finished = active.back();
+        active.pop_back();
+        uint64_t elapsed = BytecodeProfile::now() - finished.start;
+        BytecodeProfile::Context& context = profile->contexts[finished.context];
+        context.inclusive += elapsed;
+        context.exclusive += elapsed - std::min(elapsed, finished.children);
+        if (!active.empty()) active.back().children += elapsed;
+    }
+
+    template <bool Profile>
+    int64_t execute(const BytecodeModule& module, int entry, size_t argument_count, BytecodeProfile* profile) {
+        const Bytecode* code = module.code.data();
+        const BytecodeFunction* functions = module.functions.data();
+        int64_t* stack_end = stack.data() + stack.size();
+        int64_t* arguments_end = arguments.data() + arguments.size();
+        Frame* frames_end = frames.data() + frames.size();
+
+        // Marco de la función inicial, al fondo de la pila
+        const BytecodeFunction& function = functions[entry];
+        if (static_cast<size_t>(function.slot_count) > stack.size()) {
+            throw StackOverflowError("Desbordamiento de la pila de la máquina virtual");
+        }
+        Frame* frame = frames.data();
+        int64_t* slots = stack.data();
+        int64_t* args = arguments.data();
+        std::memcpy(slots, function.initial_slots.data(), function.slot_count * sizeof(int64_t));
+        for (size_t i = 0; i < argument_count; i++) slots[i] = args[i];
+        frame->return_pc = nullptr;
+        frame->slots = slots;
+        frame->result = -1;
+        int slot_count = function.slot_count;
+        const Bytecode* pc = code + function.entry;
+        if constexpr (Profile) {
+            profile_frames.clear();
+            enter(profile, profile_frames, entry);
+        }
+
+#define VM_SIGNED(x) static_cast<int64_t>(x)
+#define VM_UNSIGNED(x) static_cast<uint64_t>(x)
+
+#ifdef BYTECODE_COMPUTED_GOTO
+        static void* const dispatch[] = {
+            &&op_Move, &&op_Neg, &&op_Not, &&op_Add, &&op_Sub, &&op_Mul, &&op_Div,
+            &&op_Eq, &&op_Ne, &&op_Lt, &&op_Gt, &&op_Le, &&op_Ge, &&op_And, &&op_Or,
+            &&op_Jump, &&op_JumpIf, &&op_JumpIfNot, &&op_JumpEq, &&op_JumpNe, &&op_JumpLt,
+            &&op_JumpGt, &&op_JumpLe, &&op_JumpGe, &&op_Param, &&op_Call, &&op_Return
+        };
+#define VM_CASE(name) op_##name:
+#define VM_NEXT() do { VM_COUNT(); goto *dispatch[static_cast<int>(pc->op)]; } while (0)
+#else
+#define VM_CASE(name) case Opcode::name:
+#define VM_NEXT() continue
+#endif
+        // Con Profile = false estas macros no generan código
+#define VM_COUNT() if constexpr (Profile) profile->instructions[pc - code]++
+#define VM_BRANCH(condition) {                                                        \
+            bool jump = (condition);                                                  \
+            if constexpr (Profile) profile->taken[pc - code] += jump;                 \
+            pc = jump ? code + pc->a : pc + 1;                                        \
+            VM_NEXT();                                                                \
+        }
+#ifdef BYTECODE_COMPUTED_GOTO
+        VM_NEXT();
+#else
+        for (;;) {
+        VM_COUNT();
+        switch (pc->op) {
+#endif
+        VM_CASE(Move) slots[pc->a] = slots[pc->b]; pc++; VM_NEXT();
+        VM_CASE(Neg) slots[pc->a] = VM_SIGNED(0 - VM_UNSIGNED(slots[pc->b])); pc++; VM_NEXT();
+        VM_CASE(Not) slots[pc->a] = !slots[pc->b]; pc++; VM_NEXT();
+        VM_CASE(Add) slots[pc->a] = VM_SIGNED(VM_UNSIGNED(slots[pc->b]) + VM_UNSIGNED(slots[pc->c])); pc++; VM_NEXT();
+        VM_CASE(Sub) slots[pc->a] = VM_SIGNED(VM_UNSIGNED(slots[pc->b]) - VM_UNSIGNED(slots[pc->c])); pc++; VM_NEXT();
+        VM_CASE(Mul) slots[pc->a] = VM_SIGNED(VM_UNSIGNED(slots[pc->b]) * VM_UNSIGNED(slots[pc->c])); pc++; VM_NEXT();
+        VM_CASE(Div) {
+            int64_t divisor = slots[pc->c];
+            if (divisor == 0) {
+                throw std::runtime_error("División entre cero");
+            }
+            slots[pc->a] = (divisor == -1) ? VM_SIGNED(0 - VM_UNSIGNED(slots[pc->b])) : slots[pc->b] / divisor;
+            pc++;
+            VM_NEXT();
+        }
+        VM_CASE(Eq) slots[pc->a] = slots[pc->b] == slots[pc->c]; pc++; VM_NEXT();
+        VM_CASE(Ne) slots[pc->a] = slots[pc->b] != slots[pc->c]; pc++; VM_NEXT();
+        VM_CASE(Lt) slots[pc->a] = slots[pc->b] < slots[pc->c]; pc++; VM_NEXT();
+        VM_CASE(Gt) slots[pc->a] = slots[pc->b] > slots[pc->c]; pc++; VM_NEXT();
+        VM_CASE(Le) slots[pc->a] = slots[pc->b] <= slots[pc->c]; pc++; VM_NEXT();
+        VM_CASE(Ge) slots[pc->a] = slots[pc->b] >= slots[pc->c]; pc++; VM_NEXT();
+        VM_CASE(And) slots[pc->a] = slots[pc->b] && slots[pc->c]; pc++; VM_NEXT();
+        VM_CASE(Or) slots[pc->a] = slots[pc->b] || slots[pc->c]; pc++; VM_NEXT();
+        VM_CASE(Jump) VM_BRANCH(true)
+        VM_CASE(JumpIf) VM_BRANCH(slots[pc->b])
+        VM_CASE(JumpIfNot) VM_BRANCH(!slots[pc->b])
+        VM_CASE(JumpEq) VM_BRANCH(slots[pc->b] == slots[pc->c])
+        VM_CASE(JumpNe) VM_BRANCH(slots[pc->b] != slots[pc->c])
+        VM_CASE(JumpLt) VM_BRANCH(slots[pc->b] < slots[pc->c])
+        VM_CASE(JumpGt) VM_BRANCH(slots[pc->b] > slots[pc->c])
+        VM_CASE(JumpLe) VM_BRANCH(slots[pc->b] <= slots[pc->c])
+        VM_CASE(JumpGe) VM_BRANCH(slots[pc->b] >= slots[pc->c])
+        VM_CASE(Param) {
+            if (args == arguments_end) {
+                throw std::runtime_error("Demasiados argumentos pendientes en la máquina virtual");
+            }
+            *args++ = slots[pc->a];
+            pc++;
+            VM_NEXT();
+        }
+        VM_CASE(Call) {
+            const BytecodeFunction& callee = functions[pc->a];
+            int64_t* callee_slots = slots + slot_count;
+            if (frame + 1 == frames_end || callee_slots + callee.slot_count > stack_end) {
+                throw StackOverflowError("Desbordamiento de la pila de la máquina virtual al llamar a " + callee.name);
+            }
+            std::memcpy(callee_slots, callee.initial_slots.data(), callee.slot_count * sizeof(int64_t));
+            args -= pc->c;
+            for (int i = 0; i < pc->c; i++) callee_slots[i] = args[i];
+
+            frame->return_pc = pc + 1;
+            frame->result = pc->b;
+            frame++;
+            if constexpr (Profile) enter(profile, profile_frames, pc->a);
+            frame->slots = slots = callee_slots;
+            slot_count = callee.slot_count;
+            pc = code + callee.entry;
+            VM_NEXT();
+        }
+        VM_CASE(Return) {
+            int64_t value = slots[pc->a];
+            if constexpr (Profile) leave(profile, profile_frames);
+            if (frame == frames.data()) {
+                return value;
+            }
+            frame--;
+            slot_count = static_cast<int>(slots - frame->slots);
+            slots = frame->slots;
+            if (frame->result >= 0) slots[frame->result] = value;
+            pc = frame->return_pc;
+            VM_NEXT();
+        }
+#ifndef BYTECODE_COMPUTED_GOTO
+        }
+        }
+#endif
+
+#undef VM_CASE
+#undef VM_NEXT
+#undef VM_COUNT
+#undef VM_BRANCH
+#undef VM_SIGNED
+#undef VM_UNSIGNED
+    }
+};
@@ -0,0 +1,425 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+#include <stdexcept>
+#include <unistd.h>
+
+#include "compiler_pipeline.cpp"
+
+/*
+    Caché en disco del código intermedio, direccionada por contenido.
+
+    Hay dos tipos de entrada:
+        - Programa (p<hash>.ir): el código final de un programa completo. La clave combina
+          el texto del fuente, las opciones (si se optimiza) y CompileCache::version. En un
+          acierto no se ejecuta ninguna fase.
+        - Función (f<hash>.ir): el código intermedio sin optimizar de una sola función,
+          generado con la numeración de temporales y etiquetas desde 0, junto con cuántos
+          de cada uno creó. La clave es el texto de la función y la versión.
+
+    Cuando falla la entrada del programa, el fuente se divide en funciones con un recorrido
+    simple del texto (palabra function y llaves balanceadas, saltando comentarios). Solo se
+    analizan y generan las funciones que no están en la caché; el código de cada función se
+    reubica sumando los temporales y etiquetas de las anteriores, lo que da exactamente el
+    mismo código que IntermediateCodeGenerator sobre el programa entero. Después se optimiza
+    el programa completo (la optimización mira varias funciones a la vez, como la expansión
+    en línea, así que no se guarda por función).
+
+    Si el fuente no puede dividirse, si una función no compila sola o si usa nombres con la
+    forma de una etiqueta (L0, que no podría reubicarse), el programa se compila entero, con
+    los mismos errores que compile_source().
+
+    Cada archivo se escribe en un temporal del mismo directorio y se renombra, así que
+    varios procesos pueden compartir la caché sin leer entradas a medio escribir. Cada
+    entrada guarda un segundo hash y la longitud del texto; una entrada que no coincide o
+    está dañada cuenta como fallo. El tamaño total se limita a Options::max_bytes quitando
+    las entradas usadas hace más tiempo (la fecha de modificación se actualiza en cada
+    acierto). Un mismo objeto puede usarse desde varios hilos.
+*/
+
+class CompileCache {
+public:
+    // Aumentar cuando cambie el código que produce alguna fase, para no usar entradas viejas
+    static constexpr int version = 2;
+
+    struct Options {
+        std::string directory;
+        uint64_t max_bytes = 256ull << 20;
+        bool optimize = true;
+        bool per_function = true;
+    };
+
+    struct Stats {
+        uint64_t program_hits = 0;
+        uint64_t program_misses = 0;
+        uint64_t function_hits = 0;
+        uint64_t function_misses = 0;
+        uint64_t full_compiles = 0;    // Programas que no pudieron compilarse por funciones
+        uint64_t stored = 0;
+        uint64_t evicted = 0;
+        uint64_t bytes = 0;            // Tamaño estimado de la caché
+    };
+
+    explicit CompileCache(const Options& options) : options(options) {
+        if (options.directory.empty()) {
+            throw std::runtime_error("La caché necesita un directorio");
+        }
+        std::filesystem::create_directories(options.directory);
+        evict();
+    }
+
+    // Código intermedio de un programa, de la caché o compilado (y guardado)
+    std::vector<std::string> compile(const std::string& source) {
+        std::string key = std::string("program ") + (options.optimize ? "O1" : "O0");
+        std::string program_path = entry_path('p', source, key);
+        Entry entry;
+        if (read_entry(program_path, source, key, entry)) {
+            program_hits++;
+            return entry.code;
+        }
+        program_misses++;
+
+        std::vector<std::string> code;
+        if (!options.per_function || !compile_by_functions(source, code)) {
+            full_compiles++;
+            code = compile_source(source);
+        }
+        if (options.optimize) code = optimize_code(code);
+
+        entry.code = code;
+        write_entry(program_path, source, key, entry);
+        return code;
+    }
+
+    Stats stats() const {
+        Stats result;
+        result.program_hits = program_hits;
+        result.program_misses = program_misses;
+        result.function_hits = function_hits;
+        result.function_misses = function_misses;
+        result.full_compiles = full_compiles;
+        result.stored = stored;
+        result.evicted = evicted;
+        result.bytes = bytes;
+        return result;
+    }
+
+    std::string report() const {
+        Stats s = stats();
+        std::ostringstream out;
+        out << "Caché " << options.directory << ": programas " << s.program_hits << " aciertos / " << s.program_misses
+            << " fallos, funciones " << s.function_hits << " aciertos / " << s.function_misses << " fallos, "
+            << s.full_compiles << " compilados enteros, " << s.stored << " entradas escritas, " << s.evicted
+            << " quitadas, " << s.bytes / 1024 << " KB\n";
+        return out.str();
+    }
+
+    // Quita las entradas más viejas hasta que la caché entra en max_bytes
+    void evict() {
+        std::lock_guard<std::mutex> lock(evict_mutex);
+        struct File {
+            std::filesystem::path path;
+            std::filesystem::file_time_type time;
+            uint64_t size;
+        };
+        std::vector<File> files;
+        uint64_t total = 0;
+        std::error_code error;
+        auto stale = std::filesystem::file_time_type::clock::now() - std::chrono::hours(1);
+        for (const auto& item : std::filesystem::directory_iterator(options.directory, error)) {
+            std::error_code item_error;
+            auto time = item.last_write_time(item_error);
+            uint64_t size = item.file_size(item_error);
+            if (item_error) continue;
+            if (item.path().extension() == ".tmp") {
+                // Temporales de escrituras interrumpidas
+                if (time < stale) std::filesystem::remove(item.path(), item_error);
+                continue;
+            }
+            if (item.path().extension() != ".ir") continue;
+            files.push_back({item.path(), time, size});
+            total += size;
+        }
+        if (total > options.max_bytes) {
+            std::sort(files.begin(), files.end(), [](const File& a, const File& b) { return a.time < b.time; });
+            for (const auto& file : files) {
+                if (total <= options.max_bytes) break;
+                std::error_code remove_error;
+                if (std::filesystem::remove(file.path, remove_error)) {
+                    total -= file.size;
+                    evicted++;
+                }
+            }
+        }
+        bytes = total;
+    }
+
+    // Hash FNV-1a de 64 bits con una base dada (dos bases distintas dan dos hashes independientes)
+    static uint64_t hash(const std::string& text, uint64_t basis = 14695981039346656037ULL) {
+        return hash(text.data(), text.size(), basis);
+    }
+
+    static uint64_t hash(const char* data, size_t size, uint64_t basis = 14695981039346656037ULL) {
+        uint64_t h = basis;
+        for (size_t i = 0; i < size; i++) {
+            h ^= static_cast<unsigned char>(data[i]);
+            h *= 1099511628211ULL;
+        }
+        return h;
+    }
+
+    // Rangos [inicio, fin) del texto de cada función; false si hay algo más que funciones,
+    // espacios y comentarios fuera de ellas o las llaves no están balanceadas
+    static bool split_functions(const std::string& source, std::vector<std::pair<size_t, size_t>>& ranges) {
+        ranges.clear();
+        return split_functions(source, 0, source.size(), ranges);
+    }
+
+    // Lo mismo sobre el tramo [begin, end) del fuente, que debe empezar fuera de una función:
+    // los rangos se agregan a ranges y ninguna función ni comentario puede pasar de end
+    static bool split_functions(const std::string& source, size_t begin, size_t end,
+                                std::vector<std::pair<size_t, size_t>>& ranges) {
+        static const std::string keyword = "function";
+        auto is_name = [](char c) { return std::isalnum(static_cast<unsigned char>(c)) || c == '_'; };
+        auto skip_comment = [&](size_t& i) {
+            if (source[i] != '/' || i + 1 >= source.size() || source[i + 1] != '/') return false;
+            size_t newline = source.find('\n', i);
+            i = (newline == std::string::npos) ? source.size() : newline;
+            return true;
+        };
+
+        size_t i = begin;
+        while (i < end) {
+            if (std::isspace(static_cast<unsigned char>(source[i]))) {
+                i++;
+                continue;
+            }
+            if (skip_comment(i)) continue;
+            if (source.compare(i, keyword.size(), keyword) != 0 ||
+                (i + keyword.size() < source.size() && is_name(source[i + keyword.size()]))) {
+                return false;
+            }
+
+            size_t first = i;
+            int depth = 0;
+            bool opened = false;
+            for (i += keyword.size(); i < end && !(opened && depth == 0); ) {
+                if (skip_comment(i)) continue;
+                if (source[i] == '{') {
+                    depth++;
+                    opened = true;
+                }
+                else if (source[i] == '}' && --depth < 0) {
+                    return false;
+                }
+                i++;
+            }
+            if (!opened || depth != 0 || i > end) return false;
+            ranges.push_back({first, i});
+        }
+        return i == end;
+    }
+
+    // Indica si ningún nombre tiene la forma de una etiqueta (L0), que relocate() no podría
+    // distinguir de las que crea el generador (los temporales %tN no chocan con identificadores)
+    static bool relocatable(const std::vector<Token>& tokens) {
+        for (const auto& token : tokens) {
+            if (token.type == "ID" && name_number(token.value, 'L') >= 0) return false;
+        }
+        return true;
+    }
+
+    // Suma los desplazamientos a los temporales (%tN) y etiquetas (LN) de una línea
+    static std::string relocate(const std::string& line, int temp_offset, int label_offset) {
+        if (temp_offset == 0 && label_offset == 0) return line;
+        auto is_word = [](char c) { return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '%'; };
+        std::string result;
+        result.reserve(line.size() + 4);
+        size_t i = 0;
+        while (i < line.size()) {
+            if (!is_word(line[i])) {
+                result += line[i++];
+                continue;
+            }
+            size_t end = i;
+            while (end < line.size() && is_word(line[end])) end++;
+            std::string word = line.substr(i, end - i);
+            if (is_temp(word)) {
+                result += temp_name(temp_number(word) + temp_offset);
+            }
+            else if (name_number(word, 'L') >= 0) {
+                result += "L" + std::to_string(name_number(word, 'L') + label_offset);
+            }
+            else {
+                result += word;
+            }
+            i = end;
+        }
+        return result;
+    }
+
+private:
+    struct Entry {
+        int temps = 0;
+        int labels = 0;
+        std::vector<std::string> code;
+    };
+
+    Options options;
+    std::mutex evict_mutex;
+    std::atomic<uint64_t> program_hits{0};
+    std::atomic<uint64_t> program_misses{0};
+    std::atomic<uint64_t> function_hits{0};
+    std::atomic<uint64_t> function_misses{0};
+    std::atomic<uint64_t> full_compiles{0};
+    std::atomic<uint64_t> stored{0};
+    std::atomic<uint64_t> evicted{0};
+    std::atomic<uint64_t> bytes{0};
+    std::atomic<uint64_t> temporary_files{0};
+
+    static constexpr uint64_t check_basis = 0x6c62272e07bb0142ULL; // Base del segundo hash
+
+    static std::string hex(uint64_t value) {
+        char buffer[17];
+        std::snprintf(buffer, sizeof(buffer), "%016llx", static_cast<unsigned long long>(value));
+        return buffer;
+    }
+
+    // Texto completo de la clave: tipo de entrada, versión y contenido
+    static std::string key_text(const std::string& text, const std::string& key) {
+        return key + " v" + std::to_string(version) + "\n" + text;
+    }
+
+    std::string entry_path(char kind, const std::string& text, const std::string& key) const {
+        return options.directory + "/" + kind + hex(hash(key_text(text, key))) + ".ir";
+    }
+
+    // Primera línea de una entrada: formato, segundo hash, longitud del texto y conteos
+    static std::string header(const std::string& text, const std::string& key, const Entry& entry) {
+        return "IRCACHE " + std::to_string(version) + " " + hex(hash(key_text(text, key), check_basis)) + " " +
+               std::to_string(text.size()) + " " + std::to_string(entry.temps) + " " + std::to_string(entry.labels) +
+               " " + std::to_string(entry.code.size());
+    }
+
+    bool read_entry(const std::string& path, const std::string& text, const std::string& key, Entry& entry) {
+        std::ifstream file(path);
+        if (!file) return false;
+        std::string first;
+        std::getline(file, first);
+        std::istringstream fields(first);
+        std::string format, check;
+        int entry_version = 0;
+        size_t length = 0, lines = 0;
+        fields >> format >> entry_version >> check >> length >> entry.temps >> entry.labels >> lines;
+        bool valid = fields && format == "IRCACHE" && entry_version == version &&
+                     check == hex(hash(key_text(text, key), check_basis)) && length == text.size();
+        entry.code.clear();
+        std::string line;
+        while (valid && entry.code.size() < lines && std::getline(file, line)) entry.code.push_back(line);
+        if (!valid || entry.code.size() != lines) {
+            // Entrada de otra versión, dañada o de otra clave con el mismo hash
+            file.close();
+            std::error_code error;
+            std::filesystem::remove(path, error);
+            return false;
+        }
+
+        // Uso reciente para el orden de reemplazo
+        std::error_code error;
+        std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), error);
+        return true;
+    }
+
+    void write_entry(const std::string& path, const std::string& text, const std::string& key, const Entry& entry) {
+        std::string temporary = path + "." + std::to_string(getpid()) + "-" +
+                                std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + "-" +
+                                std::to_string(temporary_files++) + ".tmp";
+        uint64_t size = 0;
+        {
+            std::ofstream file(temporary, std::ios::trunc);
+            if (!file) return; // La caché es opcional: sin permiso de escritura se compila igual
+            file << header(text, key, entry) << "\n";
+            for (const auto& line : entry.code) file << line << "\n";
+            size = static_cast<uint64_t>(file.tellp());
+            if (!file) {
+                file.close();
+                std::remove(temporary.c_str());
+                return;
+            }
+        }
+        if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+            std::remove(temporary.c_str());
+            return;
+        }
+        stored++;
+        if ((bytes += size) > options.max_bytes) evict();
+    }
+
+    bool compile_by_functions(const std::string& source, std::vector<std::string>& code) {
+        std::vector<std::pair<size_t, size_t>> ranges;
+        if (!split_functions(source, ranges)) return false;
+
+        static const std::string key = "function";
+        std::vector<Entry> entries(ranges.size());
+        std::vector<std::string> texts(ranges.size());
+        std::vector<bool> missing(ranges.size(), false);
+        for (size_t f = 0; f < ranges.size(); f++) {
+            texts[f] = source.substr(ranges[f].first, ranges[f].second - ranges[f].first);
+            if (read_entry(entry_path('f', texts[f], key), texts[f], key, entries[f])) {
+                function_hits++;
+            }
+            else {
+                function_misses++;
+                missing[f] = true;
+                if (!compile_function(texts[f], entries[f])) return false;
+            }
+        }
+        for (size_t f = 0; f < ranges.size(); f++) {
+            if (missing[f]) write_entry(entry_path('f', texts[f], key), texts[f], key, entries[f]);
+        }
+
+        // Cada función continúa la numeración de las anteriores
+        code.clear();
+        int temps = 0, labels = 0;
+        for (const auto& entry : entries) {
+            for (const auto& line : entry.code) code.push_back(relocate(line, temps, labels));
+            temps += entry.temps;
+            labels += entry.labels;
+        }
+        return true;
+    }
+
+    // Compilación de una sola función; false si no es exactamente una función válida y reubicable
+    static bool compile_function(const std::string& text, Entry& entry) {
+        try {
+            Lexer lexer(text);
+            std::vector<Token> tokens = lexer.tokenizer();
+            if (!relocatable(tokens)) return false;
+            Parser parser(std::move(tokens));
+            ProgramNode* ast = parser.parse();
+            std::vector<Function> functions = convert_program(ast);
+            delete ast;
+            if (functions.size() != 1) return false;
+
+            IntermediateCodeGenerator generator;
+            entry.code = generator.generate(functions);
+            entry.temps = generator.temps_created();
+            entry.labels = generator.labels_created();
+            return true;
+        }
+        catch (const std::exception&) {
+            return false;
+        }
+    }
+};
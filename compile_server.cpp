@@ -0,0 +1,276 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <thread>
+#include <chrono>
+#include <filesystem>
+#include <cstring>
+#include <cerrno>
+#include <csignal>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "incremental_compiler.cpp"
+
+/*
+    Servidor de compilación que conserva el estado entre pedidos (IncrementalCompiler).
+
+    Recibe pedidos por la entrada estándar (respuestas por la salida estándar) o, con
+    --socket=ruta, por un socket Unix que atiende una conexión a la vez. Cada pedido es una
+    línea; cada respuesta empieza con "OK" o con "ERROR mensaje":
+
+        COMPILE archivo            Lee el archivo del disco y lo recompila
+        SOURCE archivo bytes       Recompila con los 'bytes' bytes que siguen a la línea
+                                   (un fuente que todavía no está guardado)
+            -> OK funciones=N reutilizadas=R compiladas=C incremental=1 ms=X
+        IR archivo                 -> OK N y las N líneas del código intermedio
+        FUNCTION archivo nombre    -> OK N y las N líneas de esa función (sin optimizar)
+        FORGET archivo             Libera el estado del archivo
+        STATS                      -> OK archivos=N funciones=M
+        QUIT                       Cierra la conexión (por la entrada estándar, termina)
+        SHUTDOWN                   Termina el servidor
+
+    Con --watch el servidor no recibe pedidos: vigila los archivos de la línea de comandos
+    (cada --interval milisegundos, 200 por defecto), los recompila cuando cambian, escribe
+    su código intermedio en archivo.ir e informa cada recompilación por la salida estándar.
+
+    Con --optimize las respuestas IR (y los archivos .ir) llevan el código optimizado.
+
+    Uso: compile_server [--socket=ruta | --watch archivo ...] [--interval=200] [--optimize]
+*/
+
+// Lectura por líneas y escritura sobre un descriptor (entrada estándar o una conexión)
+class Connection {
+public:
+    Connection(int input, int output) : input(input), output(output) {}
+
+    bool read_line(std::string& line) {
+        line.clear();
+        while (true) {
+            size_t newline = buffer.find('\n');
+            if (newline != std::string::npos) {
+                line = buffer.substr(0, newline);
+                buffer.erase(0, newline + 1);
+                if (!line.empty() && line.back() == '\r') line.pop_back();
+                return true;
+            }
+            if (!fill()) {
+                line = buffer;
+                buffer.clear();
+                return !line.empty();
+            }
+        }
+    }
+
+    bool read_bytes(size_t count, std::string& bytes) {
+        while (buffer.size() < count) {
+            if (!fill()) return false;
+        }
+        bytes = buffer.substr(0, count);
+        buffer.erase(0, count);
+        return true;
+    }
+
+    void write(const std::string& text) {
+        size_t written = 0;
+        while (written < text.size()) {
+            ssize_t n = ::write(output, text.data() + written, text.size() - written);
+            if (n <= 0) return;
+            written += static_cast<size_t>(n);
+        }
+    }
+
+private:
+    int input;
+    int output;
+    std::string buffer;
+
+    bool fill() {
+        char chunk[65536];
+        ssize_t n = ::read(input, chunk, sizeof(chunk));
+        if (n <= 0) return false;
+        buffer.append(chunk, static_cast<size_t>(n));
+        return true;
+    }
+};
+
+static std::string read_file(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) {
+        throw std::runtime_error("No se pudo leer " + path);
+    }
+    std::stringstream source;
+    source << file.rdbuf();
+    return source.str();
+}
+
+static std::string summary(const IncrementalCompiler::Stats& stats) {
+    std::ostringstream out;
+    out << "funciones=" << stats.functions << " reutilizadas=" << stats.reused << " compiladas=" << stats.compiled
+        << " incremental=" << (stats.incremental ? 1 : 0) << " ms=" << stats.seconds * 1e3;
+    return out.str();
+}
+
+static std::string lines_answer(const std::vector<std::string>& lines) {
+    std::string answer = "OK " + std::to_string(lines.size()) + "\n";
+    for (const auto& line : lines) answer += line + "\n";
+    return answer;
+}
+
+enum class Outcome { Continue, Close, Shutdown };
+
+// Atiende los pedidos de una conexión hasta QUIT, SHUTDOWN o el fin de la entrada
+static Outcome serve(IncrementalCompiler& compiler, Connection& connection) {
+    std::string line;
+    while (connection.read_line(line)) {
+        std::istringstream words(line);
+        std::string command, file;
+        words >> command >> file;
+        if (command.empty()) continue;
+        try {
+            if (command == "COMPILE") {
+                connection.write("OK " + summary(compiler.update(file, read_file(file))) + "\n");
+            }
+            else if (command == "SOURCE") {
+                size_t bytes = 0;
+                std::string source;
+                if (!(words >> bytes) || !connection.read_bytes(bytes, source)) {
+                    throw std::runtime_error("SOURCE necesita la cantidad de bytes y el fuente");
+                }
+                connection.write("OK " + summary(compiler.update(file, source)) + "\n");
+            }
+            else if (command == "IR") {
+                connection.write(lines_answer(compiler.code(file)));
+            }
+            else if (command == "FUNCTION") {
+                std::string function;
+                words >> function;
+                connection.write(lines_answer(compiler.function_code(file, function)));
+            }
+            else if (command == "FORGET") {
+                compiler.forget(file);
+                connection.write("OK\n");
+            }
+            else if (command == "STATS") {
+                connection.write("OK archivos=" + std::to_string(compiler.file_count()) +
+                                 " funciones=" + std::to_string(compiler.function_count()) + "\n");
+            }
+            else if (command == "QUIT") {
+                connection.write("OK\n");
+                return Outcome::Close;
+            }
+            else if (command == "SHUTDOWN") {
+                connection.write("OK\n");
+                return Outcome::Shutdown;
+            }
+            else {
+                throw std::runtime_error("Pedido desconocido: " + command);
+            }
+        }
+        catch (const std::exception& e) {
+            // Los mensajes de error pueden tener saltos de línea; la respuesta ocupa una sola
+            std::string message = e.what();
+            for (char& c : message) {
+                if (c == '\n') c = ' ';
+            }
+            connection.write("ERROR " + message + "\n");
+        }
+    }
+    return Outcome::Close;
+}
+
+static int serve_socket(IncrementalCompiler& compiler, const std::string& path) {
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (listener < 0 || path.size() >= sizeof(address.sun_path)) {
+        std::cerr << "No se pudo crear el socket " << path << std::endl;
+        return 1;
+    }
+    std::strcpy(address.sun_path, path.c_str());
+    std::signal(SIGPIPE, SIG_IGN); // Un cliente que se va no debe terminar el servidor
+    ::unlink(path.c_str());
+    if (bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || listen(listener, 8) != 0) {
+        std::cerr << "No se pudo escuchar en " << path << ": " << std::strerror(errno) << std::endl;
+        ::close(listener);
+        return 1;
+    }
+
+    Outcome outcome = Outcome::Continue;
+    while (outcome != Outcome::Shutdown) {
+        int client = accept(listener, nullptr, nullptr);
+        if (client < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        Connection connection(client, client);
+        outcome = serve(compiler, connection);
+        ::close(client);
+    }
+    ::close(listener);
+    ::unlink(path.c_str());
+    return 0;
+}
+
+static int watch(IncrementalCompiler& compiler, const std::vector<std::string>& paths, int interval) {
+    std::map<std::string, std::filesystem::file_time_type> seen;
+    while (true) {
+        for (const auto& path : paths) {
+            std::error_code error;
+            auto time = std::filesystem::last_write_time(path, error);
+            if (error || (seen.count(path) && seen[path] == time)) continue;
+            seen[path] = time;
+            try {
+                const IncrementalCompiler::Stats& stats = compiler.update(path, read_file(path));
+                std::ofstream output(path + ".ir");
+                for (const auto& line : compiler.code(path)) output << line << "\n";
+                std::cout << path << ": " << summary(stats) << std::endl;
+            }
+            catch (const std::exception& e) {
+                std::cout << path << ": ERROR " << e.what() << std::endl;
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(interval));
+    }
+}
+
+int main(int argc, char* argv[]) {
+    IncrementalCompiler::Options options;
+    std::string socket_path;
+    bool watching = false;
+    int interval = 200;
+    std::vector<std::string> paths;
+
+    try {
+        for (int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+            size_t equals = arg.find('=');
+            std::string flag = arg.substr(0, equals);
+            std::string value = equals == std::string::npos ? "" : arg.substr(equals + 1);
+            if (flag == "--socket") socket_path = value;
+            else if (flag == "--watch") watching = true;
+            else if (flag == "--interval") interval = std::stoi(value);
+            else if (flag == "--optimize") options.optimize = true;
+            else if (arg.rfind("--", 0) == 0) throw std::runtime_error("Opción desconocida: " + arg);
+            else paths.push_back(arg);
+        }
+        if (watching == paths.empty()) throw std::runtime_error("--watch necesita archivos y los demás modos no los usan");
+        if (watching && !socket_path.empty()) throw std::runtime_error("--watch y --socket no se pueden usar juntos");
+    }
+    catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    IncrementalCompiler compiler(options);
+    if (watching) return watch(compiler, paths, interval);
+    if (!socket_path.empty()) return serve_socket(compiler, socket_path);
+    Connection connection(STDIN_FILENO, STDOUT_FILENO);
+    serve(compiler, connection);
+    return 0;
+}
@@ -0,0 +1,312 @@
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstdint>
+
+#include "compiler_pipeline.cpp"
+#include "symbols_table.cpp"
+#include "program_generator.cpp"
+#include "tracking_allocator.cpp"
+
+/*
+    Medición de rendimiento de cada fase del compilador con programas de ProgramGenerator.
+
+    Para cada tamaño de entrada (desde --min-size, multiplicando por 4 hasta --max-size)
+    se genera un programa y se mide por separado:
+
+        lexer         Lexer::tokenizer()
+        parser        Parser::parse() sobre los tokens ya generados
+        símbolos      SymbolTable: un ámbito por función y por bloque, add_symbol por cada
+                      parámetro y declaración, lookup por cada nombre usado
+        intermedio    convert_program() e IntermediateCodeGenerator::generate() sobre el AST
+        completo      compile_source() y optimize_code() desde el texto
+
+    Cada fila informa el tiempo por ejecución, el rendimiento en MB/s, tokens/s y nodos
+    del AST por segundo (siempre respecto a la entrada, para comparar las fases) y las
+    asignaciones de memoria por ejecución, contadas por tracking_allocator.cpp.
+
+    Una fase deja de medirse en los tamaños siguientes cuando una ejecución supera
+    --budget segundos; las fases que parten de los tokens también se detienen cuando lo
+    hace el lexer. Los tamaños aceptan los sufijos K, M y G (1K = 1024 bytes).
+
+    Uso: compiler_benchmark [--min-size=1K] [--max-size=1G] [--budget=2] [--seed=1]
+             [--statements=12] [--depth=3] [--nesting=2] [--identifiers=6]
+             [--comments=0.1] [--whitespace=0.1] [--print=tamaño]
+
+    Con --print se imprime el programa generado de ese tamaño y no se mide nada.
+*/
+
+// Resultado de una fase para un tamaño de entrada
+struct Measurement {
+    double seconds = 0;        // Por ejecución
+    uint64_t allocations = 0;  // Por ejecución
+    uint64_t bytes = 0;
+};
+
+// Entrada de una medición: tamaño del fuente, tokens y nodos del AST
+struct Input {
+    size_t bytes = 0;
+    size_t tokens = 0;
+    size_t nodes = 0;
+};
+
+static double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Función para ejecutar una fase varias veces (al menos 0.2 s en total) y promediar
+template <typename Phase>
+static Measurement measure(Phase phase) {
+    Measurement result;
+    int repetitions = 0;
+    auto start = std::chrono::steady_clock::now();
+    uint64_t first_count = AllocationTracker::allocations;
+    uint64_t first_bytes = AllocationTracker::bytes;
+    double elapsed = 0;
+    do {
+        phase();
+        repetitions++;
+        elapsed = seconds_since(start);
+    } while (elapsed < 0.2 && repetitions < 1000);
+    result.seconds = elapsed / repetitions;
+    result.allocations = (AllocationTracker::allocations - first_count) / repetitions;
+    result.bytes = (AllocationTracker::bytes - first_bytes) / repetitions;
+    return result;
+}
+
+// Recorrido del AST con la tabla de símbolos, como lo haría un análisis semántico
+class SymbolWalker {
+public:
+    void walk(const ProgramNode* program) {
+        table.enter_scope(); // Ámbito global con las funciones
+        for (const FunctionNode* function : program->functions) {
+            std::vector<std::string> parameters;
+            for (const auto& parameter : function->parameters) parameters.push_back(parameter.var_type);
+            table.register_function(function->name, "INT_TYPE", parameters);
+        }
+        for (const FunctionNode* function : program->functions) {
+            scope([&] {
+                for (const auto& parameter : function->parameters) add(parameter.var_name, parameter.var_type);
+                body(function->body);
+            });
+        }
+    }
+
+private:
+    SymbolTable table;
+
+    template <typename Body>
+    void scope(Body inside) {
+        table.enter_scope();
+        inside();
+        table.exit_scope();
+    }
+
+    void add(const std::string& name, const std::string& type) {
+        table.add_symbol(name, type);
+    }
+
+    void use(const std::string& name) {
+        table.lookup(name);
+    }
+
+    void body(const std::vector<StatementNode*>& statements) {
+        for (const StatementNode* stmt : statements) statement(stmt);
+    }
+
+    void statement(const StatementNode* node) {
+        if (!node) return;
+        if (auto n = dynamic_cast<const DeclarationNode*>(node)) {
+            expression(n->init);
+            add(n->var_name, n->var_type);
+        }
+        else if (auto n = dynamic_cast<const AssignmentNode*>(node)) {
+            use(n->target);
+            expression(n->expr);
+        }
+        else if (auto n = dynamic_cast<const IfNode*>(node)) {
+            expression(n->condition);
+            scope([&] { body(n->if_body); });
+            if (!n->else_body.empty()) scope([&] { body(n->else_body); });
+        }
+        else if (auto n = dynamic_cast<const WhileNode*>(node)) {
+            expression(n->condition);
+            scope([&] { body(n->body); });
+        }
+        else if (auto n = dynamic_cast<const DoWhileNode*>(node)) {
+            scope([&] { body(n->body); });
+            expression(n->condition);
+        }
+        else if (auto n = dynamic_cast<const ForNode*>(node)) {
+            scope([&] {
+                statement(n->init);
+                expression(n->condition);
+                statement(n->step);
+                body(n->body);
+            });
+        }
+        else if (auto n = dynamic_cast<const ReturnNode*>(node)) {
+            expression(n->expr);
+        }
+        else if (auto n = dynamic_cast<const CallNode*>(node)) {
+            expression(n->call);
+        }
+    }
+
+    void expression(const ExpressionNode* node) {
+        if (!node) return;
+        if (node->type == "id" || node->type == "call") use(node->value.id_name);
+        expression(node->left);
+        expression(node->right);
+        expression(node->operand);
+        for (const ExpressionNode* arg : node->args) expression(arg);
+    }
+};
+
+// Tamaño con sufijo K, M o G
+static size_t parse_size(const std::string& text) {
+    size_t end = 0;
+    double value = std::stod(text, &end);
+    std::string suffix = text.substr(end);
+    double unit = 1;
+    if (suffix == "K" || suffix == "k") unit = 1024.0;
+    else if (suffix == "M" || suffix == "m") unit = 1024.0 * 1024;
+    else if (suffix == "G" || suffix == "g") unit = 1024.0 * 1024 * 1024;
+    else if (!suffix.empty()) throw std::runtime_error("Tamaño no válido: " + text);
+    return static_cast<size_t>(value * unit);
+}
+
+static std::string format_size(size_t bytes) {
+    static const char* units[] = {"B", "K", "M", "G"};
+    int unit = 0;
+    double value = static_cast<double>(bytes);
+    while (value >= 1024 && unit < 3) {
+        value /= 1024;
+        unit++;
+    }
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(value < 10 && unit > 0 ? 1 : 0) << value << units[unit];
+    return out.str();
+}
+
+static void print_header(const std::string& phase) {
+    std::cout << "\n" << phase << "\n";
+    std::cout << std::left << std::setw(10) << "Tamaño" << std::right << std::setw(12) << "Tiempo (ms)"
+              << std::setw(10) << "MB/s" << std::setw(14) << "Tokens/s" << std::setw(14) << "Nodos/s"
+              << std::setw(14) << "Asignaciones" << std::setw(14) << "MB asignados" << std::endl;
+}
+
+static void print_row(const Input& input, const Measurement& m) {
+    double seconds = std::max(m.seconds, 1e-9);
+    std::cout << std::left << std::setw(10) << format_size(input.bytes) << std::right << std::fixed
+              << std::setprecision(3) << std::setw(12) << m.seconds * 1e3 << std::setprecision(2) << std::setw(10)
+              << input.bytes / seconds / 1e6 << std::setprecision(0) << std::setw(14) << input.tokens / seconds
+              << std::setw(14) << input.nodes / seconds << std::setw(14) << m.allocations << std::setprecision(2)
+              << std::setw(14) << m.bytes / 1e6 << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    ProgramGenerator::Options options;
+    size_t min_size = 1024;
+    size_t max_size = static_cast<size_t>(1) << 30;
+    double budget = 2.0;
+    size_t print_size = 0;
+
+    try {
+        for (int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+            size_t equals = arg.find('=');
+            std::string flag = arg.substr(0, equals);
+            std::string value = equals == std::string::npos ? "" : arg.substr(equals + 1);
+            if (value.empty()) throw std::runtime_error("Falta el valor de " + flag);
+            if (flag == "--min-size") min_size = parse_size(value);
+            else if (flag == "--max-size") max_size = parse_size(value);
+            else if (flag == "--budget") budget = std::stod(value);
+            else if (flag == "--print") print_size = parse_size(value);
+            else if (flag == "--seed") options.seed = std::stoull(value);
+            else if (flag == "--statements") options.statements = std::stoi(value);
+            else if (flag == "--depth") options.expression_depth = std::stoi(value);
+            else if (flag == "--nesting") options.loop_nesting = std::stoi(value);
+            else if (flag == "--identifiers") options.identifier_length = std::stoi(value);
+            else if (flag == "--comments") options.comment_density = std::stod(value);
+            else if (flag == "--whitespace") options.whitespace_density = std::stod(value);
+            else throw std::runtime_error("Opción desconocida: " + flag);
+        }
+    }
+    catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    ProgramGenerator generator(options);
+    if (print_size) {
+        std::cout << generator.generate_bytes(print_size);
+        return 0;
+    }
+
+    const std::vector<std::string> phases = {"Lexer", "Parser", "Tabla de símbolos", "Código intermedio", "Compilación completa"};
+    std::vector<std::vector<std::pair<Input, Measurement>>> results(phases.size());
+    std::vector<bool> active(phases.size(), true);
+
+    std::cout << "Semilla " << options.seed << ", " << options.statements << " declaraciones por función, profundidad "
+              << options.expression_depth << ", anidamiento " << options.loop_nesting << ", identificadores de "
+              << options.identifier_length << ", comentarios " << options.comment_density << ", espacios "
+              << options.whitespace_density << ", límite " << budget << " s por ejecución" << std::endl;
+
+    for (size_t size = min_size; size <= max_size; size *= 4) {
+        if (std::find(active.begin(), active.end(), true) == active.end()) break;
+        std::string source = generator.generate_bytes(size);
+        std::cerr << "Tamaño " << format_size(source.size()) << ": " << generator.last_stats().functions
+                  << " funciones" << std::endl;
+
+        Input input;
+        input.bytes = source.size();
+        auto record = [&](size_t phase, auto run) {
+            if (!active[phase]) return;
+            Measurement m = measure(run);
+            results[phase].push_back({input, m});
+            if (m.seconds > budget) active[phase] = false;
+        };
+
+        // Las fases que parten de los tokens o del AST solo se miden mientras se mida el lexer
+        if (active[0]) {
+            std::vector<Token> tokens = Lexer(source).tokenizer();
+            ProgramNode* ast = Parser(tokens).parse();
+            input.tokens = tokens.size();
+            input.nodes = count_nodes(ast);
+
+            record(0, [&] {
+                Lexer lexer(source);
+                lexer.tokenizer();
+            });
+            record(1, [&] {
+                Parser parser(tokens);
+                delete parser.parse();
+            });
+            record(2, [&] {
+                SymbolWalker walker;
+                walker.walk(ast);
+            });
+            record(3, [&] {
+                IntermediateCodeGenerator code_generator;
+                code_generator.generate(convert_program(ast));
+            });
+            delete ast;
+            if (!active[0]) active[1] = active[2] = active[3] = false;
+        }
+        record(4, [&] {
+            optimize_code(compile_source(source));
+        });
+    }
+
+    for (size_t phase = 0; phase < phases.size(); phase++) {
+        print_header(phases[phase]);
+        for (const auto& [input, m] : results[phase]) print_row(input, m);
+    }
+    return 0;
+}
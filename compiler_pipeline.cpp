@@ -0,0 +1,117 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <set>
+
+#include "lexer.cpp"
+#include "parser.cpp"
+#include "intermediate_code.cpp"
+#include "ast_conversion.cpp"
+#include "function_merging.cpp"
+#include "inliner.cpp"
+#include "loop_optimization.cpp"
+#include "constant_folding.cpp"
+#include "peephole.cpp"
+#include "phase_report.cpp"
+
+/*
+    Fases del compilador encadenadas: del código fuente al código intermedio y del código
+    intermedio a su versión optimizada. Las usan el ejemplo, los backends y las herramientas
+    de prueba para no repetir el orden de las fases.
+
+    Cada fase está marcada con PhaseReport::Scope: con un informe activo se mide su tiempo
+    y su memoria y se cuentan tokens, nodos, instrucciones, temporales y etiquetas.
+*/
+
+// Función para agregar al informe el tamaño del código intermedio que dejó una fase
+inline void count_code(PhaseReport::Scope& phase, const std::vector<std::string>& code) {
+    if (!phase.enabled()) return;
+    std::set<std::string> temps;
+    uint64_t labels = 0;
+    for (const auto& inst : parse_instructions(code)) {
+        if (inst.kind == InstructionKind::Label) labels++;
+        if (is_temp(inst.result)) temps.insert(inst.result);
+    }
+    phase.count("instrucciones", code.size());
+    phase.count("temporales", temps.size());
+    phase.count("etiquetas", labels);
+}
+
+// Función para obtener el código intermedio de un programa fuente y la posición en el
+// fuente de cada instrucción
+inline std::vector<std::string> compile_source(const std::string& program, std::vector<SourcePosition>& positions) {
+    std::vector<Token> tokens;
+    {
+        PhaseReport::Scope phase("lexer");
+        Lexer lexer(program);
+        tokens = lexer.tokenizer();
+        phase.count("tokens", tokens.size());
+    }
+
+    ProgramNode* ast;
+    {
+        PhaseReport::Scope phase("parser");
+        Parser parser(std::move(tokens));
+        ast = parser.parse();
+        if (phase.enabled()) phase.count("nodos", count_nodes(ast));
+    }
+
+    std::vector<Function> functions;
+    {
+        PhaseReport::Scope phase("conversión del AST");
+        functions = convert_program(ast);
+        delete ast;
+        phase.count("funciones", functions.size());
+    }
+
+    PhaseReport::Scope phase("código intermedio");
+    IntermediateCodeGenerator generator;
+    std::vector<std::string> code = generator.generate(functions);
+    positions = generator.source_positions();
+    count_code(phase, code);
+    return code;
+}
+
+// Función para obtener el código intermedio de un programa fuente
+inline std::vector<std::string> compile_source(const std::string& program) {
+    std::vector<SourcePosition> positions;
+    return compile_source(program, positions);
+}
+
+// Función para aplicar las optimizaciones sobre el código intermedio
+inline std::vector<std::string> optimize_code(const std::vector<std::string>& code) {
+    PhaseReport::Scope optimization("optimización");
+    std::vector<std::string> optimized_code;
+
+    // Unión de funciones con el mismo cuerpo
+    {
+        PhaseReport::Scope phase("unión de funciones");
+        FunctionMerger merger;
+        optimized_code = merger.merge(code);
+        count_code(phase, optimized_code);
+    }
+
+    // Expansión en línea de llamadas pequeñas
+    {
+        PhaseReport::Scope phase("expansión en línea");
+        FunctionInliner inliner;
+        optimized_code = inliner.inline_calls(optimized_code);
+        count_code(phase, optimized_code);
+    }
+
+    // Optimización de bucles (invariantes, reducción de fuerza y desenrollado)
+    {
+        PhaseReport::Scope phase("bucles");
+        LoopOptimizer loop_optimizer;
+        optimized_code = loop_optimizer.optimize(optimized_code);
+        count_code(phase, optimized_code);
+    }
+
+    // Simplificación de saltos y etiquetas redundantes y plegado de constantes sobre los
+    // bucles desenrollados, hasta que el código no cambia
+    PhaseReport::Scope phase("mirilla y plegado");
+    optimized_code = fold_and_simplify(optimized_code);
+    count_code(phase, optimized_code);
+    return optimized_code;
+}
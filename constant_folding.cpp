@@ -0,0 +1,156 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+
+#include "ir_instruction.cpp"
+#include "peephole.cpp"
+
+/*
+    Plegado y propagación de constantes dentro de cada bloque básico.
+
+    Se recorren las instrucciones recordando qué nombres tienen un valor constante conocido;
+    al llegar a una etiqueta (posible destino de un salto) se olvida todo. Las operaciones
+    cuyos operandos son constantes se reemplazan por su resultado, y al final se eliminan
+    las definiciones de temporales y variables que ya no se leen en ninguna parte de la
+    función (las variables son locales: no hay otra función que pueda leerlas).
+
+    Como el plegado no cruza etiquetas, fold_and_simplify() lo alterna con
+    PeepholeOptimizer, que une los bloques y quita los saltos que quedaron con condición
+    constante, hasta que el código ya no cambia.
+*/
+
+class ConstantFolder {
+public:
+    // Estadísticas de la última llamada a fold()
+    struct Stats {
+        int folded = 0;       // Operaciones reemplazadas por una constante
+        int propagated = 0;   // Operandos reemplazados por una constante
+        int removed = 0;      // Definiciones sin uso eliminadas
+    };
+
+    ConstantFolder() {}
+
+    std::vector<std::string> fold(const std::vector<std::string>& code) {
+        stats = Stats();
+        std::vector<Instruction> instructions = parse_instructions(code);
+
+        std::vector<Instruction> result;
+        result.reserve(instructions.size());
+        size_t copied = 0;
+        for (const auto& range : function_ranges(instructions)) {
+            result.insert(result.end(), instructions.begin() + copied, instructions.begin() + range.first);
+            std::vector<Instruction> function(instructions.begin() + range.first, instructions.begin() + range.second);
+            fold_function(function);
+            remove_dead_definitions(function);
+            result.insert(result.end(), function.begin(), function.end());
+            copied = range.second;
+        }
+        result.insert(result.end(), instructions.begin() + copied, instructions.end());
+        return format_instructions(result);
+    }
+
+    const Stats& last_stats() const {
+        return stats;
+    }
+
+private:
+    Stats stats;
+
+    void fold_function(std::vector<Instruction>& function) {
+        std::unordered_map<std::string, long long> constants;
+
+        auto substitute = [&](std::string& operand) {
+            if (!is_variable(operand)) return;
+            auto it = constants.find(operand);
+            if (it != constants.end()) {
+                operand = std::to_string(it->second);
+                stats.propagated++;
+            }
+        };
+
+        for (auto& inst : function) {
+            if (inst.kind == InstructionKind::Label || inst.kind == InstructionKind::Proc || inst.kind == InstructionKind::Raw) {
+                constants.clear();
+                continue;
+            }
+
+            substitute(inst.arg1);
+            substitute(inst.arg2);
+
+            long long value;
+            if (inst.kind == InstructionKind::Binary && is_constant(inst.arg1) && is_constant(inst.arg2) &&
+                evaluate_binary(inst.op, std::stoll(inst.arg1), std::stoll(inst.arg2), value)) {
+                make_copy(inst, value);
+            }
+            else if (inst.kind == InstructionKind::Unary && is_constant(inst.arg1) &&
+                     evaluate_unary(inst.op, std::stoll(inst.arg1), value)) {
+                make_copy(inst, value);
+            }
+
+            std::string def = inst.defined();
+            if (def.empty()) continue;
+            if (inst.kind == InstructionKind::Copy && is_constant(inst.arg1)) {
+                constants[def] = std::stoll(inst.arg1);
+            }
+            else {
+                constants.erase(def);
+            }
+        }
+    }
+
+    void make_copy(Instruction& inst, long long value) {
+        inst.kind = InstructionKind::Copy;
+        inst.arg1 = std::to_string(value);
+        inst.op.clear();
+        inst.arg2.clear();
+        stats.folded++;
+    }
+
+    // Función para eliminar las definiciones de nombres que nadie lee.
+    // Las divisiones que podrían fallar se conservan. Si la función tiene líneas que no se
+    // reconocen (que podrían leer cualquier variable) solo se eliminan temporales.
+    void remove_dead_definitions(std::vector<Instruction>& function) {
+        bool raw = std::any_of(function.begin(), function.end(),
+                               [](const Instruction& inst) { return inst.kind == InstructionKind::Raw; });
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            std::unordered_map<std::string, int> uses;
+            for (const auto& inst : function) {
+                for (const auto& name : inst.uses()) uses[name]++;
+            }
+
+            std::vector<Instruction> result;
+            result.reserve(function.size());
+            for (const auto& inst : function) {
+                bool pure = inst.kind == InstructionKind::Copy || inst.kind == InstructionKind::Unary ||
+                            (inst.kind == InstructionKind::Binary &&
+                             (canonical_operator(inst.op) != "/" || (is_constant(inst.arg2) && std::stoll(inst.arg2) != 0)));
+                if (pure && (is_temp(inst.result) || !raw) && !uses.count(inst.result)) {
+                    stats.removed++;
+                    changed = true;
+                    continue;
+                }
+                result.push_back(inst);
+            }
+            function.swap(result);
+        }
+    }
+};
+
+// Función para alternar el plegado de constantes y la mirilla hasta que el código no cambia
+// (con un máximo de iteraciones por si dos pasadas se deshacen entre sí)
+inline std::vector<std::string> fold_and_simplify(const std::vector<std::string>& code, int max_iterations = 8) {
+    ConstantFolder folder;
+    PeepholeOptimizer peephole;
+    std::vector<std::string> result = code;
+    for (int i = 0; i < max_iterations; i++) {
+        std::vector<std::string> next = peephole.optimize(folder.fold(result));
+        if (next == result) break;
+        result.swap(next);
+    }
+    return result;
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <stdexcept>
+
+#include "ir_instruction.cpp"
+
+/*
+    Grafo de flujo de control de una función del código intermedio.
+    Un bloque básico empieza en una etiqueta, en la primera instrucción de la función o
+    después de un salto/RETURN, y termina antes del siguiente inicio de bloque.
+*/
+
+struct BasicBlock {
+    size_t begin;                       // Primera instrucción del bloque (índice en el código)
+    size_t end;                         // Una posición después de la última instrucción
+    std::vector<size_t> successors;     // Bloques a los que puede pasar el control
+    std::vector<size_t> predecessors;   // Bloques desde los que se llega a este
+
+    const Instruction& last(const std::vector<Instruction>& code) const {
+        return code[end - 1];
+    }
+};
+
+class ControlFlowGraph {
+public:
+    std::vector<BasicBlock> blocks;
+    std::unordered_map<std::string, size_t> label_blocks; // Etiqueta -> bloque que la contiene
+
+    // Se construye el grafo para la función ubicada en [begin, end) (PROC ... ENDP)
+    ControlFlowGraph(const std::vector<Instruction>& code, size_t begin, size_t end) {
+        size_t body_begin = begin + 1;
+        size_t body_end = end - 1;
+
+        // Se identifican los líderes de cada bloque
+        std::vector<size_t> leaders;
+        for (size_t i = body_begin; i < body_end; i++) {
+            bool leader = (i == body_begin) ||
+                          code[i].kind == InstructionKind::Label ||
+                          code[i - 1].is_jump() ||
+                          code[i - 1].kind == InstructionKind::Return;
+            if (leader) {
+                leaders.push_back(i);
+            }
+        }
+
+        for (size_t b = 0; b < leaders.size(); b++) {
+            BasicBlock block;
+            block.begin = leaders[b];
+            block.end = (b + 1 < leaders.size()) ? leaders[b + 1] : body_end;
+            blocks.push_back(block);
+
+            // Las etiquetas consecutivas al inicio del bloque pertenecen al mismo bloque
+            for (size_t i = block.begin; i < block.end && code[i].kind == InstructionKind::Label; i++) {
+                label_blocks[code[i].label] = b;
+            }
+        }
+
+        // Se conectan los bloques según el salto final de cada uno
+        for (size_t b = 0; b < blocks.size(); b++) {
+            const Instruction& last = blocks[b].last(code);
+            if (last.is_jump()) {
+                add_edge(b, target_block(last.label));
+            }
+            if (!last.ends_flow() && b + 1 < blocks.size()) {
+                add_edge(b, b + 1);
+            }
+        }
+    }
+
+    // Función para obtener el bloque al que salta una etiqueta
+    size_t target_block(const std::string& label) const {
+        auto it = label_blocks.find(label);
+        if (it == label_blocks.end()) {
+            throw std::runtime_error("Etiqueta '" + label + "' no definida en la función");
+        }
+        return it->second;
+    }
+
+private:
+    void add_edge(size_t from, size_t to) {
+        for (size_t s : blocks[from].successors) {
+            if (s == to) return;
+        }
+        blocks[from].successors.push_back(to);
+        blocks[to].predecessors.push_back(from);
+    }
+};
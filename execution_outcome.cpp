@@ -0,0 +1,54 @@
+#pragma once
+
+#include <string>
+#include <stdexcept>
+#include <cstdint>
+
+/*
+    Resultado de una ejecución, compartido por los motores y por las herramientas que los
+    comparan (use_example --check y aot_harness): el valor devuelto o un error. Dos errores
+    se consideran iguales sin importar el mensaje.
+
+    Cada motor tiene su propio límite de pila (profundidad de llamadas en TextInterpreter y
+    VirtualMachine, bytes de pila en el JIT, la pila del proceso en el código nativo), así
+    que una recursión profunda puede terminar en uno y agotar la pila de otro. Ese caso se
+    informa con StackOverflowError y en el Outcome queda marcado como exhausted: es un
+    límite de recursos y no una diferencia entre motores, y las comparaciones lo separan.
+*/
+
+// Error de recursos: la ejecución agotó la pila del motor
+class StackOverflowError : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+// Resultado de una ejecución: valor devuelto o error (exhausted si se agotó la pila)
+struct Outcome {
+    bool error = false;
+    bool exhausted = false;
+    int64_t value = 0;
+
+    bool operator==(const Outcome& other) const {
+        return error == other.error && (error || value == other.value);
+    }
+
+    std::string to_string() const {
+        return exhausted ? "pila agotada" : error ? "error" : std::to_string(value);
+    }
+};
+
+// Función para ejecutar run() y convertir un std::runtime_error en un Outcome con error
+template <typename Run>
+static Outcome execute(Run run) {
+    Outcome outcome;
+    try {
+        outcome.value = run();
+    }
+    catch (const StackOverflowError&) {
+        outcome.error = outcome.exhausted = true;
+    }
+    catch (const std::runtime_error&) {
+        outcome.error = true;
+    }
+    return outcome;
+}
@@ -0,0 +1,384 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <sstream>
+#include <iomanip>
+#include <map>
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+
+#include "ir_instruction.cpp"
+#include "control_flow.cpp"
+#include "intermediate_code.cpp"
+#include "bytecode_vm.cpp"
+#include "block_layout.cpp"
+
+/*
+    Perfilado de la ejecución del código intermedio.
+
+    ExecutionProfiler compila el código con BytecodeCompiler y ejecuta con
+    VirtualMachine::profile(), que es una instancia aparte del intérprete: las ejecuciones
+    normales con run() no pagan nada por el perfilado. Los contadores del bytecode se
+    traducen al código intermedio:
+
+    - ejecuciones de cada instrucción (una etiqueta cuenta las veces que se llegó a ella,
+      PROC las llamadas a la función y ENDP las veces que se llegó al final sin RETURN),
+    - ejecuciones de cada bloque básico (ControlFlowGraph) y de cada arista entre bloques,
+      también como BlockProfile para BlockLayoutOptimizer,
+    - saltos hacia atrás tomados (iteraciones de los bucles) y total de saltos tomados,
+    - llamadas y tiempo inclusivo/exclusivo de cada función, en ciclos del procesador
+      (rdtsc) o en nanosegundos donde no hay rdtsc; en las funciones recursivas el tiempo
+      inclusivo solo cuenta la llamada más externa,
+    - instrucciones de bytecode ejecutadas por línea del código fuente.
+
+    Las líneas del fuente se conocen si se pasan las posiciones que devuelve
+    IntermediateCodeGenerator::source_positions() (compile_source con posiciones); sirven
+    para el código sin optimizar, porque las optimizaciones no conservan esa relación.
+
+    Exportación: collapsed_stacks() escribe una pila por línea ("main;f;g 1234", tiempo
+    exclusivo) para flamegraph.pl o speedscope, y to_json() todos los contadores.
+*/
+
+class ExecutionProfiler {
+public:
+    struct FunctionTime {
+        std::string name;
+        uint64_t calls = 0;
+        uint64_t inclusive = 0;
+        uint64_t exclusive = 0;
+    };
+
+    struct BlockCount {
+        std::string function;
+        size_t begin = 0; // Instrucciones [begin, end) del código intermedio
+        size_t end = 0;
+        uint64_t count = 0;
+    };
+
+    struct BackEdge {
+        std::string function;
+        size_t from = 0;   // Instrucción del salto
+        size_t to = 0;     // Etiqueta de destino
+        uint64_t count = 0;
+    };
+
+    struct LineCount {
+        int line = 0;
+        uint64_t count = 0; // Instrucciones de bytecode ejecutadas
+    };
+
+    ExecutionProfiler(const std::vector<std::string>& code, const std::vector<SourcePosition>& positions = {})
+        : instructions(parse_instructions(code)), positions(positions) {
+        if (!positions.empty() && positions.size() != code.size()) {
+            throw std::runtime_error("Las posiciones en el fuente no corresponden al código intermedio");
+        }
+        BytecodeCompiler compiler;
+        module = compiler.compile(code);
+        ranges = function_ranges(instructions);
+
+        // Instrucción del código intermedio que generó cada posición del bytecode
+        owners.assign(module.code.size(), 0);
+        last_positions.assign(instructions.size(), 0);
+        function_of.assign(instructions.size(), -1);
+        for (size_t f = 0; f < ranges.size(); f++) {
+            auto [begin, end] = ranges[f];
+            for (size_t i = begin; i < end; i++) function_of[i] = static_cast<int>(f);
+            size_t previous = end;
+            for (size_t i = begin + 1; i < end; i++) {
+                if (instructions[i].kind == InstructionKind::Label) continue;
+                if (previous != end) fill_owner(previous, module.instruction_positions[previous], module.instruction_positions[i]);
+                previous = i;
+            }
+            fill_owner(previous, module.instruction_positions[previous], module.instruction_positions[previous] + 1);
+        }
+    }
+
+    // Función para ejecutar una función del código y acumular sus contadores
+    int64_t run(const std::string& name, const std::vector<int64_t>& args = {}) {
+        return vm.profile(module, name, args, profile);
+    }
+
+    void reset() {
+        profile = BytecodeProfile();
+    }
+
+    const char* time_unit() const {
+        return BytecodeProfile::time_unit();
+    }
+
+    // Ejecuciones de cada instrucción del código intermedio (0 fuera de las funciones)
+    std::vector<uint64_t> instruction_counts() const {
+        std::vector<uint64_t> counts(instructions.size(), 0);
+        if (profile.instructions.empty()) return counts;
+        std::vector<FunctionTime> times = function_times();
+        for (size_t f = 0; f < ranges.size(); f++) {
+            auto [begin, end] = ranges[f];
+            counts[begin] = times[f].calls;
+            for (size_t i = begin + 1; i < end; i++) counts[i] = profile.instructions[module.instruction_positions[i]];
+        }
+        return counts;
+    }
+
+    std::vector<BlockCount> block_counts() const {
+        std::vector<uint64_t> counts = instruction_counts();
+        std::vector<BlockCount> blocks;
+        for (const auto& [begin, end] : ranges) {
+            ControlFlowGraph cfg(instructions, begin, end);
+            for (const auto& block : cfg.blocks) {
+                blocks.push_back({instructions[begin].result, block.begin, block.end, counts[block.begin]});
+            }
+        }
+        return blocks;
+    }
+
+    std::vector<BackEdge> back_edges() const {
+        std::vector<BackEdge> edges;
+        if (profile.taken.empty()) return edges;
+        for (size_t p = 0; p < module.code.size(); p++) {
+            if (profile.taken[p] == 0 || module.code[p].a > static_cast<int32_t>(p)) continue;
+            size_t from = owners[p];
+            auto [begin, end] = ranges[function_of[from]];
+            BackEdge edge;
+            edge.function = instructions[begin].result;
+            edge.from = from;
+            edge.to = from;
+            for (size_t i = begin + 1; i < end; i++) {
+                if (instructions[i].kind == InstructionKind::Label && instructions[i].label == instructions[from].label) {
+                    edge.to = i;
+                }
+            }
+            edge.count = profile.taken[p];
+            edges.push_back(edge);
+        }
+        return edges;
+    }
+
+    // Saltos tomados en total (GOTO incluidos); es lo que reduce BlockLayoutOptimizer
+    uint64_t taken_branches() const {
+        uint64_t total = 0;
+        for (uint64_t count : profile.taken) total += count;
+        return total;
+    }
+
+    // Frecuencias de bloques y aristas de las funciones ejecutadas, para BlockLayoutOptimizer
+    BlockProfile block_profile() const {
+        BlockProfile result;
+        std::vector<uint64_t> counts = instruction_counts();
+        for (const auto& [begin, end] : ranges) {
+            if (counts[begin] == 0) continue;
+            BlockProfile::Function& function = result.functions[instructions[begin].result];
+            ControlFlowGraph cfg(instructions, begin, end);
+            for (size_t b = 0; b < cfg.blocks.size(); b++) {
+                const BasicBlock& block = cfg.blocks[b];
+                function.blocks[block.begin - begin] = counts[block.begin];
+
+                // Las salidas del bloque se reparten entre el salto tomado y la instrucción siguiente
+                size_t last = block.end - 1;
+                uint64_t leaving = counts[last];
+                const Instruction& inst = instructions[last];
+                uint64_t jumped = 0;
+                if (inst.is_jump()) {
+                    jumped = (inst.kind == InstructionKind::Goto) ? leaving : taken_count(last);
+                    size_t target = cfg.blocks[cfg.target_block(inst.label)].begin - begin;
+                    if (jumped > 0) function.edges[{block.begin - begin, target}] += jumped;
+                }
+                if (!inst.ends_flow() && b + 1 < cfg.blocks.size() && leaving > jumped) {
+                    function.edges[{block.begin - begin, cfg.blocks[b + 1].begin - begin}] += leaving - jumped;
+                }
+            }
+        }
+        return result;
+    }
+
+    // Llamadas y tiempos por función, en el orden del código
+    std::vector<FunctionTime> function_times() const {
+        std::vector<FunctionTime> times(module.functions.size());
+        for (size_t f = 0; f < times.size(); f++) times[f].name = module.functions[f].name;
+        for (size_t c = 0; c < profile.contexts.size(); c++) {
+            const BytecodeProfile::Context& context = profile.contexts[c];
+            FunctionTime& time = times[context.function];
+            time.calls += context.calls;
+            time.exclusive += context.exclusive;
+            if (!recursive(c)) time.inclusive += context.inclusive;
+        }
+        return times;
+    }
+
+    // Instrucciones de bytecode ejecutadas por línea del fuente (vacío si no hay posiciones)
+    std::vector<LineCount> line_counts() const {
+        std::map<int, uint64_t> lines;
+        if (positions.empty() || profile.instructions.empty()) return {};
+        for (size_t p = 0; p < module.code.size(); p++) {
+            if (profile.instructions[p] == 0) continue;
+            lines[positions[owners[p]].line] += profile.instructions[p];
+        }
+        std::vector<LineCount> counts;
+        for (const auto& [line, count] : lines) counts.push_back({line, count});
+        return counts;
+    }
+
+    // Una línea por contexto de llamada: "f;g;h tiempo_exclusivo"
+    std::string collapsed_stacks() const {
+        std::ostringstream out;
+        for (size_t c = 0; c < profile.contexts.size(); c++) {
+            if (profile.contexts[c].exclusive == 0) continue;
+            out << stack_name(static_cast<int>(c)) << " " << profile.contexts[c].exclusive << "\n";
+        }
+        return out.str();
+    }
+
+    std::string to_json() const {
+        std::ostringstream out;
+        out << "{\n  \"unit\": \"" << time_unit() << "\",\n";
+
+        out << "  \"functions\": [";
+        std::vector<FunctionTime> times = function_times();
+        for (size_t f = 0; f < times.size(); f++) {
+            out << (f ? "," : "") << "\n    {\"name\": " << quoted(times[f].name) << ", \"calls\": " << times[f].calls
+                << ", \"inclusive\": " << times[f].inclusive << ", \"exclusive\": " << times[f].exclusive << "}";
+        }
+        out << "\n  ],\n";
+
+        out << "  \"instructions\": [";
+        std::vector<uint64_t> counts = instruction_counts();
+        bool first = true;
+        for (size_t i = 0; i < instructions.size(); i++) {
+            if (function_of[i] < 0) continue;
+            out << (first ? "" : ",") << "\n    {\"index\": " << i << ", \"function\": "
+                << quoted(module.functions[function_of[i]].name) << ", \"text\": " << quoted(instructions[i].to_string())
+                << ", \"count\": " << counts[i] << source(i) << "}";
+            first = false;
+        }
+        out << "\n  ],\n";
+
+        out << "  \"blocks\": [";
+        std::vector<BlockCount> blocks = block_counts();
+        for (size_t b = 0; b < blocks.size(); b++) {
+            out << (b ? "," : "") << "\n    {\"function\": " << quoted(blocks[b].function) << ", \"begin\": "
+                << blocks[b].begin << ", \"end\": " << blocks[b].end << ", \"count\": " << blocks[b].count
+                << source(blocks[b].begin) << "}";
+        }
+        out << "\n  ],\n";
+
+        out << "  \"back_edges\": [";
+        std::vector<BackEdge> edges = back_edges();
+        for (size_t e = 0; e < edges.size(); e++) {
+            out << (e ? "," : "") << "\n    {\"function\": " << quoted(edges[e].function) << ", \"from\": "
+                << edges[e].from << ", \"to\": " << edges[e].to << ", \"count\": " << edges[e].count
+                << source(edges[e].from) << "}";
+        }
+        out << "\n  ],\n";
+
+        out << "  \"lines\": [";
+        std::vector<LineCount> lines = line_counts();
+        for (size_t l = 0; l < lines.size(); l++) {
+            out << (l ? "," : "") << "\n    {\"line\": " << lines[l].line << ", \"count\": " << lines[l].count << "}";
+        }
+        out << "\n  ],\n";
+
+        out << "  \"stacks\": [";
+        first = true;
+        for (size_t c = 0; c < profile.contexts.size(); c++) {
+            const BytecodeProfile::Context& context = profile.contexts[c];
+            out << (first ? "" : ",") << "\n    {\"stack\": " << quoted(stack_name(static_cast<int>(c)))
+                << ", \"calls\": " << context.calls << ", \"inclusive\": " << context.inclusive
+                << ", \"exclusive\": " << context.exclusive << "}";
+            first = false;
+        }
+        out << "\n  ]\n}\n";
+        return out.str();
+    }
+
+    // Resumen legible: funciones, bucles y las instrucciones más ejecutadas
+    std::string report(size_t top = 10) const {
+        std::ostringstream out;
+        out << std::left << std::setw(24) << "Función" << std::right << std::setw(10) << "Llamadas"
+            << std::setw(16) << ("Incl. (" + std::string(time_unit()) + ")") << std::setw(16)
+            << ("Excl. (" + std::string(time_unit()) + ")") << "\n";
+        for (const auto& time : function_times()) {
+            if (time.calls == 0) continue;
+            out << std::left << std::setw(24) << time.name << std::right << std::setw(10) << time.calls
+                << std::setw(16) << time.inclusive << std::setw(16) << time.exclusive << "\n";
+        }
+
+        for (const auto& edge : back_edges()) {
+            out << "Bucle en " << edge.function << ": " << instructions[edge.from].to_string() << " tomado "
+                << edge.count << " veces" << line_suffix(edge.from) << "\n";
+        }
+
+        std::vector<uint64_t> counts = instruction_counts();
+        std::vector<size_t> order;
+        for (size_t i = 0; i < instructions.size(); i++) {
+            InstructionKind kind = instructions[i].kind;
+            if (counts[i] > 0 && kind != InstructionKind::Label && kind != InstructionKind::Proc &&
+                kind != InstructionKind::EndProc) {
+                order.push_back(i);
+            }
+        }
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return counts[a] > counts[b]; });
+        if (order.size() > top) order.resize(top);
+        for (size_t i : order) {
+            out << std::setw(10) << counts[i] << "  " << instructions[i].to_string() << line_suffix(i) << "\n";
+        }
+        return out.str();
+    }
+
+private:
+    std::vector<Instruction> instructions;
+    std::vector<SourcePosition> positions;
+    std::vector<std::pair<size_t, size_t>> ranges;
+    BytecodeModule module;
+    VirtualMachine vm;
+    BytecodeProfile profile;
+    std::vector<size_t> owners;    // Posición del bytecode -> instrucción del código intermedio
+    std::vector<size_t> last_positions; // Instrucción -> última posición de su bytecode
+    std::vector<int> function_of;  // Instrucción -> función (-1 fuera de PROC ... ENDP)
+
+    void fill_owner(size_t instruction, size_t begin, size_t end) {
+        for (size_t p = begin; p < end; p++) owners[p] = instruction;
+        last_positions[instruction] = end - 1;
+    }
+
+    // Veces que se tomó el salto de una instrucción (el salto es su último bytecode)
+    uint64_t taken_count(size_t instruction) const {
+        return profile.taken.empty() ? 0 : profile.taken[last_positions[instruction]];
+    }
+
+    // Un contexto es recursivo si alguno de sus antecesores es la misma función
+    bool recursive(size_t c) const {
+        int function = profile.contexts[c].function;
+        for (int p = profile.contexts[c].parent; p >= 0; p = profile.contexts[p].parent) {
+            if (profile.contexts[p].function == function) return true;
+        }
+        return false;
+    }
+
+    std::string stack_name(int c) const {
+        std::string name = module.functions[profile.contexts[c].function].name;
+        for (int p = profile.contexts[c].parent; p >= 0; p = profile.contexts[p].parent) {
+            name = module.functions[profile.contexts[p].function].name + ";" + name;
+        }
+        return name;
+    }
+
+    std::string source(size_t i) const {
+        if (positions.empty() || positions[i].line == 0) return "";
+        return ", \"line\": " + std::to_string(positions[i].line) + ", \"column\": " + std::to_string(positions[i].column);
+    }
+
+    std::string line_suffix(size_t i) const {
+        if (positions.empty() || positions[i].line == 0) return "";
+        return "  (línea " + std::to_string(positions[i].line) + ")";
+    }
+
+    static std::string quoted(const std::string& text) {
+        std::string result = "\"";
+        for (char c : text) {
+            if (c == '"' || c == '\\') result += '\\';
+            result += c;
+        }
+        return result + "\"";
+    }
+};
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+#include "ir_instruction.cpp"
+
+/*
+    Unión de funciones idénticas.
+
+    Los programas generados automáticamente suelen repetir funciones cuyo cuerpo es igual y
+    solo cambia el nombre. Cada función se lleva a una forma canónica donde los temporales,
+    etiquetas y variables se numeran por orden de aparición (así no importa la numeración
+    global del generador ni el nombre de las variables locales) y las llamadas recursivas a
+    sí misma se escriben como "@self". Las funciones con la misma forma canónica se unen:
+    se conserva la primera definición, las demás se reemplazan por "ALIAS copia = original"
+    y las llamadas a las copias se dirigen a la original.
+
+    Como unir funciones puede volver idénticas a las que las llaman, el proceso se repite
+    hasta que ya no hay cambios.
+*/
+
+class FunctionMerger {
+public:
+    // Estadísticas de la última llamada a merge()
+    struct Stats {
+        int functions = 0;
+        int merged = 0;
+        int removed_instructions = 0;
+    };
+
+    FunctionMerger() {}
+
+    std::vector<std::string> merge(const std::vector<std::string>& code) {
+        stats = Stats();
+        std::vector<Instruction> instructions = parse_instructions(code);
+
+        bool changed = true;
+        bool first = true;
+        while (changed) {
+            changed = merge_once(instructions, first);
+            first = false;
+        }
+        return format_instructions(instructions);
+    }
+
+    const Stats& last_stats() const {
+        return stats;
+    }
+
+    // Forma canónica del cuerpo de una función, usada para comparar funciones
+    static std::string canonical_form(const std::vector<Instruction>& code, size_t begin, size_t end) {
+        std::unordered_map<std::string, std::string> names, labels;
+        auto name = [&](const std::string& operand) -> std::string {
+            if (!is_variable(operand)) return operand;
+            auto it = names.find(operand);
+            if (it != names.end()) return it->second;
+            std::string canonical = (is_temp(operand) ? "%t" : "%v") + std::to_string(names.size());
+            return names[operand] = canonical;
+        };
+        auto label = [&](const std::string& original) -> std::string {
+            auto it = labels.find(original);
+            if (it != labels.end()) return it->second;
+            return labels[original] = "%L" + std::to_string(labels.size());
+        };
+
+        const std::string& self = code[begin].result;
+        Instruction header = code[begin];
+        header.result = "@self";
+        for (auto& param : header.parameters) param = name(param);
+
+        std::string form = header.to_string();
+        for (size_t i = begin + 1; i < end; i++) {
+            Instruction inst = code[i];
+            inst.rename_operands(name);
+            if (inst.kind == InstructionKind::Label || inst.is_jump()) inst.label = label(inst.label);
+            if (inst.kind == InstructionKind::Call && inst.callee == self) inst.callee = "@self";
+            form += '\n';
+            form += inst.to_string();
+        }
+        return form;
+    }
+
+    // Hash FNV-1a de 64 bits
+    static uint64_t hash(const std::string& text) {
+        uint64_t h = 14695981039346656037ULL;
+        for (unsigned char c : text) {
+            h ^= c;
+            h *= 1099511628211ULL;
+        }
+        return h;
+    }
+
+private:
+    Stats stats;
+
+    bool merge_once(std::vector<Instruction>& instructions, bool count_functions) {
+        std::vector<std::pair<size_t, size_t>> ranges = function_ranges(instructions);
+        if (count_functions) stats.functions = static_cast<int>(ranges.size());
+
+        // Hash -> funciones ya vistas con ese hash (se compara el texto para evitar colisiones)
+        std::unordered_map<uint64_t, std::vector<std::pair<std::string, size_t>>> seen;
+        std::unordered_map<std::string, std::string> replaced; // copia -> original
+        std::vector<bool> removed(ranges.size(), false);
+
+        for (size_t f = 0; f < ranges.size(); f++) {
+            std::string form = canonical_form(instructions, ranges[f].first, ranges[f].second);
+            auto& bucket = seen[hash(form)];
+            bool duplicate = false;
+            for (const auto& [other_form, other] : bucket) {
+                if (other_form == form) {
+                    replaced[instructions[ranges[f].first].result] = instructions[ranges[other].first].result;
+                    removed[f] = true;
+                    duplicate = true;
+                    break;
+                }
+            }
+            if (!duplicate) bucket.push_back({form, f});
+        }
+
+        if (replaced.empty()) {
+            return false;
+        }
+
+        // Se reconstruye el código con alias en lugar de las funciones repetidas
+        std::vector<Instruction> result;
+        result.reserve(instructions.size());
+        size_t copied = 0;
+        for (size_t f = 0; f < ranges.size(); f++) {
+            result.insert(result.end(), instructions.begin() + copied, instructions.begin() + ranges[f].first);
+            copied = ranges[f].second;
+            if (!removed[f]) {
+                result.insert(result.end(), instructions.begin() + ranges[f].first, instructions.begin() + ranges[f].second);
+                continue;
+            }
+            Instruction alias;
+            alias.kind = InstructionKind::Alias;
+            alias.result = instructions[ranges[f].first].result;
+            alias.callee = replaced[alias.result];
+            result.push_back(alias);
+            stats.merged++;
+            stats.removed_instructions += static_cast<int>(ranges[f].second - ranges[f].first) - 1;
+        }
+        result.insert(result.end(), instructions.begin() + copied, instructions.end());
+
+        // Las llamadas y los alias apuntan directamente a la función conservada
+        for (auto& inst : result) {
+            if (inst.kind != InstructionKind::Call && inst.kind != InstructionKind::Alias) continue;
+            auto it = replaced.find(inst.callee);
+            if (it != replaced.end()) inst.callee = it->second;
+        }
+
+        instructions.swap(result);
+        return true;
+    }
+};
@@ -0,0 +1,356 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <memory>
+#include <chrono>
+#include <stdexcept>
+#include <cstdint>
+#include <cstring>
+#include <cstddef>
+#include <algorithm>
+
+#include "compiler_pipeline.cpp"
+#include "compile_cache.cpp"
+
+/*
+    Compilación incremental de archivos que cambian poco entre una compilación y otra (la
+    usa compile_server).
+
+    Por cada archivo se guarda su fuente dividido en funciones (CompileCache::split_functions)
+    y de cada función el texto, su FunctionNode, la Function convertida y su código
+    intermedio generado con la numeración desde 0. Al actualizar un archivo, las funciones
+    cuyo texto no cambió se reutilizan tal cual, aunque hayan cambiado de lugar; solo las
+    nuevas o modificadas pasan por Lexer, Parser, la conversión y el generador.
+
+    Para que una actualización cueste según lo que cambió y no según el tamaño del archivo,
+    el fuente nuevo se compara con el anterior: si es igual no se hace nada, y si no, las
+    funciones dentro del prefijo y el sufijo comunes se reutilizan sin volver a dividirlas
+    ni leer su texto. Solo el tramo del medio se divide, y sus funciones se buscan entre las
+    anteriores restantes por el hash del texto (el texto se compara solo si el hash coincide).
+
+    El código del archivo completo se arma al pedirlo: cada función se reubica con la suma de
+    los temporales y etiquetas de las anteriores (CompileCache::relocate), así que el
+    resultado es idéntico a compile_source() sobre el archivo entero. Las funciones cuya
+    posición en la numeración no cambió conservan el código reubicado de la vez anterior.
+    Con Options::optimize el código se pasa además por optimize_code(), que trabaja sobre el
+    programa completo y por eso no es incremental (se guarda hasta el siguiente cambio).
+
+    Si el archivo no se puede dividir, una función no compila sola o usa nombres con la forma
+    de una etiqueta, se compila el archivo entero: los errores son los mismos
+    que da compile_source() y el estado anterior del archivo se conserva. No es seguro usar
+    el mismo objeto desde varios hilos.
+*/
+
+class IncrementalCompiler {
+public:
+    struct Options {
+        bool optimize = false;
+    };
+
+    // Estadísticas de la última llamada a update()
+    struct Stats {
+        size_t functions = 0;
+        size_t reused = 0;       // Funciones con el mismo texto que en la versión anterior
+        size_t compiled = 0;     // Funciones analizadas y generadas de nuevo
+        bool incremental = true; // false si hubo que compilar el archivo entero
+        double seconds = 0;
+    };
+
+    IncrementalCompiler() : IncrementalCompiler(Options()) {}
+    explicit IncrementalCompiler(const Options& options) : options(options) {}
+
+    // Reemplaza el fuente de un archivo y recompila lo que cambió
+    const Stats& update(const std::string& name, const std::string& source) {
+        auto start = std::chrono::steady_clock::now();
+        stats = Stats();
+        auto found = files.find(name);
+        FileState* old = (found != files.end()) ? &found->second : nullptr;
+
+        // Mismo fuente: se conserva todo, incluido el código ya armado
+        if (old && old->incremental && old->source == source) {
+            stats.functions = stats.reused = old->functions.size();
+            stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            return stats;
+        }
+
+        std::vector<std::unique_ptr<FunctionState>> empty;
+        std::vector<std::unique_ptr<FunctionState>>& previous = old ? old->functions : empty;
+
+        FileState next;
+        next.source = source;
+        std::vector<size_t> reused;
+        if (!(old && old->incremental && split_changed(*old, source, next.ranges, reused))) {
+            next.incremental = CompileCache::split_functions(source, next.ranges);
+            reused.assign(next.ranges.size(), SIZE_MAX);
+        }
+
+        // Las funciones del tramo que cambió salen de la versión anterior (por hash del texto y
+        // después comparando el texto, aunque se hayan movido) o de compilarlas; el estado
+        // anterior no se toca hasta que todo compiló
+        std::vector<bool> claimed(previous.size(), false);
+        for (size_t index : reused) {
+            if (index != SIZE_MAX) claimed[index] = true;
+        }
+        std::unordered_map<uint64_t, std::vector<size_t>> unchanged;
+        for (size_t f = previous.size(); f-- > 0;) {
+            if (!claimed[f]) unchanged[previous[f]->hash].push_back(f);
+        }
+        std::vector<std::unique_ptr<FunctionState>> compiled(next.ranges.size());
+        for (size_t f = 0; f < next.ranges.size() && next.incremental; f++) {
+            if (reused[f] != SIZE_MAX) {
+                stats.reused++;
+                continue;
+            }
+            const auto& [first, last] = next.ranges[f];
+            uint64_t hash = CompileCache::hash(source.data() + first, last - first);
+            auto same = unchanged.find(hash);
+            if (same != unchanged.end()) {
+                auto& candidates = same->second;
+                for (size_t c = candidates.size(); c-- > 0;) {
+                    if (source.compare(first, last - first, previous[candidates[c]]->text) == 0) {
+                        reused[f] = candidates[c];
+                        candidates.erase(candidates.begin() + c);
+                        break;
+                    }
+                }
+            }
+            if (reused[f] != SIZE_MAX) {
+                stats.reused++;
+            }
+            else if ((compiled[f] = compile_function(source.substr(first, last - first)))) {
+                compiled[f]->hash = hash;
+                stats.compiled++;
+            }
+            else {
+                next.incremental = false;
+            }
+        }
+
+        if (next.incremental) {
+            for (size_t f = 0; f < next.ranges.size(); f++) {
+                next.functions.push_back(reused[f] != SIZE_MAX ? std::move(previous[reused[f]]) : std::move(compiled[f]));
+            }
+            // Las líneas del código anterior se sobrescriben al armarlo de nuevo en code(), en vez
+            // de liberarlas aquí (en un archivo grande liberarlas cuesta más que la actualización)
+            if (old) next.code = std::move(old->code);
+        }
+        else {
+            stats = Stats();
+            stats.incremental = false;
+            next.code = compile_source(source);
+            next.assembled = true;
+        }
+
+        stats.functions = next.incremental ? next.functions.size() : next.ranges.size();
+        files[name] = std::move(next);
+        stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return stats;
+    }
+
+    // Código intermedio del archivo completo (optimizado si Options::optimize)
+    const std::vector<std::string>& code(const std::string& name) {
+        FileState& file = find(name);
+        if (file.incremental && !file.assembled) {
+            size_t lines = 0;
+            int temps = 0, labels = 0;
+            for (auto& function : file.functions) {
+                relocate(*function, temps, labels);
+                for (const auto& line : function->relocated) {
+                    if (lines < file.code.size()) file.code[lines] = line;
+                    else file.code.push_back(line);
+                    lines++;
+                }
+                temps += function->temps;
+                labels += function->labels;
+            }
+            file.code.resize(lines);
+            file.assembled = true;
+        }
+        if (!options.optimize) return file.code;
+        if (!file.optimized_ready) {
+            file.optimized = optimize_code(file.code);
+            file.optimized_ready = true;
+        }
+        return file.optimized;
+    }
+
+    // Código sin optimizar de una función del archivo, con la numeración que tiene en él
+    std::vector<std::string> function_code(const std::string& name, const std::string& function) {
+        FileState& file = find(name);
+        if (!file.incremental) {
+            for (const auto& [first, last] : function_ranges(parse_instructions(file.code))) {
+                if (parse_instruction(file.code[first]).result == function) {
+                    return std::vector<std::string>(file.code.begin() + first, file.code.begin() + last);
+                }
+            }
+        }
+        else {
+            int temps = 0, labels = 0;
+            for (auto& state : file.functions) {
+                if (state->ast->name == function) {
+                    relocate(*state, temps, labels);
+                    return state->relocated;
+                }
+                temps += state->temps;
+                labels += state->labels;
+            }
+        }
+        throw std::runtime_error("La función " + function + " no está en " + name);
+    }
+
+    // Nombres de las funciones del archivo en el orden del fuente (vacío si no es incremental)
+    std::vector<std::string> function_names(const std::string& name) {
+        std::vector<std::string> names;
+        for (const auto& function : find(name).functions) names.push_back(function->ast->name);
+        return names;
+    }
+
+    bool contains(const std::string& name) const {
+        return files.count(name) > 0;
+    }
+
+    void forget(const std::string& name) {
+        files.erase(name);
+    }
+
+    size_t file_count() const {
+        return files.size();
+    }
+
+    // Funciones guardadas entre todos los archivos
+    size_t function_count() const {
+        size_t total = 0;
+        for (const auto& [name, file] : files) total += file.functions.size();
+        return total;
+    }
+
+    const Stats& last_stats() const {
+        return stats;
+    }
+
+private:
+    struct FunctionState {
+        std::string text;
+        uint64_t hash = 0;                  // CompileCache::hash(text)
+        std::unique_ptr<FunctionNode> ast;
+        Function function;
+        std::vector<std::string> code;      // Numeración desde 0
+        int temps = 0;
+        int labels = 0;
+        std::vector<std::string> relocated; // Código con los desplazamientos temp_offset y label_offset
+        int temp_offset = -1;
+        int label_offset = -1;
+    };
+
+    struct FileState {
+        std::string source;
+        bool incremental = true;
+        std::vector<std::pair<size_t, size_t>> ranges; // Rango de cada función en source
+        std::vector<std::unique_ptr<FunctionState>> functions;
+        std::vector<std::string> code;      // Código completo (armado en code() si es incremental)
+        bool assembled = false;
+        std::vector<std::string> optimized;
+        bool optimized_ready = false;
+    };
+
+    Options options;
+    Stats stats;
+    std::map<std::string, FileState> files;
+
+    FileState& find(const std::string& name) {
+        auto found = files.find(name);
+        if (found == files.end()) {
+            throw std::runtime_error("El archivo " + name + " no fue compilado");
+        }
+        return found->second;
+    }
+
+    // Longitud del tramo común al principio (o al final, con from_end) de a y b
+    static size_t common_length(const std::string& a, const std::string& b, size_t limit, bool from_end) {
+        const size_t block = 4096;
+        const char* x = from_end ? a.data() + a.size() : a.data();
+        const char* y = from_end ? b.data() + b.size() : b.data();
+        size_t n = 0;
+        while (n + block <= limit && (from_end ? std::memcmp(x - n - block, y - n - block, block)
+                                               : std::memcmp(x + n, y + n, block)) == 0) {
+            n += block;
+        }
+        while (n < limit && (from_end ? x[-1 - static_cast<ptrdiff_t>(n)] == y[-1 - static_cast<ptrdiff_t>(n)] : x[n] == y[n])) n++;
+        return n;
+    }
+
+    // Divide solo el tramo del fuente que cambió respecto de old. Las funciones anteriores que
+    // terminan dentro del prefijo común o empiezan dentro del sufijo común tienen el mismo texto
+    // y, como la división avanza de izquierda a derecha, el mismo rango (desplazado en el
+    // sufijo): se reutilizan sin mirar su texto (reused[f] es su índice, SIZE_MAX en las del
+    // medio). false si el tramo del medio no se divide solo; entonces se divide el archivo entero
+    static bool split_changed(const FileState& old, const std::string& source,
+                              std::vector<std::pair<size_t, size_t>>& ranges, std::vector<size_t>& reused) {
+        const std::string& before = old.source;
+        size_t limit = std::min(before.size(), source.size());
+        size_t prefix = common_length(before, source, limit, false);
+        size_t suffix = common_length(before, source, limit - prefix, true);
+
+        size_t count = old.ranges.size();
+        size_t head = 0;
+        while (head < count && old.ranges[head].second <= prefix) head++;
+        size_t tail = count;
+        while (tail > head && old.ranges[tail - 1].first >= before.size() - suffix) tail--;
+
+        // Las posiciones del sufijo se trasladan a source (size_t: la resta puede dar la vuelta)
+        auto moved = [&](size_t position) { return position - before.size() + source.size(); };
+        size_t middle_begin = head ? old.ranges[head - 1].second : 0;
+        size_t middle_end = (tail < count) ? moved(old.ranges[tail].first) : source.size();
+
+        ranges.assign(old.ranges.begin(), old.ranges.begin() + head);
+        reused.clear();
+        for (size_t f = 0; f < head; f++) reused.push_back(f);
+        if (!CompileCache::split_functions(source, middle_begin, middle_end, ranges)) return false;
+        reused.resize(ranges.size(), SIZE_MAX);
+        for (size_t f = tail; f < count; f++) {
+            ranges.push_back({moved(old.ranges[f].first), moved(old.ranges[f].second)});
+            reused.push_back(f);
+        }
+        return true;
+    }
+
+    static void relocate(FunctionState& function, int temps, int labels) {
+        if (function.temp_offset == temps && function.label_offset == labels) return;
+        function.relocated.clear();
+        function.relocated.reserve(function.code.size());
+        for (const auto& line : function.code) function.relocated.push_back(CompileCache::relocate(line, temps, labels));
+        function.temp_offset = temps;
+        function.label_offset = labels;
+    }
+
+    // Compila una función sola; nullptr si no es exactamente una función válida y reubicable
+    static std::unique_ptr<FunctionState> compile_function(const std::string& text) {
+        try {
+            Lexer lexer(text);
+            std::vector<Token> tokens = lexer.tokenizer();
+            if (!CompileCache::relocatable(tokens)) return nullptr;
+            Parser parser(std::move(tokens));
+            std::unique_ptr<ProgramNode> ast(parser.parse());
+            if (ast->functions.size() != 1) return nullptr;
+
+            auto function = std::make_unique<FunctionState>();
+            function->text = text;
+            std::vector<Function> functions = convert_program(ast.get());
+            function->function = functions[0];
+            function->ast.reset(ast->functions[0]);
+            ast->functions.clear();
+
+            IntermediateCodeGenerator generator;
+            function->code = generator.generate(functions);
+            function->temps = generator.temps_created();
+            function->labels = generator.labels_created();
+            return function;
+        }
+        catch (const std::exception&) {
+            return nullptr;
+        }
+    }
+};
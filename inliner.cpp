@@ -0,0 +1,360 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <algorithm>
+
+#include "ir_instruction.cpp"
+#include "constant_folding.cpp"
+#include "peephole.cpp"
+
+/*
+    Expansión en línea (inlining) de llamadas a funciones.
+
+    Cada llamada "PARAM a1 ... PARAM an / x = CALL f, n" se reemplaza por una copia del cuerpo
+    de f cuando el modelo de costo lo permite:
+        costo = tamaño de f - (n + 2)      (se ahorran los PARAM, el CALL y el RETURN)
+        se expande si costo <= threshold * frecuencia
+    donde la frecuencia estimada se multiplica por loop_weight por cada bucle que rodea la
+    llamada. Las funciones recursivas (directa o mutuamente, mismo componente fuertemente
+    conexo del grafo de llamadas) nunca se expanden dentro de su propio ciclo.
+
+    En la copia los temporales y etiquetas reciben números nuevos, y los parámetros y
+    variables locales se renombran a "nombre.N" (el punto no es válido en un identificador
+    del lenguaje, así que no puede chocar con las variables de la función que llama).
+    Al terminar se alternan el plegado de constantes y el optimizador de mirilla hasta que el
+    código no cambia (ver fold_and_simplify()).
+*/
+
+class FunctionInliner {
+public:
+    struct Options {
+        int threshold = 12;           // Costo máximo aceptado para una llamada fuera de bucles
+        int loop_weight = 8;          // Factor de frecuencia por cada nivel de bucle
+        int max_function_size = 2000; // Tamaño máximo de una función después de expandir
+    };
+
+    // Estadísticas de la última llamada a inline_calls()
+    struct Stats {
+        int call_sites = 0;
+        int inlined = 0;
+        int skipped_recursive = 0;
+        int skipped_cost = 0;
+    };
+
+    FunctionInliner() {}
+    FunctionInliner(Options options) : options(options) {}
+
+    std::vector<std::string> inline_calls(const std::vector<std::string>& code) {
+        stats = Stats();
+        std::vector<Instruction> instructions = parse_instructions(code);
+
+        next_temp = 0;
+        next_label = 0;
+        for (const auto& inst : instructions) {
+            for (const std::string* name : {&inst.result, &inst.arg1, &inst.arg2}) {
+                next_temp = std::max(next_temp, temp_number(*name) + 1);
+            }
+            next_label = std::max(next_label, name_number(inst.label, 'L') + 1);
+        }
+
+        // Se separan las funciones y las líneas que están fuera de ellas
+        std::vector<std::pair<size_t, size_t>> ranges = function_ranges(instructions);
+        std::map<std::string, size_t> index;
+        functions.clear();
+        for (const auto& range : ranges) {
+            index[instructions[range.first].result] = functions.size();
+            functions.emplace_back(instructions.begin() + range.first, instructions.begin() + range.second);
+        }
+        for (const auto& inst : instructions) {
+            if (inst.kind == InstructionKind::Alias && index.count(inst.callee)) {
+                index[inst.result] = index[inst.callee];
+            }
+        }
+
+        // Se procesan las funciones de abajo hacia arriba en el grafo de llamadas,
+        // así cada función llamada ya tiene sus propias llamadas expandidas
+        std::vector<int> component = strongly_connected_components(index);
+        for (size_t f : bottom_up_order(component)) {
+            inline_function(f, index, component);
+        }
+
+        std::vector<Instruction> result;
+        size_t copied = 0;
+        for (size_t f = 0; f < ranges.size(); f++) {
+            result.insert(result.end(), instructions.begin() + copied, instructions.begin() + ranges[f].first);
+            result.insert(result.end(), functions[f].begin(), functions[f].end());
+            copied = ranges[f].second;
+        }
+        result.insert(result.end(), instructions.begin() + copied, instructions.end());
+
+        // Limpieza posterior: constantes que ahora se conocen, copias a parámetros que ya no se
+        // leen y saltos redundantes; el RETURN de cada copia deja una etiqueta, así que el
+        // plegado se repite después de que la mirilla une los bloques
+        return fold_and_simplify(format_instructions(result));
+    }
+
+    const Stats& last_stats() const {
+        return stats;
+    }
+
+private:
+    Options options;
+    Stats stats;
+    long long next_temp = 0;
+    long long next_label = 0;
+    long long next_copy = 0;
+    std::vector<std::vector<Instruction>> functions;
+
+    // Sección de grafo de llamadas -> begin
+
+    // Función para calcular los componentes fuertemente conexos (algoritmo de Tarjan).
+    // Tarjan numera los componentes en orden topológico inverso: primero las hojas.
+    std::vector<int> strongly_connected_components(const std::map<std::string, size_t>& index) {
+        size_t n = functions.size();
+        std::vector<std::vector<size_t>> callees(n);
+        for (size_t f = 0; f < n; f++) {
+            for (const auto& inst : functions[f]) {
+                auto it = (inst.kind == InstructionKind::Call) ? index.find(inst.callee) : index.end();
+                if (it != index.end()) callees[f].push_back(it->second);
+            }
+        }
+
+        std::vector<int> component(n, -1), low(n, 0), order(n, -1);
+        std::vector<bool> on_stack(n, false);
+        std::vector<size_t> stack;
+        int counter = 0, components = 0;
+
+        for (size_t root = 0; root < n; root++) {
+            if (order[root] >= 0) continue;
+            std::vector<std::pair<size_t, size_t>> work = {{root, 0}};
+            order[root] = low[root] = counter++;
+            stack.push_back(root);
+            on_stack[root] = true;
+
+            while (!work.empty()) {
+                size_t f = work.back().first;
+                size_t& next = work.back().second;
+                if (next < callees[f].size()) {
+                    size_t g = callees[f][next++];
+                    if (order[g] < 0) {
+                        order[g] = low[g] = counter++;
+                        stack.push_back(g);
+                        on_stack[g] = true;
+                        work.push_back({g, 0});
+                    }
+                    else if (on_stack[g]) {
+                        low[f] = std::min(low[f], order[g]);
+                    }
+                    continue;
+                }
+
+                if (low[f] == order[f]) {
+                    size_t g;
+                    do {
+                        g = stack.back();
+                        stack.pop_back();
+                        on_stack[g] = false;
+                        component[g] = components;
+                    } while (g != f);
+                    components++;
+                }
+                work.pop_back();
+                if (!work.empty()) {
+                    size_t parent = work.back().first;
+                    low[parent] = std::min(low[parent], low[f]);
+                }
+            }
+        }
+        return component;
+    }
+
+    static std::vector<size_t> bottom_up_order(const std::vector<int>& component) {
+        std::vector<size_t> order(component.size());
+        for (size_t f = 0; f < order.size(); f++) order[f] = f;
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            return component[a] < component[b];
+        });
+        return order;
+    }
+
+    // Sección de grafo de llamadas -> end
+
+    // Sección de expansión -> begin
+
+    // Tamaño de una función sin contar PROC, ENDP ni etiquetas
+    static int body_size(const std::vector<Instruction>& function) {
+        int size = 0;
+        for (const auto& inst : function) {
+            if (inst.kind != InstructionKind::Proc && inst.kind != InstructionKind::EndProc &&
+                inst.kind != InstructionKind::Label) size++;
+        }
+        return size;
+    }
+
+    // Profundidad de bucles de cada posición: una posición está dentro de un bucle si queda
+    // entre una etiqueta y un salto posterior hacia esa misma etiqueta
+    static std::vector<int> loop_depths(const std::vector<Instruction>& function) {
+        std::vector<int> depth(function.size() + 1, 0);
+        std::unordered_map<std::string, size_t> labels;
+        for (size_t i = 0; i < function.size(); i++) {
+            if (function[i].kind == InstructionKind::Label) labels[function[i].label] = i;
+        }
+        for (size_t i = 0; i < function.size(); i++) {
+            if (!function[i].is_jump()) continue;
+            auto it = labels.find(function[i].label);
+            if (it != labels.end() && it->second <= i) {
+                depth[it->second]++;
+                depth[i + 1]--;
+            }
+        }
+        for (size_t i = 1; i < depth.size(); i++) depth[i] += depth[i - 1];
+        return depth;
+    }
+
+    void inline_function(size_t f, const std::map<std::string, size_t>& index, const std::vector<int>& component) {
+        std::vector<Instruction>& caller = functions[f];
+        std::vector<int> depths = loop_depths(caller);
+        int size = body_size(caller);
+
+        std::vector<Instruction> result;
+        result.reserve(caller.size());
+        for (size_t i = 0; i < caller.size(); i++) {
+            const Instruction& inst = caller[i];
+            if (inst.kind != InstructionKind::Call) {
+                result.push_back(inst);
+                continue;
+            }
+            stats.call_sites++;
+
+            auto it = index.find(inst.callee);
+            if (it == index.end()) {
+                result.push_back(inst);
+                continue;
+            }
+            const std::vector<Instruction>& callee = functions[it->second];
+
+            if (component[it->second] == component[f]) {
+                stats.skipped_recursive++;
+                result.push_back(inst);
+                continue;
+            }
+
+            // Los argumentos deben ser los PARAM inmediatamente anteriores al CALL
+            size_t params = static_cast<size_t>(std::max(inst.arg_count, 0));
+            bool valid = inst.arg_count >= 0 && params == callee.front().parameters.size() && result.size() >= params;
+            for (size_t p = 0; valid && p < params; p++) {
+                valid = result[result.size() - params + p].kind == InstructionKind::Param;
+            }
+
+            long long frequency = 1;
+            for (int d = 0; d < depths[i] && frequency < 1000000; d++) frequency *= options.loop_weight;
+            int callee_size = body_size(callee);
+            long long cost = callee_size - static_cast<long long>(params + 2);
+            if (!valid || cost > options.threshold * frequency || size + callee_size > options.max_function_size) {
+                stats.skipped_cost++;
+                result.push_back(inst);
+                continue;
+            }
+
+            std::vector<std::string> args;
+            for (size_t p = 0; p < params; p++) args.push_back(result[result.size() - params + p].arg1);
+            result.resize(result.size() - params);
+
+            std::vector<Instruction> expansion = expand(callee, args, inst.result);
+            result.insert(result.end(), expansion.begin(), expansion.end());
+            size += callee_size;
+            stats.inlined++;
+        }
+        caller.swap(result);
+    }
+
+    // Función para generar la copia renombrada del cuerpo de la función llamada
+    std::vector<Instruction> expand(const std::vector<Instruction>& callee, const std::vector<std::string>& args,
+                                    const std::string& target) {
+        std::string suffix = "." + std::to_string(next_copy++);
+        std::unordered_map<std::string, std::string> names, labels;
+        auto rename = [&](const std::string& name) {
+            auto it = names.find(name);
+            if (it != names.end()) return it->second;
+            std::string renamed = is_temp(name) ? temp_name(next_temp++) : name + suffix;
+            names[name] = renamed;
+            return renamed;
+        };
+        auto relabel = [&](const std::string& label) {
+            auto it = labels.find(label);
+            if (it != labels.end()) return it->second;
+            return labels[label] = "L" + std::to_string(next_label++);
+        };
+        std::string label_return = "L" + std::to_string(next_label++);
+
+        std::vector<Instruction> expansion;
+        const std::vector<std::string>& parameters = callee.front().parameters;
+        std::set<std::string> parameter_names(parameters.begin(), parameters.end());
+        for (size_t p = 0; p < parameters.size(); p++) {
+            Instruction copy;
+            copy.kind = InstructionKind::Copy;
+            copy.result = rename(parameters[p]);
+            copy.arg1 = args[p];
+            expansion.push_back(copy);
+        }
+
+        // Las variables locales empiezan en 0 en cada llamada, igual que en un marco nuevo
+        std::set<std::string> locals;
+        for (size_t i = 1; i + 1 < callee.size(); i++) {
+            for (const auto& name : callee[i].uses()) {
+                if (!is_temp(name) && !parameter_names.count(name)) locals.insert(name);
+            }
+        }
+        for (const auto& local : locals) {
+            Instruction zero;
+            zero.kind = InstructionKind::Copy;
+            zero.result = rename(local);
+            zero.arg1 = "0";
+            expansion.push_back(zero);
+        }
+
+        for (size_t i = 1; i + 1 < callee.size(); i++) {
+            Instruction inst = callee[i];
+            if (inst.kind == InstructionKind::Return) {
+                if (!target.empty()) {
+                    Instruction copy;
+                    copy.kind = InstructionKind::Copy;
+                    copy.result = target;
+                    copy.arg1 = is_variable(inst.arg1) ? rename(inst.arg1) : (inst.arg1.empty() ? "0" : inst.arg1);
+                    expansion.push_back(copy);
+                }
+                Instruction jump;
+                jump.kind = InstructionKind::Goto;
+                jump.label = label_return;
+                expansion.push_back(jump);
+                continue;
+            }
+            inst.rename_operands(rename);
+            if (inst.kind == InstructionKind::Label || inst.is_jump()) {
+                inst.label = relabel(inst.label);
+            }
+            expansion.push_back(inst);
+        }
+
+        // Si el cuerpo puede terminar sin RETURN, el resultado es 0
+        if (!target.empty() && (expansion.empty() || !expansion.back().ends_flow())) {
+            Instruction zero;
+            zero.kind = InstructionKind::Copy;
+            zero.result = target;
+            zero.arg1 = "0";
+            expansion.push_back(zero);
+        }
+
+        Instruction label;
+        label.kind = InstructionKind::Label;
+        label.label = label_return;
+        expansion.push_back(label);
+        return expansion;
+    }
+
+    // Sección de expansión -> end
+};
@@ -1,15 +1,64 @@
+#pragma once
+
 #include <iostream>
 #include <vector>
 #include <string>
+#include <tuple>
+#include <memory>
+
+// Define the structures to match the Python AST
+// Los hijos se guardan con shared_ptr porque una estructura no puede contenerse a sí misma por valor
+struct Expression {
+    std::string type;
+    std::string op;
+    std::string name;
+    int value = 0;
+    std::shared_ptr<Expression> left;
+    std::shared_ptr<Expression> right;
+    std::shared_ptr<Expression> operand;
+    std::vector<Expression> args; // Argumentos de una llamada (name es la función)
+};
+
+struct Statement {
+    std::string type;
+    std::string target;
+    Expression expr;
+    Expression condition;
+    std::vector<Statement> if_body;
+    std::vector<Statement> else_body;
+    std::vector<Statement> body;
+    std::shared_ptr<Statement> init;
+    std::shared_ptr<Statement> increment;
+    int line = 0;   // Posición en el código fuente (0 si no se conoce)
+    int column = 0;
+};
+
+struct Function {
+    std::string name;
+    std::vector<std::string> parameters;
+    std::vector<Statement> body;
+    int line = 0;
+    int column = 0;
+};
+
+// Línea y columna del código fuente donde empieza la declaración que generó una instrucción
+struct SourcePosition {
+    int line = 0;
+    int column = 0;
+};
 
 class IntermediateCodeGenerator {
 public:
     IntermediateCodeGenerator() : temp_count(0), label_count(0) {}
 
+    // Generador que continúa la numeración de temporales y etiquetas desde los valores dados
+    IntermediateCodeGenerator(int first_temp, int first_label) : temp_count(first_temp), label_count(first_label) {}
+
     std::string new_temp() {
         // Genera un nuevo nombre temporal
         // para almacenar resultados intermedios
-        std::string temp = "t" + std::to_string(temp_count++);
+        // (el '%' evita que coincida con una variable del programa)
+        std::string temp = "%t" + std::to_string(temp_count++);
         return temp;
     }
 
@@ -24,48 +73,96 @@ public:
     std::vector<std::string> generate(const std::vector<Function>& ast) {
         // Genera el código intermedio a partir del AST
         code.clear();
+        positions.clear();
         for (const auto& function : ast) {
             generate_function(function);
         }
-        return code;
+        // El código solo se usa durante la generación: se entrega sin copiar cada línea
+        return std::move(code);
+    }
+
+    // Posición en el fuente de cada instrucción devuelta por la última llamada a generate()
+    const std::vector<SourcePosition>& source_positions() const {
+        return positions;
+    }
+
+    // Temporales y etiquetas creados hasta ahora (la numeración sigue entre llamadas a generate())
+    int temps_created() const {
+        return temp_count;
+    }
+
+    int labels_created() const {
+        return label_count;
     }
 
 private:
     int temp_count;
     int label_count;
     std::vector<std::string> code;
+    std::vector<SourcePosition> positions;
+    SourcePosition current_position; // Declaración que se está generando
+
+    // Las instrucciones agregadas desde la última marca pertenecen a la declaración actual
+    void mark_positions() {
+        positions.resize(code.size(), current_position);
+    }
 
     void generate_function(const Function& function) {
         // Genera el código intermedio para una función
         // (incluyendo su nombre y parámetros)
-        code.push_back("PROC " + function.name + ":");
+        current_position = {function.line, function.column};
+        if (function.parameters.empty()) {
+            code.push_back("PROC " + function.name + ":");
+        } else {
+            std::string parameters;
+            for (const auto& param : function.parameters) {
+                parameters += (parameters.empty() ? "" : ", ") + param;
+            }
+            code.push_back("PROC " + function.name + "(" + parameters + "):");
+        }
+        mark_positions();
         for (const auto& statement : function.body) {
             generate_statement(statement);
         }
+        current_position = {function.line, function.column};
         code.push_back("ENDP");
+        mark_positions();
     }
 
     void generate_statement(const Statement& statement) {
+        // Las instrucciones de una declaración anidada (el cuerpo de un if o de un bucle)
+        // conservan su propia posición; las demás toman la de la declaración que las contiene
+        SourcePosition enclosing = current_position;
+        mark_positions();
+        current_position = {statement.line, statement.column};
+        generate_statement_code(statement);
+        mark_positions();
+        current_position = enclosing;
+    }
+
+    void generate_statement_code(const Statement& statement) {
         // Genera el código intermedio para una declaración
         // (incluyendo asignaciones, condicionales, bucles, etc.)
-        std::string stmt_type = statement.type;
+        const std::string& stmt_type = statement.type;
 
         // Generar código según el tipo de declaración
         if (stmt_type == "assignment") {
             // Generar código para una asignación
-            std::string target = statement.target;
-            auto [expr_code, temp] = generate_expression(statement.expr);
-            code.insert(code.end(), expr_code.begin(), expr_code.end());
-            code.push_back(target + " = " + temp);
+            std::string temp = generate_expression(statement.expr);
+            code.push_back(statement.target + " = " + temp);
+        } else if (stmt_type == "declaration") { // Se genera código para una declaración de variable
+            // Solo la inicialización produce código (int x = expr; equivale a x = expr;)
+            if (!statement.expr.type.empty()) {
+                std::string temp = generate_expression(statement.expr);
+                code.push_back(statement.target + " = " + temp);
+            }
         } else if (stmt_type == "if") { // Se genera código para una declaración if
             //Se crean las etiquetas necesarias para el if
-            auto [condition_code, condition_temp] = generate_expression(statement.condition);
             std::string label_else = new_label();
             std::string label_end = new_label();
 
-            //Se genera el código para la condición
-            code.insert(code.end(), condition_code.begin(), condition_code.end());
-            code.push_back("IF_FALSE " + condition_temp + " GOTO " + label_else);
+            //Se genera el código para la condición (salta a else si es falsa)
+            generate_condition(statement.condition, "", label_else);
 
             //Se genera el código para el cuerpo del if
             for (const auto& stmt : statement.if_body) {
@@ -89,10 +186,8 @@ private:
             // Se genera la etiqueta de inicio del bucle
             code.push_back(label_start + ":");
 
-            // Se genera el código para la condición
-            auto [condition_code, condition_temp] = generate_expression(statement.condition);
-            code.insert(code.end(), condition_code.begin(), condition_code.end());
-            code.push_back("IF_FALSE " + condition_temp + " GOTO " + label_end);
+            // Se genera el código para la condición (sale del bucle si es falsa)
+            generate_condition(statement.condition, "", label_end);
 
             //Se genera el código para el cuerpo del bucle
             for (const auto& stmt : statement.body) {
@@ -112,25 +207,23 @@ private:
                 generate_statement(stmt);
             }
 
-            //Se genera el código para la condición
-            auto [condition_code, condition_temp] = generate_expression(statement.condition);
-            code.insert(code.end(), condition_code.begin(), condition_code.end());
-            code.push_back("IF " + condition_temp + " GOTO " + label_start);
+            //Se genera el código para la condición (vuelve al inicio si es verdadera)
+            generate_condition(statement.condition, label_start, "");
         } else if (stmt_type == "for") { // Se genera código para un bucle for
             // Se crean las etiquetas necesarias para el bucle
             std::string label_start = new_label();
             std::string label_end = new_label();
 
             //Se genera el código para la inicialización
-            generate_statement(statement.init);
+            if (statement.init) {
+                generate_statement(*statement.init);
+            }
 
             //Se genera la etiqueta de inicio del bucle
             code.push_back(label_start + ":");
 
-            //Se genera el código para la condición
-            auto [condition_code, condition_temp] = generate_expression(statement.condition);
-            code.insert(code.end(), condition_code.begin(), condition_code.end());
-            code.push_back("IF_FALSE " + condition_temp + " GOTO " + label_end);
+            //Se genera el código para la condición (sale del bucle si es falsa)
+            generate_condition(statement.condition, "", label_end);
 
             //Se genera el código para el cuerpo del bucle
             for (const auto& stmt : statement.body) {
@@ -138,42 +231,134 @@ private:
             }
 
             //Se genera el código para la actualización del bucle o incremento del contador
-            generate_statement(statement.increment);
+            if (statement.increment) {
+                generate_statement(*statement.increment);
+            }
 
             //Se vuelve al inicio del bucle
             code.push_back("GOTO " + label_start);
             code.push_back(label_end + ":");
+        } else if (stmt_type == "call") { // Se genera código para una llamada usada como instrucción
+            // El valor de retorno se descarta
+            generate_call(statement.expr, false);
         } else if (stmt_type == "return") { // Se genera código para una declaración return
             //Se genera el código para la expresión de retorno
-            auto [expr_code, temp] = generate_expression(statement.expr);
-            code.insert(code.end(), expr_code.begin(), expr_code.end());
+            std::string temp = generate_expression(statement.expr);
             code.push_back("RETURN " + temp);
         }
     }
 
-    std::pair<std::vector<std::string>, std::string> generate_expression(const Expression& expr) {
-        // Genera el código intermedio para una expresión
-        std::vector<std::string> code;
+    void generate_condition(const Expression& expr, const std::string& label_true, const std::string& label_false) {
+        // Genera código de saltos para una condición de control de flujo (if, while, for, do-while).
+        // Los operadores &&, || y ! se evalúan en cortocircuito y la condición nunca se guarda
+        // en un temporal: se salta directamente a label_true o label_false.
+        // Una etiqueta vacía indica que en ese caso la ejecución continúa en la siguiente instrucción.
+
+        if (expr.type.empty()) { // Condición omitida (por ejemplo en un for), siempre verdadera
+            if (!label_true.empty()) {
+                code.push_back("GOTO " + label_true);
+            }
+        } else if (expr.type == "boolean") { // Condición constante, solo se salta al destino fijo
+            std::string label = expr.value ? label_true : label_false;
+            if (!label.empty()) {
+                code.push_back("GOTO " + label);
+            }
+        } else if (expr.type == "binary" && expr.op == "&&") {
+            // Si la izquierda es falsa no se evalúa la derecha
+            std::string label_skip = label_false.empty() ? new_label() : label_false;
+            generate_condition(*expr.left, "", label_skip);
+            generate_condition(*expr.right, label_true, label_false);
+            if (label_false.empty()) {
+                code.push_back(label_skip + ":");
+            }
+        } else if (expr.type == "binary" && expr.op == "||") {
+            // Si la izquierda es verdadera no se evalúa la derecha
+            std::string label_skip = label_true.empty() ? new_label() : label_true;
+            generate_condition(*expr.left, label_skip, "");
+            generate_condition(*expr.right, label_true, label_false);
+            if (label_true.empty()) {
+                code.push_back(label_skip + ":");
+            }
+        } else if (expr.type == "unary" && expr.op == "!") {
+            // La negación solo intercambia los destinos
+            generate_condition(*expr.operand, label_false, label_true);
+        } else if (expr.type == "binary" && is_relational(expr.op)) {
+            // La comparación se usa directamente en el salto (IF a < b GOTO L)
+            std::string left_temp = generate_expression(*expr.left);
+            std::string right_temp = generate_expression(*expr.right);
+            generate_jump(left_temp + " " + expr.op + " " + right_temp, label_true, label_false);
+        } else {
+            // Cualquier otra expresión se evalúa y se salta según su valor
+            std::string temp = generate_expression(expr);
+            generate_jump(temp, label_true, label_false);
+        }
+    }
+
+    void generate_jump(const std::string& condition, const std::string& label_true, const std::string& label_false) {
+        // Genera los saltos condicionales hacia las etiquetas que no están vacías
+        if (!label_true.empty()) {
+            code.push_back("IF " + condition + " GOTO " + label_true);
+            if (!label_false.empty()) {
+                code.push_back("GOTO " + label_false);
+            }
+        } else if (!label_false.empty()) {
+            code.push_back("IF_FALSE " + condition + " GOTO " + label_false);
+        }
+    }
+
+    static bool is_relational(const std::string& op) {
+        // Operadores de comparación tal como los guarda el parser (el de Python los guarda en
+        // minúsculas: "lt", "gt", "le", "ge")
+        return op == "==" || op == "!=" || op == "LT" || op == "GT" || op == "LE" || op == "GE" || op == "lt" ||
+               op == "gt" || op == "le" || op == "ge";
+    }
+
+    std::string generate_call(const Expression& expr, bool keep_result) {
+        // Genera el código de una llamada: primero se evalúan los argumentos,
+        // luego se pasan con PARAM y al final se ejecuta CALL nombre, cantidad
+        std::vector<std::string> arg_temps;
+        for (const auto& arg : expr.args) {
+            arg_temps.push_back(generate_expression(arg));
+        }
+
+        for (const auto& arg_temp : arg_temps) {
+            code.push_back("PARAM " + arg_temp);
+        }
+
+        std::string temp;
+        std::string call = "CALL " + expr.name + ", " + std::to_string(arg_temps.size());
+        if (keep_result) {
+            temp = new_temp();
+            code.push_back(temp + " = " + call);
+        } else {
+            code.push_back(call);
+        }
+        return temp;
+    }
+
+    std::string generate_expression(const Expression& expr) {
+        // Genera el código intermedio para una expresión al final de code y devuelve el
+        // temporal, la variable o la constante con su valor (sin copiar el código de cada
+        // subexpresión en la que la contiene)
         std::string temp;
 
         if (expr.type == "binary") { // Se genera código para una expresión binaria
             // Se generan los códigos para las expresiones izquierda y derecha
-            auto [left_code, left_temp] = generate_expression(expr.left);
-            auto [right_code, right_temp] = generate_expression(expr.right);
+            std::string left_temp = generate_expression(*expr.left);
+            std::string right_temp = generate_expression(*expr.right);
             temp = new_temp();
 
             // Se generan las instrucciones para la operación binaria
-            code.insert(code.end(), left_code.begin(), left_code.end());
-            code.insert(code.end(), right_code.begin(), right_code.end());
             code.push_back(temp + " = " + left_temp + " " + expr.op + " " + right_temp);
         } else if (expr.type == "unary") { // Se genera código para una expresión unaria
             // Se genera el código para la expresión unaria
-            auto [operand_code, operand_temp] = generate_expression(expr.operand);
+            std::string operand_temp = generate_expression(*expr.operand);
             temp = new_temp();
 
             // Se genera la instrucción para la operación unaria
-            code.insert(code.end(), operand_code.begin(), operand_code.end());
             code.push_back(temp + " = " + expr.op + operand_temp);
+        } else if (expr.type == "call") { // Se genera código para una llamada a función
+            temp = generate_call(expr, true);
         } else if (expr.type == "id") { // Se genera código para una variable identificador
             // Se obtiene el nombre de la variable
             // y se asigna a la variable temporal
@@ -182,36 +367,11 @@ private:
             // Se asigna el valor del número literal
             // a la variable temporal
             temp = std::to_string(expr.value);
+        } else if (expr.type == "boolean") { // Se genera código para un literal booleano
+            // true y false se representan como 1 y 0
+            temp = expr.value ? "1" : "0";
         }
 
-        return {code, temp}; // Devuelve el código generado y la variable temporal
+        return temp; // Devuelve la variable temporal
     }
 };
-
-// Define the structures to match the Python AST
-struct Expression {
-    std::string type;
-    std::string op;
-    std::string name;
-    int value;
-    Expression left;
-    Expression right;
-    Expression operand;
-};
-
-struct Statement {
-    std::string type;
-    std::string target;
-    Expression expr;
-    Expression condition;
-    std::vector<Statement> if_body;
-    std::vector<Statement> else_body;
-    std::vector<Statement> body;
-    Statement init;
-    Statement increment;
-};
-
-struct Function {
-    std::string name;
-    std::vector<Statement> body;
-};
\ No newline at end of file
@@ -11,7 +11,7 @@ class IntermediateCodeGenerator:
         # Genera un nuevo nombre temporal
         # para almacenar resultados intermedios
 
-        temp = f"t{self.temp_count}"
+        temp = f"%t{self.temp_count}"
         self.temp_count += 1
         return temp
     
@@ -38,7 +38,11 @@ class IntermediateCodeGenerator:
         # Genera el código intermedio para una función
         # (incluyendo su nombre y parámetros)
 
-        self.code.append(f"PROC {function['name']}:")
+        parameters = [param['var_name'] for param in function.get('parameters', [])]
+        if parameters:
+            self.code.append(f"PROC {function['name']}({', '.join(parameters)}):")
+        else:
+            self.code.append(f"PROC {function['name']}:")
         for statement in function['body']:
             self.generate_statement(statement)
         self.code.append("ENDP")
@@ -59,17 +63,23 @@ class IntermediateCodeGenerator:
             expr_code, temp = self.generate_expression(statement['expr'])
             self.code.extend(expr_code)
             self.code.append(f"{target} = {temp}")
+
+        elif stmt_type == 'declaration': # Se genera código para una declaración de variable
+
+            # Solo la inicialización produce código (int x = expr; equivale a x = expr;)
+            if statement.get('init') is not None:
+                expr_code, temp = self.generate_expression(statement['init'])
+                self.code.extend(expr_code)
+                self.code.append(f"{statement['var_name']} = {temp}")
         
         elif stmt_type == 'if': # Se genera código para una declaración if
 
             #Se crean las etiquetas necesarias para el if
-            condition_code, condition_temp = self.generate_expression(statement['condition'])
             label_else = self.new_label()
             label_end = self.new_label()
             
-            #Se genera el código para la condición
-            self.code.extend(condition_code)
-            self.code.append(f"IF_FALSE {condition_temp} GOTO {label_else}")
+            #Se genera el código para la condición (salta a else si es falsa)
+            self.generate_condition(statement['condition'], None, label_else)
             
             #Se genera el código para el cuerpo del if
             for stmt in statement['if_body']:
@@ -93,10 +103,8 @@ class IntermediateCodeGenerator:
             # Se genera la etiqueta de inicio del bucle
             self.code.append(f"{label_start}:")
             
-            # Se genera el código para la condición
-            condition_code, condition_temp = self.generate_expression(statement['condition'])
-            self.code.extend(condition_code)
-            self.code.append(f"IF_FALSE {condition_temp} GOTO {label_end}")
+            # Se genera el código para la condición (sale del bucle si es falsa)
+            self.generate_condition(statement['condition'], None, label_end)
             
             #Se genera el código para el cuerpo del bucle
             for stmt in statement['body']:
@@ -116,10 +124,8 @@ class IntermediateCodeGenerator:
             for stmt in statement['body']:
                 self.generate_statement(stmt)
             
-            #Se genera el código para la condición
-            condition_code, condition_temp = self.generate_expression(statement['condition'])
-            self.code.extend(condition_code)
-            self.code.append(f"IF {condition_temp} GOTO {label_start}")
+            #Se genera el código para la condición (vuelve al inicio si es verdadera)
+            self.generate_condition(statement['condition'], label_start, None)
         
         elif stmt_type == 'for': # Se genera código para un bucle for
 
@@ -127,28 +133,35 @@ class IntermediateCodeGenerator:
             label_start = self.new_label()
             label_end = self.new_label()
             
-            #Se genera el código para la inicialización
-            self.generate_statement(statement['init'])
+            #Se genera el código para la inicialización (opcional)
+            if statement.get('init') is not None:
+                self.generate_statement(statement['init'])
             
             #Se genera la etiqueta de inicio del bucle
             self.code.append(f"{label_start}:")
             
-            #Se genera el código para la condición
-            condition_code, condition_temp = self.generate_expression(statement['condition'])
-            self.code.extend(condition_code)
-            self.code.append(f"IF_FALSE {condition_temp} GOTO {label_end}")
+            #Se genera el código para la condición (sale del bucle si es falsa)
+            self.generate_condition(statement['condition'], None, label_end)
             
             #Se genera el código para el cuerpo del bucle
             for stmt in statement['body']:
                 self.generate_statement(stmt)
             
             #Se genera el código para la actualización del bucle o incremento del contador
-            self.generate_statement(statement['increment'])
+            #(el parser la guarda en 'step' y puede omitirse)
+            if statement.get('step') is not None:
+                self.generate_statement(statement['step'])
             
             #Se vuelve al inicio del bucle
             self.code.append(f"GOTO {label_start}")
             self.code.append(f"{label_end}:")
         
+        elif stmt_type == 'call': # Se genera código para una llamada usada como instrucción
+
+            # El valor de retorno se descarta
+            call_code, _ = self.generate_call(statement['expr'], False)
+            self.code.extend(call_code)
+
         elif stmt_type == 'return': # Se genera código para una declaración return
             
             #Se genera el código para la expresión de retorno
@@ -156,6 +169,95 @@ class IntermediateCodeGenerator:
             self.code.extend(expr_code)
             self.code.append(f"RETURN {temp}")
     
+    def generate_condition(self, expr, label_true, label_false):
+
+        # Genera código de saltos para una condición de control de flujo (if, while, for, do-while).
+        # Los operadores &&, || y ! se evalúan en cortocircuito y la condición nunca se guarda
+        # en un temporal: se salta directamente a label_true o label_false.
+        # Una etiqueta None indica que en ese caso la ejecución continúa en la siguiente instrucción.
+
+        if expr is None: # Condición omitida (por ejemplo en un for), siempre verdadera
+            if label_true:
+                self.code.append(f"GOTO {label_true}")
+
+        elif expr['type'] == 'boolean': # Condición constante, solo se salta al destino fijo
+            label = label_true if expr['value'] else label_false
+            if label:
+                self.code.append(f"GOTO {label}")
+
+        elif expr['type'] == 'binary' and expr['op'] == '&&':
+
+            # Si la izquierda es falsa no se evalúa la derecha
+            label_skip = label_false or self.new_label()
+            self.generate_condition(expr['left'], None, label_skip)
+            self.generate_condition(expr['right'], label_true, label_false)
+            if not label_false:
+                self.code.append(f"{label_skip}:")
+
+        elif expr['type'] == 'binary' and expr['op'] == '||':
+
+            # Si la izquierda es verdadera no se evalúa la derecha
+            label_skip = label_true or self.new_label()
+            self.generate_condition(expr['left'], label_skip, None)
+            self.generate_condition(expr['right'], label_true, label_false)
+            if not label_true:
+                self.code.append(f"{label_skip}:")
+
+        elif expr['type'] == 'unary' and expr['op'] == '!':
+
+            # La negación solo intercambia los destinos
+            self.generate_condition(expr['operand'], label_false, label_true)
+
+        elif expr['type'] == 'binary' and expr['op'] in ['==', '!=', 'lt', 'gt', 'le', 'ge']:
+
+            # La comparación se usa directamente en el salto (IF a < b GOTO L)
+            left_code, left_temp = self.generate_expression(expr['left'])
+            right_code, right_temp = self.generate_expression(expr['right'])
+            self.code.extend(left_code)
+            self.code.extend(right_code)
+            self.generate_jump(f"{left_temp} {expr['op']} {right_temp}", label_true, label_false)
+
+        else:
+
+            # Cualquier otra expresión se evalúa y se salta según su valor
+            expr_code, temp = self.generate_expression(expr)
+            self.code.extend(expr_code)
+            self.generate_jump(temp, label_true, label_false)
+
+    def generate_jump(self, condition, label_true, label_false):
+
+        # Genera los saltos condicionales hacia las etiquetas indicadas
+
+        if label_true:
+            self.code.append(f"IF {condition} GOTO {label_true}")
+            if label_false:
+                self.code.append(f"GOTO {label_false}")
+        elif label_false:
+            self.code.append(f"IF_FALSE {condition} GOTO {label_false}")
+    
+    def generate_call(self, expr, keep_result):
+
+        # Genera el código de una llamada: primero se evalúan los argumentos,
+        # luego se pasan con PARAM y al final se ejecuta CALL nombre, cantidad
+
+        code = []
+        arg_temps = []
+        for arg in expr['args']:
+            arg_code, arg_temp = self.generate_expression(arg)
+            code.extend(arg_code)
+            arg_temps.append(arg_temp)
+
+        for arg_temp in arg_temps:
+            code.append(f"PARAM {arg_temp}")
+
+        temp = None
+        if keep_result:
+            temp = self.new_temp()
+            code.append(f"{temp} = CALL {expr['name']}, {len(arg_temps)}")
+        else:
+            code.append(f"CALL {expr['name']}, {len(arg_temps)}")
+        return code, temp
+
     def generate_expression(self, expr):
 
         # Genera el código intermedio para una expresión
@@ -186,6 +288,10 @@ class IntermediateCodeGenerator:
             code.extend(operand_code)
             code.append(f"{temp} = {expr['op']}{operand_temp}")
         
+        elif expr['type'] == 'call': # Se genera código para una llamada a función
+
+            code, temp = self.generate_call(expr, True)
+
         elif expr['type'] == 'id': # Se genera código para una variable identificador
             
             # Se obtiene el nombre de la variable
@@ -197,5 +303,10 @@ class IntermediateCodeGenerator:
             # Se asigna el valor del número literal
             # a la variable temporal
             temp = expr['value']
+
+        elif expr['type'] == 'boolean': # Se genera código para un literal booleano
+
+            # true y false se representan como 1 y 0
+            temp = 1 if expr['value'] else 0
         
         return code, temp # Devuelve el código generado y la variable temporal
\ No newline at end of file
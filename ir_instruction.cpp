@@ -0,0 +1,423 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <cctype>
+#include <stdexcept>
+
+/*
+    Representación decodificada de una línea del código intermedio de tres direcciones
+    que produce IntermediateCodeGenerator. Las fases que trabajan sobre el código intermedio
+    (asignación de registros, optimizaciones, ejecución) leen las líneas de texto con
+    parse_instruction() y las vuelven a escribir con to_string(), de modo que el formato
+    textual sigue siendo la única interfaz entre fases.
+
+    Formas reconocidas:
+        PROC nombre:            PROC nombre(a, b):                  ENDP            L0:
+        GOTO L0                 IF x GOTO L0    IF_FALSE x GOTO L0
+        IF x op y GOTO L0       IF_FALSE x op y GOTO L0
+        RETURN x                x = y           x = y op z          x = -y / x = !y
+        PARAM x                 x = CALL f, n   CALL f, n
+        ALIAS f = g             (fuera de las funciones: f es otro nombre de la función g)
+*/
+
+// Sección de operandos -> begin
+
+// Indica si el operando es una constante entera (con signo opcional)
+inline bool is_constant(const std::string& name) {
+    if (name.empty()) return false;
+    size_t i = (name[0] == '-') ? 1 : 0;
+    if (i == name.size()) return false;
+    for (; i < name.size(); i++) {
+        if (!std::isdigit(static_cast<unsigned char>(name[i]))) return false;
+    }
+    return true;
+}
+
+// Indica si el operando es un nombre (variable o temporal) y no una constante
+inline bool is_variable(const std::string& name) {
+    return !name.empty() && !is_constant(name);
+}
+
+// Número de una etiqueta u otro nombre con prefijo ("L3" -> 3), -1 si no tiene ese formato
+inline long long name_number(const std::string& name, char prefix) {
+    if (name.size() < 2 || name[0] != prefix) return -1;
+    long long value = 0;
+    for (size_t i = 1; i < name.size(); i++) {
+        if (!std::isdigit(static_cast<unsigned char>(name[i]))) return -1;
+        value = value * 10 + (name[i] - '0');
+    }
+    return value;
+}
+
+// Los temporales que crea new_temp() se llaman %t0, %t1, ...: el '%' no puede aparecer en un
+// identificador del lenguaje, así que una variable del programa (t1, x) nunca pasa por temporal
+inline std::string temp_name(long long number) {
+    return "%t" + std::to_string(number);
+}
+
+// Número de un temporal ("%t12" -> 12), -1 si el nombre no es un temporal
+inline long long temp_number(const std::string& name) {
+    if (name.size() < 3 || name[0] != '%' || name[1] != 't') return -1;
+    long long value = 0;
+    for (size_t i = 2; i < name.size(); i++) {
+        if (!std::isdigit(static_cast<unsigned char>(name[i]))) return -1;
+        value = value * 10 + (name[i] - '0');
+    }
+    return value;
+}
+
+inline bool is_temp(const std::string& name) {
+    return temp_number(name) >= 0;
+}
+
+// Convierte los operadores del generador a su forma simbólica.
+// El parser de C++ guarda el tipo de token ("PLUS", "LT") y el de Python lo guarda en
+// minúsculas para los relacionales ("lt"), por eso se aceptan todas las variantes.
+inline std::string canonical_operator(const std::string& op) {
+    if (op == "PLUS") return "+";
+    if (op == "MINUS") return "-";
+    if (op == "MUL") return "*";
+    if (op == "DIV") return "/";
+    if (op == "EQ") return "==";
+    if (op == "NE") return "!=";
+    if (op == "LT" || op == "lt") return "<";
+    if (op == "GT" || op == "gt") return ">";
+    if (op == "LE" || op == "le") return "<=";
+    if (op == "GE" || op == "ge") return ">=";
+    if (op == "AND") return "&&";
+    if (op == "OR") return "||";
+    if (op == "NOT") return "!";
+    return op;
+}
+
+inline bool is_binary_operator(const std::string& op) {
+    std::string c = canonical_operator(op);
+    return c == "+" || c == "-" || c == "*" || c == "/" || c == "==" || c == "!=" || c == "<" ||
+           c == ">" || c == "<=" || c == ">=" || c == "&&" || c == "||";
+}
+
+// Función para evaluar un operador binario sobre constantes.
+// Los operadores relacionales y lógicos producen 1 o 0 y la aritmética se desborda
+// circularmente. Devuelve false si no se puede evaluar (operador desconocido o división
+// entre cero).
+inline bool evaluate_binary(const std::string& op, long long a, long long b, long long& result) {
+    std::string c = canonical_operator(op);
+    unsigned long long ua = static_cast<unsigned long long>(a), ub = static_cast<unsigned long long>(b);
+    if (c == "+") result = static_cast<long long>(ua + ub);
+    else if (c == "-") result = static_cast<long long>(ua - ub);
+    else if (c == "*") result = static_cast<long long>(ua * ub);
+    else if (c == "/") {
+        if (b == 0) return false;
+        result = (b == -1) ? static_cast<long long>(0 - ua) : a / b;
+    }
+    else if (c == "==") result = a == b;
+    else if (c == "!=") result = a != b;
+    else if (c == "<") result = a < b;
+    else if (c == ">") result = a > b;
+    else if (c == "<=") result = a <= b;
+    else if (c == ">=") result = a >= b;
+    else if (c == "&&") result = a && b;
+    else if (c == "||") result = a || b;
+    else return false;
+    return true;
+}
+
+inline bool evaluate_unary(const std::string& op, long long a, long long& result) {
+    if (op == "-") result = static_cast<long long>(0 - static_cast<unsigned long long>(a));
+    else if (op == "!") result = !a;
+    else return false;
+    return true;
+}
+
+// Sección de operandos -> end
+
+enum class InstructionKind {
+    Proc,       // PROC nombre:, PROC nombre(a, b):
+    EndProc,    // ENDP
+    Label,      // L0:
+    Goto,       // GOTO L0
+    If,         // IF x GOTO L0, IF x op y GOTO L0
+    IfFalse,    // IF_FALSE x GOTO L0, IF_FALSE x op y GOTO L0
+    Return,     // RETURN x
+    Copy,       // x = y
+    Binary,     // x = y op z
+    Unary,      // x = -y, x = !y
+    Param,      // PARAM x
+    Call,       // x = CALL f, n  o  CALL f, n
+    Alias,      // ALIAS f = g
+    Raw         // Cualquier otra línea, se conserva sin cambios
+};
+
+struct Instruction {
+    InstructionKind kind = InstructionKind::Raw;
+    std::string result; // Destino de la operación (o nombre de la función en PROC)
+    std::string arg1;   // Primer operando (o condición en IF/IF_FALSE, valor en RETURN)
+    std::string op;     // Operador tal como aparece en el código ("PLUS", "+", "LT", "==", ...)
+    std::string arg2;   // Segundo operando en operaciones binarias y saltos con comparación
+    std::string label;  // Etiqueta de la instrucción o destino del salto
+    std::string text;   // Línea original (solo para InstructionKind::Raw)
+    std::string callee; // Función llamada en CALL o función original en ALIAS
+    int arg_count = 0;  // Cantidad de argumentos en CALL
+    std::vector<std::string> parameters; // Parámetros en PROC
+
+    // Función para escribir la instrucción con el mismo formato que usa el generador
+    std::string to_string() const {
+        switch (kind) {
+            case InstructionKind::Proc: {
+                if (parameters.empty()) return "PROC " + result + ":";
+                std::string list;
+                for (const auto& param : parameters) list += (list.empty() ? "" : ", ") + param;
+                return "PROC " + result + "(" + list + "):";
+            }
+            case InstructionKind::EndProc: return "ENDP";
+            case InstructionKind::Label: return label + ":";
+            case InstructionKind::Goto: return "GOTO " + label;
+            case InstructionKind::If: return "IF " + condition() + " GOTO " + label;
+            case InstructionKind::IfFalse: return "IF_FALSE " + condition() + " GOTO " + label;
+            case InstructionKind::Return: return "RETURN " + arg1;
+            case InstructionKind::Copy: return result + " = " + arg1;
+            case InstructionKind::Binary: return result + " = " + arg1 + " " + op + " " + arg2;
+            case InstructionKind::Unary: return result + " = " + op + arg1;
+            case InstructionKind::Param: return "PARAM " + arg1;
+            case InstructionKind::Call: {
+                std::string call = "CALL " + callee + ", " + std::to_string(arg_count);
+                return result.empty() ? call : result + " = " + call;
+            }
+            case InstructionKind::Alias: return "ALIAS " + result + " = " + callee;
+            default: return text;
+        }
+    }
+
+    // Condición de un salto condicional ("x" o "x op y")
+    std::string condition() const {
+        return op.empty() ? arg1 : arg1 + " " + op + " " + arg2;
+    }
+
+    // Función para obtener los nombres leídos por la instrucción (sin constantes)
+    std::vector<std::string> uses() const {
+        std::vector<std::string> names;
+        switch (kind) {
+            case InstructionKind::Binary:
+            case InstructionKind::If:
+            case InstructionKind::IfFalse:
+                if (is_variable(arg1)) names.push_back(arg1);
+                if (is_variable(arg2)) names.push_back(arg2);
+                break;
+            case InstructionKind::Copy:
+            case InstructionKind::Unary:
+            case InstructionKind::Return:
+            case InstructionKind::Param:
+                if (is_variable(arg1)) names.push_back(arg1);
+                break;
+            default:
+                break;
+        }
+        return names;
+    }
+
+    // Función para obtener el nombre escrito por la instrucción ("" si no escribe)
+    std::string defined() const {
+        if (kind == InstructionKind::Copy || kind == InstructionKind::Binary || kind == InstructionKind::Unary ||
+            kind == InstructionKind::Call) {
+            return result;
+        }
+        return "";
+    }
+
+    // Función para renombrar los operandos (destino y argumentos) con una función de mapeo
+    template <typename Rename>
+    void rename_operands(Rename rename) {
+        if (!defined().empty()) {
+            result = rename(result);
+        }
+        if (is_variable(arg1)) arg1 = rename(arg1);
+        if (is_variable(arg2)) arg2 = rename(arg2);
+    }
+
+    bool is_jump() const {
+        return kind == InstructionKind::Goto || kind == InstructionKind::If || kind == InstructionKind::IfFalse;
+    }
+
+    bool is_conditional_jump() const {
+        return kind == InstructionKind::If || kind == InstructionKind::IfFalse;
+    }
+
+    // Indica si después de esta instrucción la ejecución no continúa en la siguiente
+    bool ends_flow() const {
+        return kind == InstructionKind::Goto || kind == InstructionKind::Return;
+    }
+};
+
+// Divide una línea en palabras separadas por espacios
+inline std::vector<std::string> split_words(const std::string& line) {
+    std::vector<std::string> words;
+    size_t i = 0;
+    while (i < line.size()) {
+        while (i < line.size() && line[i] == ' ') i++;
+        size_t start = i;
+        while (i < line.size() && line[i] != ' ') i++;
+        if (i > start) words.push_back(line.substr(start, i - start));
+    }
+    return words;
+}
+
+// Función para decodificar una línea de código intermedio
+inline Instruction parse_instruction(const std::string& line) {
+    Instruction inst;
+    std::vector<std::string> words = split_words(line);
+
+    if (words.empty()) {
+        inst.text = line;
+        return inst;
+    }
+
+    if (words[0] == "PROC" && words.size() >= 2 && line.size() > 6 && line.back() == ':') {
+        inst.kind = InstructionKind::Proc;
+        std::string header = line.substr(5, line.size() - 6);
+        size_t paren = header.find('(');
+        if (paren != std::string::npos && header.back() == ')') {
+            // Lista de parámetros separada por comas
+            inst.result = header.substr(0, paren);
+            std::string list = header.substr(paren + 1, header.size() - paren - 2);
+            size_t start = 0;
+            while (start <= list.size()) {
+                size_t comma = list.find(',', start);
+                if (comma == std::string::npos) comma = list.size();
+                std::string param = list.substr(start, comma - start);
+                while (!param.empty() && param.front() == ' ') param.erase(param.begin());
+                inst.parameters.push_back(param);
+                start = comma + 1;
+            }
+        }
+        else {
+            inst.result = header;
+        }
+    }
+    else if (words[0] == "ENDP" && words.size() == 1) {
+        inst.kind = InstructionKind::EndProc;
+    }
+    else if (words.size() == 1 && words[0].size() > 1 && words[0].back() == ':') {
+        inst.kind = InstructionKind::Label;
+        inst.label = words[0].substr(0, words[0].size() - 1);
+    }
+    else if (words[0] == "GOTO" && words.size() == 2) {
+        inst.kind = InstructionKind::Goto;
+        inst.label = words[1];
+    }
+    else if ((words[0] == "IF" || words[0] == "IF_FALSE") && words.size() == 4 && words[2] == "GOTO") {
+        inst.kind = (words[0] == "IF") ? InstructionKind::If : InstructionKind::IfFalse;
+        inst.arg1 = words[1];
+        inst.label = words[3];
+    }
+    else if ((words[0] == "IF" || words[0] == "IF_FALSE") && words.size() == 6 && words[4] == "GOTO" &&
+             is_binary_operator(words[2])) {
+        inst.kind = (words[0] == "IF") ? InstructionKind::If : InstructionKind::IfFalse;
+        inst.arg1 = words[1];
+        inst.op = words[2];
+        inst.arg2 = words[3];
+        inst.label = words[5];
+    }
+    else if (words[0] == "PARAM" && words.size() == 2) {
+        inst.kind = InstructionKind::Param;
+        inst.arg1 = words[1];
+    }
+    else if ((words[0] == "CALL" && words.size() == 3) || (words.size() == 5 && words[1] == "=" && words[2] == "CALL")) {
+        size_t offset = (words[0] == "CALL") ? 1 : 3;
+        inst.kind = InstructionKind::Call;
+        inst.result = (offset == 3) ? words[0] : "";
+        const std::string& name = words[offset];
+        inst.callee = (!name.empty() && name.back() == ',') ? name.substr(0, name.size() - 1) : name;
+        inst.arg_count = is_constant(words[offset + 1]) ? std::stoi(words[offset + 1]) : -1;
+    }
+    else if (words[0] == "ALIAS" && words.size() == 4 && words[2] == "=") {
+        inst.kind = InstructionKind::Alias;
+        inst.result = words[1];
+        inst.callee = words[3];
+    }
+    else if (words[0] == "RETURN" && words.size() <= 2) {
+        inst.kind = InstructionKind::Return;
+        inst.arg1 = (words.size() == 2) ? words[1] : "";
+    }
+    else if (words.size() == 3 && words[1] == "=") {
+        inst.result = words[0];
+        const std::string& rhs = words[2];
+        if ((rhs[0] == '-' || rhs[0] == '!') && rhs.size() > 1 && !is_constant(rhs)) {
+            inst.kind = InstructionKind::Unary;
+            inst.op = rhs.substr(0, 1);
+            inst.arg1 = rhs.substr(1);
+        }
+        else {
+            inst.kind = InstructionKind::Copy;
+            inst.arg1 = rhs;
+        }
+    }
+    else if (words.size() == 5 && words[1] == "=" && is_binary_operator(words[3])) {
+        inst.kind = InstructionKind::Binary;
+        inst.result = words[0];
+        inst.arg1 = words[2];
+        inst.op = words[3];
+        inst.arg2 = words[4];
+    }
+    else {
+        inst.text = line;
+    }
+
+    // Si la línea no se puede reconstruir exactamente se conserva como texto
+    if (inst.kind != InstructionKind::Raw && inst.to_string() != line) {
+        Instruction raw;
+        raw.text = line;
+        return raw;
+    }
+
+    return inst;
+}
+
+// Función para decodificar un bloque completo de código intermedio
+inline std::vector<Instruction> parse_instructions(const std::vector<std::string>& code) {
+    std::vector<Instruction> instructions;
+    instructions.reserve(code.size());
+    for (const auto& line : code) {
+        instructions.push_back(parse_instruction(line));
+    }
+    return instructions;
+}
+
+// Función para volver a escribir instrucciones decodificadas como líneas de texto
+inline std::vector<std::string> format_instructions(const std::vector<Instruction>& instructions) {
+    std::vector<std::string> code;
+    code.reserve(instructions.size());
+    for (const auto& inst : instructions) {
+        code.push_back(inst.to_string());
+    }
+    return code;
+}
+
+// Función para localizar las funciones (PROC ... ENDP) dentro del código intermedio
+// Devuelve pares [inicio, fin) donde inicio apunta a PROC y fin-1 a ENDP
+inline std::vector<std::pair<size_t, size_t>> function_ranges(const std::vector<Instruction>& code) {
+    std::vector<std::pair<size_t, size_t>> ranges;
+    size_t start = 0;
+    bool inside = false;
+    for (size_t i = 0; i < code.size(); i++) {
+        if (code[i].kind == InstructionKind::Proc) {
+            if (inside) {
+                throw std::runtime_error("PROC " + code[i].result + " dentro de otra función");
+            }
+            start = i;
+            inside = true;
+        }
+        else if (code[i].kind == InstructionKind::EndProc) {
+            if (!inside) {
+                throw std::runtime_error("ENDP sin PROC en la línea " + std::to_string(i + 1));
+            }
+            ranges.push_back({start, i + 1});
+            inside = false;
+        }
+    }
+    if (inside) {
+        throw std::runtime_error("Falta ENDP para la función " + code[start].result);
+    }
+    return ranges;
+}
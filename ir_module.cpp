@@ -0,0 +1,517 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <fstream>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "ir_instruction.cpp"
+
+/*
+    Módulo binario de código intermedio.
+
+    Guarda las mismas líneas que produce IntermediateCodeGenerator (u optimize_code) en un
+    formato que se puede cargar sin volver a leer el texto:
+
+        Cabecera (64 bytes)   "IRMODULE", versión, cantidades y posición de cada sección
+        Cadenas               tabla de posiciones (cantidad + 1) y los bytes de todas las
+                              cadenas sin repetir: nombres, constantes (con su texto
+                              original, para que "007" siga siendo "007"), operadores,
+                              etiquetas y líneas que no se pudieron decodificar
+        Funciones             nombre, primera instrucción y cantidad de instrucciones de
+                              cada función (PROC ... ENDP), en el orden del código
+        Índice por nombre     las funciones ordenadas por nombre, para buscar sin tabla hash
+        Listas                parámetros de cada PROC (índices de cadenas)
+        Instrucciones         todas las líneas en orden, 20 bytes cada una: el tipo y
+                              cuatro campos de 32 bits cuyo significado depende del tipo
+
+    Todos los enteros se escriben en little-endian. La cadena 0 es siempre la vacía.
+
+    IRModule::open() proyecta el archivo en memoria con mmap y solo comprueba la cabecera y
+    los límites de las secciones, así que abrir un módulo tarda lo mismo sin importar cuántas
+    funciones tenga. Cada función se decodifica la primera vez que se pide y queda guardada
+    en el objeto; buscarla por nombre es una búsqueda binaria sobre el índice. to_text()
+    reconstruye exactamente las líneas originales, también las que quedaron fuera de las
+    funciones (ALIAS) y las que parse_instruction() conserva como texto.
+
+    Un archivo de otra versión o dañado produce runtime_error al abrirlo o al decodificar la
+    parte dañada. El objeto puede usarse desde varios hilos.
+*/
+
+class IRModule {
+public:
+    // Aumentar al cambiar el formato; open() rechaza las demás versiones
+    static constexpr uint32_t version = 1;
+
+    struct Stats {
+        size_t functions_decoded = 0;
+        size_t instructions_decoded = 0;
+    };
+
+    // Codifica un bloque de código intermedio como módulo binario
+    static std::string encode(const std::vector<std::string>& code) {
+        Encoder encoder;
+        return encoder.encode(code);
+    }
+
+    static void write(const std::string& path, const std::vector<std::string>& code) {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            throw std::runtime_error("No se pudo escribir " + path);
+        }
+        std::string bytes = encode(code);
+        file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        if (!file) {
+            throw std::runtime_error("No se pudo escribir " + path);
+        }
+    }
+
+    // Proyecta un archivo en memoria sin decodificar ninguna función
+    static std::unique_ptr<IRModule> open(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("No se pudo abrir " + path);
+        }
+        struct stat info;
+        if (fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(header_size)) {
+            ::close(fd);
+            throw std::runtime_error("Módulo IR dañado: " + path + " es demasiado corto");
+        }
+        size_t size = static_cast<size_t>(info.st_size);
+        void* memory = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (memory == MAP_FAILED) {
+            throw std::runtime_error("No se pudo proyectar " + path);
+        }
+        std::unique_ptr<IRModule> module(new IRModule(static_cast<const uint8_t*>(memory), size, true));
+        module->validate();
+        return module;
+    }
+
+    // Módulo sobre bytes en memoria (por ejemplo recibidos por red); se copian
+    static std::unique_ptr<IRModule> from_bytes(std::string bytes) {
+        if (bytes.size() < header_size) {
+            throw std::runtime_error("Módulo IR dañado: demasiado corto");
+        }
+        std::unique_ptr<IRModule> module(new IRModule(nullptr, bytes.size(), false));
+        module->storage = std::move(bytes);
+        module->data = reinterpret_cast<const uint8_t*>(module->storage.data());
+        module->validate();
+        return module;
+    }
+
+    ~IRModule() {
+        if (mapped) munmap(const_cast<uint8_t*>(data), size);
+    }
+
+    IRModule(const IRModule&) = delete;
+    IRModule& operator=(const IRModule&) = delete;
+
+    size_t function_count() const {
+        return function_total;
+    }
+
+    size_t instruction_count() const {
+        return instruction_total;
+    }
+
+    std::string function_name(size_t index) const {
+        return string(function_field(index, 0));
+    }
+
+    // Índice de la función con ese nombre, -1 si no existe
+    long find(const std::string& name) const {
+        size_t low = 0, high = function_total;
+        while (low < high) {
+            size_t middle = (low + high) / 2;
+            size_t index = sorted_function(middle);
+            int order = compare(function_field(index, 0), name);
+            if (order == 0) return static_cast<long>(index);
+            if (order < 0) low = middle + 1;
+            else high = middle;
+        }
+        return -1;
+    }
+
+    // Instrucciones de una función (de PROC a ENDP), decodificadas la primera vez que se piden
+    const std::vector<Instruction>& function(size_t index) const {
+        if (index >= function_total) {
+            throw std::runtime_error("Función " + std::to_string(index) + " fuera del módulo");
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        auto found = decoded.find(index);
+        if (found != decoded.end()) return found->second;
+
+        std::vector<Instruction> instructions = decode_range(function_field(index, 1), function_field(index, 2));
+        stats.functions_decoded++;
+        stats.instructions_decoded += instructions.size();
+        return decoded.emplace(index, std::move(instructions)).first->second;
+    }
+
+    const std::vector<Instruction>& function(const std::string& name) const {
+        long index = find(name);
+        if (index < 0) {
+            throw std::runtime_error("La función " + name + " no está en el módulo");
+        }
+        return function(static_cast<size_t>(index));
+    }
+
+    // Todas las líneas del módulo, idénticas a las que se codificaron
+    std::vector<std::string> to_text() const {
+        std::vector<std::string> code;
+        code.reserve(instruction_total);
+        for (const auto& inst : decode_range(0, instruction_total)) code.push_back(inst.to_string());
+        return code;
+    }
+
+    Stats decode_stats() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return stats;
+    }
+
+private:
+    static constexpr size_t header_size = 64;
+    static constexpr size_t instruction_size = 20;
+    static constexpr size_t function_entry_size = 12;
+    static constexpr char magic[9] = "IRMODULE";
+
+    // Posiciones de los campos de la cabecera
+    enum HeaderField : size_t {
+        VersionField = 8,
+        FunctionCountField = 12,
+        StringCountField = 16,
+        InstructionCountField = 20,
+        ListCountField = 24,
+        StringOffsetsField = 28,
+        StringDataField = 32,
+        FunctionTableField = 36,
+        SortedIndexField = 40,
+        ListField = 44,
+        CodeField = 48,
+        FileSizeField = 52
+    };
+
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+    bool mapped = false;
+    std::string storage;
+
+    uint32_t function_total = 0;
+    uint32_t string_total = 0;
+    uint32_t instruction_total = 0;
+    uint32_t list_total = 0;
+    uint32_t string_offsets = 0;
+    uint32_t string_data = 0;
+    uint32_t function_table = 0;
+    uint32_t sorted_index = 0;
+    uint32_t lists = 0;
+    uint32_t code_section = 0;
+
+    mutable std::mutex mutex;
+    mutable std::unordered_map<size_t, std::vector<Instruction>> decoded;
+    mutable Stats stats;
+
+    IRModule(const uint8_t* data, size_t size, bool mapped) : data(data), size(size), mapped(mapped) {}
+
+    static uint32_t read_u32(const uint8_t* p) {
+        return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) | (static_cast<uint32_t>(p[2]) << 16) |
+               (static_cast<uint32_t>(p[3]) << 24);
+    }
+
+    static void append_u32(std::string& out, uint32_t value) {
+        for (int shift = 0; shift < 32; shift += 8) out += static_cast<char>((value >> shift) & 0xFF);
+    }
+
+    static void damaged(const std::string& what) {
+        throw std::runtime_error("Módulo IR dañado: " + what);
+    }
+
+    uint32_t header(HeaderField field) const {
+        return read_u32(data + field);
+    }
+
+    // Comprueba la cabecera y que cada sección quede dentro del archivo (sin recorrerlas)
+    void validate() {
+        if (std::memcmp(data, magic, 8) != 0) damaged("no es un módulo IR");
+        if (header(VersionField) != version) {
+            throw std::runtime_error("Versión de módulo IR " + std::to_string(header(VersionField)) +
+                                     " no soportada (se esperaba " + std::to_string(version) + ")");
+        }
+        if (header(FileSizeField) != size) damaged("el tamaño no coincide con la cabecera");
+
+        function_total = header(FunctionCountField);
+        string_total = header(StringCountField);
+        instruction_total = header(InstructionCountField);
+        list_total = header(ListCountField);
+        string_offsets = header(StringOffsetsField);
+        string_data = header(StringDataField);
+        function_table = header(FunctionTableField);
+        sorted_index = header(SortedIndexField);
+        lists = header(ListField);
+        code_section = header(CodeField);
+
+        auto check = [&](uint64_t offset, uint64_t count, uint64_t width, const char* section) {
+            if (offset < header_size || offset + count * width > size) damaged(std::string("sección ") + section);
+        };
+        if (string_total == 0) damaged("falta la cadena vacía");
+        check(string_offsets, string_total + 1ull, 4, "de cadenas");
+        check(string_data, read_u32(data + string_offsets + 4ull * string_total), 1, "de cadenas");
+        check(function_table, function_total, function_entry_size, "de funciones");
+        check(sorted_index, function_total, 4, "del índice");
+        check(lists, list_total, 4, "de listas");
+        check(code_section, instruction_total, instruction_size, "de instrucciones");
+    }
+
+    uint32_t function_field(size_t index, size_t field) const {
+        return read_u32(data + function_table + index * function_entry_size + field * 4);
+    }
+
+    size_t sorted_function(size_t position) const {
+        uint32_t index = read_u32(data + sorted_index + position * 4);
+        if (index >= function_total) damaged("índice de funciones");
+        return index;
+    }
+
+    // Límites de una cadena dentro de la sección de datos
+    std::pair<const char*, size_t> string_bytes(uint32_t index) const {
+        if (index >= string_total) damaged("cadena " + std::to_string(index));
+        uint32_t begin = read_u32(data + string_offsets + 4ull * index);
+        uint32_t end = read_u32(data + string_offsets + 4ull * (index + 1));
+        uint32_t total = read_u32(data + string_offsets + 4ull * string_total);
+        if (begin > end || end > total) damaged("cadena " + std::to_string(index));
+        return {reinterpret_cast<const char*>(data + string_data + begin), end - begin};
+    }
+
+    std::string string(uint32_t index) const {
+        auto [bytes, length] = string_bytes(index);
+        return std::string(bytes, length);
+    }
+
+    int compare(uint32_t index, const std::string& text) const {
+        auto [bytes, length] = string_bytes(index);
+        int order = std::memcmp(bytes, text.data(), std::min(length, text.size()));
+        if (order != 0) return order;
+        return (length < text.size()) ? -1 : (length > text.size()) ? 1 : 0;
+    }
+
+    std::vector<Instruction> decode_range(uint32_t first, uint32_t count) const {
+        if (static_cast<uint64_t>(first) + count > instruction_total) damaged("rango de instrucciones");
+        std::vector<Instruction> instructions;
+        instructions.reserve(count);
+        for (uint32_t i = first; i < first + count; i++) instructions.push_back(decode(i));
+        return instructions;
+    }
+
+    // Significado de los campos a, b, c y d en cada tipo (ver Encoder::encode_instruction)
+    Instruction decode(uint32_t position) const {
+        const uint8_t* p = data + code_section + static_cast<size_t>(position) * instruction_size;
+        if (p[0] > static_cast<uint8_t>(InstructionKind::Raw)) damaged("tipo de instrucción " + std::to_string(p[0]));
+        uint32_t a = read_u32(p + 4), b = read_u32(p + 8), c = read_u32(p + 12), d = read_u32(p + 16);
+
+        Instruction inst;
+        inst.kind = static_cast<InstructionKind>(p[0]);
+        switch (inst.kind) {
+            case InstructionKind::Proc:
+                inst.result = string(a);
+                if (static_cast<uint64_t>(c) + b > list_total) damaged("lista de parámetros");
+                for (uint32_t k = 0; k < b; k++) inst.parameters.push_back(string(read_u32(data + lists + 4ull * (c + k))));
+                break;
+            case InstructionKind::EndProc:
+                break;
+            case InstructionKind::Label:
+            case InstructionKind::Goto:
+                inst.label = string(a);
+                break;
+            case InstructionKind::If:
+            case InstructionKind::IfFalse:
+                inst.arg1 = string(a);
+                inst.op = string(b);
+                inst.arg2 = string(c);
+                inst.label = string(d);
+                break;
+            case InstructionKind::Return:
+            case InstructionKind::Param:
+                inst.arg1 = string(a);
+                break;
+            case InstructionKind::Copy:
+                inst.result = string(a);
+                inst.arg1 = string(b);
+                break;
+            case InstructionKind::Binary:
+            case InstructionKind::Unary:
+                inst.result = string(a);
+                inst.arg1 = string(b);
+                inst.op = string(c);
+                inst.arg2 = string(d);
+                break;
+            case InstructionKind::Call:
+                inst.result = string(a);
+                inst.callee = string(b);
+                inst.arg_count = static_cast<int32_t>(c);
+                break;
+            case InstructionKind::Alias:
+                inst.result = string(a);
+                inst.callee = string(b);
+                break;
+            case InstructionKind::Raw:
+                inst.text = string(a);
+                break;
+        }
+        return inst;
+    }
+
+    class Encoder {
+    public:
+        std::string encode(const std::vector<std::string>& code) {
+            intern("");
+            std::vector<Instruction> instructions = parse_instructions(code);
+            for (const auto& inst : instructions) encode_instruction(inst);
+
+            // Funciones en el orden del código; el índice las ordena por nombre
+            struct Entry {
+                uint32_t name, first, count;
+            };
+            std::vector<Entry> functions;
+            for (const auto& [first, last] : function_ranges(instructions)) {
+                functions.push_back({intern(instructions[first].result), static_cast<uint32_t>(first),
+                                     static_cast<uint32_t>(last - first)});
+            }
+            std::vector<uint32_t> sorted(functions.size());
+            for (size_t i = 0; i < sorted.size(); i++) sorted[i] = static_cast<uint32_t>(i);
+            std::stable_sort(sorted.begin(), sorted.end(), [&](uint32_t x, uint32_t y) {
+                return strings[functions[x].name] < strings[functions[y].name];
+            });
+
+            std::string string_bytes;
+            std::vector<uint32_t> string_offsets;
+            for (const auto& text : strings) {
+                string_offsets.push_back(checked(string_bytes.size()));
+                string_bytes += text;
+            }
+            string_offsets.push_back(checked(string_bytes.size()));
+
+            std::string out(header_size, '\0');
+            auto section = [&](HeaderField field) {
+                while (out.size() % 4) out += '\0';
+                uint32_t offset = checked(out.size());
+                for (int k = 0; k < 4; k++) out[field + k] = static_cast<char>((offset >> (8 * k)) & 0xFF);
+            };
+            section(StringOffsetsField);
+            for (uint32_t offset : string_offsets) append_u32(out, offset);
+            section(StringDataField);
+            out += string_bytes;
+            section(FunctionTableField);
+            for (const auto& entry : functions) {
+                append_u32(out, entry.name);
+                append_u32(out, entry.first);
+                append_u32(out, entry.count);
+            }
+            section(SortedIndexField);
+            for (uint32_t index : sorted) append_u32(out, index);
+            section(ListField);
+            for (uint32_t index : list) append_u32(out, index);
+            section(CodeField);
+            out += body;
+
+            std::memcpy(&out[0], magic, 8);
+            auto set = [&](HeaderField field, size_t value) {
+                uint32_t v = checked(value);
+                for (int k = 0; k < 4; k++) out[field + k] = static_cast<char>((v >> (8 * k)) & 0xFF);
+            };
+            set(VersionField, version);
+            set(FunctionCountField, functions.size());
+            set(StringCountField, strings.size());
+            set(InstructionCountField, instructions.size());
+            set(ListCountField, list.size());
+            set(FileSizeField, out.size());
+            return out;
+        }
+
+    private:
+        std::vector<std::string> strings;
+        std::unordered_map<std::string, uint32_t> string_index;
+        std::vector<uint32_t> list;
+        std::string body;
+
+        static uint32_t checked(size_t value) {
+            if (value > UINT32_MAX) {
+                throw std::runtime_error("El código intermedio es demasiado grande para un módulo IR");
+            }
+            return static_cast<uint32_t>(value);
+        }
+
+        uint32_t intern(const std::string& text) {
+            auto [it, inserted] = string_index.emplace(text, static_cast<uint32_t>(strings.size()));
+            if (inserted) strings.push_back(text);
+            return it->second;
+        }
+
+        void encode_instruction(const Instruction& inst) {
+            uint32_t a = 0, b = 0, c = 0, d = 0;
+            switch (inst.kind) {
+                case InstructionKind::Proc:
+                    a = intern(inst.result);
+                    b = checked(inst.parameters.size());
+                    c = checked(list.size());
+                    for (const auto& param : inst.parameters) list.push_back(intern(param));
+                    break;
+                case InstructionKind::EndProc:
+                    break;
+                case InstructionKind::Label:
+                case InstructionKind::Goto:
+                    a = intern(inst.label);
+                    break;
+                case InstructionKind::If:
+                case InstructionKind::IfFalse:
+                    a = intern(inst.arg1);
+                    b = intern(inst.op);
+                    c = intern(inst.arg2);
+                    d = intern(inst.label);
+                    break;
+                case InstructionKind::Return:
+                case InstructionKind::Param:
+                    a = intern(inst.arg1);
+                    break;
+                case InstructionKind::Copy:
+                    a = intern(inst.result);
+                    b = intern(inst.arg1);
+                    break;
+                case InstructionKind::Binary:
+                case InstructionKind::Unary:
+                    a = intern(inst.result);
+                    b = intern(inst.arg1);
+                    c = intern(inst.op);
+                    d = intern(inst.arg2);
+                    break;
+                case InstructionKind::Call:
+                    a = intern(inst.result);
+                    b = intern(inst.callee);
+                    c = static_cast<uint32_t>(inst.arg_count);
+                    break;
+                case InstructionKind::Alias:
+                    a = intern(inst.result);
+                    b = intern(inst.callee);
+                    break;
+                case InstructionKind::Raw:
+                    a = intern(inst.text);
+                    break;
+            }
+            body += static_cast<char>(inst.kind);
+            body.append(3, '\0');
+            append_u32(body, a);
+            append_u32(body, b);
+            append_u32(body, c);
+            append_u32(body, d);
+        }
+    };
+};
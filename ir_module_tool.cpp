@@ -0,0 +1,155 @@
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+
+#include "compiler_pipeline.cpp"
+#include "ir_module.cpp"
+#include "program_generator.cpp"
+
+/*
+    Herramienta para módulos binarios de código intermedio (IRModule).
+
+        ir_module_tool encode entrada.ir salida.irm   Codifica un archivo de texto
+        ir_module_tool decode entrada.irm             Escribe las líneas del módulo
+        ir_module_tool list entrada.irm               Lista las funciones del módulo
+        ir_module_tool check [--functions=N] [--seed=1]
+
+    check genera un programa con N funciones cortas (ProgramGenerator), lo compila con y sin
+    optimizar, comprueba que el módulo de cada uno vuelve exactamente al mismo texto (todo
+    junto y función por función) y compara el tiempo de carga: leer y decodificar el texto
+    contra abrir el módulo y decodificar una sola función. El proceso termina con código 1
+    si algo no coincide.
+*/
+
+static std::vector<std::string> read_lines(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) {
+        throw std::runtime_error("No se pudo leer " + path);
+    }
+    std::vector<std::string> lines;
+    std::string line;
+    while (std::getline(file, line)) lines.push_back(line);
+    return lines;
+}
+
+static double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Compara un bloque de código con su módulo; devuelve la cantidad de diferencias
+static int check_code(const std::string& label, const std::vector<std::string>& code, const std::string& path) {
+    int errors = 0;
+    IRModule::write(path, code);
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<Instruction> parsed = parse_instructions(read_lines(path + ".txt"));
+    double text_seconds = seconds_since(start);
+
+    start = std::chrono::steady_clock::now();
+    std::unique_ptr<IRModule> module = IRModule::open(path);
+    double open_seconds = seconds_since(start);
+    start = std::chrono::steady_clock::now();
+    if (module->function_count() > 0) module->function(module->function_name(module->function_count() - 1));
+    double first_seconds = seconds_since(start);
+
+    if (module->to_text() != code) {
+        std::cout << "[FALLA] " << label << ": to_text() no coincide con el código" << std::endl;
+        errors++;
+    }
+    std::vector<std::pair<size_t, size_t>> ranges = function_ranges(parsed);
+    if (ranges.size() != module->function_count()) {
+        std::cout << "[FALLA] " << label << ": " << module->function_count() << " funciones en el módulo, "
+                  << ranges.size() << " en el código" << std::endl;
+        errors++;
+    }
+    for (size_t f = 0; f < ranges.size() && f < module->function_count(); f++) {
+        const std::string& name = parsed[ranges[f].first].result;
+        std::vector<std::string> expected(code.begin() + ranges[f].first, code.begin() + ranges[f].second);
+        long index = module->find(name);
+        if (index < 0 || format_instructions(module->function(static_cast<size_t>(index))) != expected) {
+            std::cout << "[FALLA] " << label << ": la función " << name << " no coincide" << std::endl;
+            errors++;
+        }
+    }
+
+    std::ifstream text(path + ".txt", std::ios::ate);
+    std::ifstream binary(path, std::ios::ate | std::ios::binary);
+    std::cout << std::left << std::setw(14) << label << std::right << std::setw(10) << code.size() << std::setw(10)
+              << module->function_count() << std::setw(12) << text.tellg() / 1024 << std::setw(13)
+              << binary.tellg() / 1024 << std::fixed << std::setprecision(3) << std::setw(12) << text_seconds * 1e3
+              << std::setw(12) << open_seconds * 1e3 << std::setw(16) << first_seconds * 1e3 << std::endl;
+    return errors;
+}
+
+static int check(int functions, uint64_t seed) {
+    ProgramGenerator::Options options;
+    options.seed = seed;
+    options.functions = functions;
+    options.statements = 3;
+    options.loop_nesting = 1;
+    std::string source = ProgramGenerator(options).generate();
+    std::vector<std::string> code = compile_source(source);
+    std::vector<std::string> optimized = optimize_code(code);
+
+    std::cout << std::left << std::setw(14) << "Código" << std::right << std::setw(10) << "Líneas" << std::setw(10)
+              << "Funciones" << std::setw(12) << "Texto (KB)" << std::setw(13) << "Módulo (KB)" << std::setw(12)
+              << "Leer (ms)" << std::setw(12) << "Abrir (ms)" << std::setw(17) << "1 función (ms)" << std::endl;
+    int errors = 0;
+    for (const auto& [label, lines] : {std::make_pair("sin optimizar", &code), std::make_pair("optimizado", &optimized)}) {
+        std::string path = "/tmp/ir_module_check_" + std::to_string(getpid()) + ".irm";
+        {
+            std::ofstream text(path + ".txt");
+            for (const auto& line : *lines) text << line << "\n";
+        }
+        errors += check_code(label, *lines, path);
+        std::remove(path.c_str());
+        std::remove((path + ".txt").c_str());
+    }
+    std::cout << errors << " diferencias" << std::endl;
+    return errors ? 1 : 0;
+}
+
+int main(int argc, char* argv[]) {
+    try {
+        std::string command = argc > 1 ? argv[1] : "";
+        if (command == "encode" && argc == 4) {
+            IRModule::write(argv[3], read_lines(argv[2]));
+            return 0;
+        }
+        if (command == "decode" && argc == 3) {
+            for (const auto& line : IRModule::open(argv[2])->to_text()) std::cout << line << "\n";
+            return 0;
+        }
+        if (command == "list" && argc == 3) {
+            std::unique_ptr<IRModule> module = IRModule::open(argv[2]);
+            for (size_t f = 0; f < module->function_count(); f++) std::cout << module->function_name(f) << "\n";
+            return 0;
+        }
+        if (command == "check") {
+            int functions = 500;
+            uint64_t seed = 1;
+            for (int i = 2; i < argc; i++) {
+                std::string arg = argv[i];
+                size_t equals = arg.find('=');
+                std::string flag = arg.substr(0, equals);
+                std::string value = equals == std::string::npos ? "" : arg.substr(equals + 1);
+                if (flag == "--functions") functions = std::stoi(value);
+                else if (flag == "--seed") seed = std::stoull(value);
+                else throw std::runtime_error("Opción desconocida: " + arg);
+            }
+            return check(functions, seed);
+        }
+        std::cerr << "Uso: ir_module_tool encode entrada.ir salida.irm | decode entrada.irm | list entrada.irm | "
+                     "check [--functions=N] [--seed=1]"
+                  << std::endl;
+        return 1;
+    }
+    catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,948 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+
+#include "ir_instruction.cpp"
+#include "execution_outcome.cpp"
+
+#if defined(__x86_64__) && defined(__linux__)
+#define JIT_SUPPORTED 1
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+/*
+    Compilador JIT del código intermedio a código máquina x86-64 (Linux).
+
+    Cada función (PROC ... ENDP) se traduce directamente a instrucciones x86-64 siguiendo
+    la convención System V: los argumentos llegan en rdi, rsi, rdx, rcx, r8, r9 (y en la
+    pila a partir del séptimo) y el resultado se devuelve en rax. Las variables más usadas
+    (cada uso dentro de un bucle pesa 8 veces más) se guardan en los registros que la
+    convención preserva entre llamadas (rbx, r12-r15); el resto vive en el marco de la
+    función. rax, rcx y rdx son registros de trabajo.
+
+    El código se escribe en memoria obtenida con mmap como lectura/escritura y después se
+    cambia a lectura/ejecución con mprotect (W^X: nunca es escribible y ejecutable a la vez).
+
+    Cada función tiene además una entrada int64_t (*)(const int64_t* args) que guarda el
+    estado necesario para abortar la ejecución: una división entre cero o un desbordamiento
+    de pila salta a un código común que restaura la pila de la entrada y deja el error en el
+    contexto del módulo. JitModule::run() convierte ese error en std::runtime_error con la
+    misma semántica que VirtualMachine.
+*/
+
+// Contexto compartido entre el código generado y JitModule (el código usa su dirección fija)
+struct JitContext {
+    int64_t saved_rsp = 0;    // Pila al entrar por la función de entrada
+    int64_t stack_limit = 0;  // Dirección mínima permitida para rsp
+    int32_t error = 0;        // 0 sin error, ver JitModule::Error
+};
+
+class JitModule {
+public:
+    using Entry = int64_t (*)(const int64_t* args);
+
+    enum Error {
+        None = 0,
+        DivisionByZero = 1,
+        StackOverflow = 2
+    };
+
+    JitModule() {}
+    JitModule(const JitModule&) = delete;
+    JitModule& operator=(const JitModule&) = delete;
+    JitModule(JitModule&& other) noexcept { *this = std::move(other); }
+    JitModule& operator=(JitModule&& other) noexcept {
+        if (this != &other) {
+            release();
+            memory = other.memory;
+            size = other.size;
+            context = std::move(other.context);
+            functions = std::move(other.functions);
+            other.memory = nullptr;
+            other.size = 0;
+        }
+        return *this;
+    }
+    ~JitModule() { release(); }
+
+    bool has_function(const std::string& name) const {
+        return functions.count(name) > 0;
+    }
+
+    int parameter_count(const std::string& name) const {
+        return find(name).parameter_count;
+    }
+
+    // Puntero a la entrada de la función. Después de llamarla, last_error() indica si se abortó.
+    Entry entry(const std::string& name) const {
+        return reinterpret_cast<Entry>(static_cast<uint8_t*>(memory) + find(name).entry);
+    }
+
+    int last_error() const {
+        return context ? context->error : None;
+    }
+
+    // Función para ejecutar una función y obtener el valor de su RETURN
+    int64_t run(const std::string& name, const std::vector<int64_t>& args = {}) const {
+        const FunctionEntry& function = find(name);
+        if (static_cast<int>(args.size()) != function.parameter_count) {
+            throw std::runtime_error("La función " + name + " espera " + std::to_string(function.parameter_count) +
+                                     " argumentos");
+        }
+        int64_t value = entry(name)(args.data());
+        if (context->error == DivisionByZero) {
+            throw std::runtime_error("División entre cero");
+        }
+        if (context->error == StackOverflow) {
+            throw StackOverflowError("Desbordamiento de la pila del código JIT al ejecutar " + name);
+        }
+        return value;
+    }
+
+    size_t code_size() const {
+        return size;
+    }
+
+private:
+    friend class JitCompiler;
+
+    struct FunctionEntry {
+        size_t entry = 0; // Desplazamiento de la función de entrada dentro de la memoria
+        int parameter_count = 0;
+    };
+
+    void* memory = nullptr;
+    size_t size = 0;
+    std::unique_ptr<JitContext> context;
+    std::unordered_map<std::string, FunctionEntry> functions; // Incluye los alias
+
+    const FunctionEntry& find(const std::string& name) const {
+        auto it = functions.find(name);
+        if (it == functions.end()) {
+            throw std::runtime_error("La función " + name + " no existe");
+        }
+        return it->second;
+    }
+
+    void release() {
+#ifdef JIT_SUPPORTED
+        if (memory) munmap(memory, size);
+#endif
+        memory = nullptr;
+        size = 0;
+    }
+};
+
+class JitCompiler {
+public:
+    struct Options {
+        int register_variables = 5;         // Variables en registros por función (0 a 5)
+        int64_t max_stack_bytes = 1 << 20;  // Pila máxima que puede usar una ejecución
+    };
+
+    // Estadísticas de la última llamada a compile()
+    struct Stats {
+        int functions = 0;
+        size_t code_bytes = 0;
+        int register_variables = 0; // Variables asignadas a registros (suma de todas las funciones)
+        int memory_variables = 0;   // Variables guardadas en el marco
+    };
+
+    JitCompiler() {}
+    JitCompiler(Options options) : options(options) {}
+
+    JitModule compile(const std::vector<std::string>& code) {
+#ifndef JIT_SUPPORTED
+        (void)code;
+        throw std::runtime_error("El compilador JIT solo está disponible en Linux x86-64");
+#else
+        stats = Stats();
+        std::vector<Instruction> instructions = parse_instructions(code);
+        std::vector<std::pair<size_t, size_t>> ranges = function_ranges(instructions);
+
+        JitModule module;
+        module.context.reset(new JitContext());
+        context = module.context.get();
+        bytes.clear();
+        call_fixups.clear();
+
+        // Nombres de las funciones (y alias) para resolver las llamadas
+        std::unordered_map<std::string, int> index;
+        std::vector<int> parameter_counts;
+        for (const auto& range : ranges) {
+            const std::string& name = instructions[range.first].result;
+            if (index.count(name)) {
+                throw std::runtime_error("Función " + name + " definida más de una vez");
+            }
+            index[name] = static_cast<int>(parameter_counts.size());
+            parameter_counts.push_back(static_cast<int>(instructions[range.first].parameters.size()));
+        }
+        for (const auto& inst : instructions) {
+            if (inst.kind != InstructionKind::Alias) continue;
+            auto target = index.find(inst.callee);
+            if (target == index.end()) {
+                throw std::runtime_error("ALIAS " + inst.result + " hacia una función inexistente: " + inst.callee);
+            }
+            index[inst.result] = target->second;
+        }
+
+        emit_error_stubs();
+
+        std::vector<size_t> starts;
+        for (const auto& range : ranges) {
+            starts.push_back(bytes.size());
+            compile_function(instructions, range.first, range.second, index, parameter_counts);
+        }
+        for (const auto& [position, function] : call_fixups) {
+            patch(position, starts[function]);
+        }
+
+        std::vector<size_t> entries;
+        for (size_t f = 0; f < ranges.size(); f++) {
+            entries.push_back(bytes.size());
+            emit_entry(starts[f], parameter_counts[f]);
+        }
+        for (const auto& [name, f] : index) {
+            JitModule::FunctionEntry entry;
+            entry.entry = entries[f];
+            entry.parameter_count = parameter_counts[f];
+            module.functions[name] = entry;
+        }
+
+        // W^X: se escribe con permisos de escritura y luego se cambia a ejecución
+        size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        size_t size = std::max<size_t>(page, (bytes.size() + page - 1) / page * page);
+        void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (memory == MAP_FAILED) {
+            throw std::runtime_error("No se pudo reservar memoria para el código JIT");
+        }
+        std::memcpy(memory, bytes.data(), bytes.size());
+        if (mprotect(memory, size, PROT_READ | PROT_EXEC) != 0) {
+            munmap(memory, size);
+            throw std::runtime_error("No se pudo marcar como ejecutable el código JIT");
+        }
+        module.memory = memory;
+        module.size = size;
+
+        stats.functions = static_cast<int>(ranges.size());
+        stats.code_bytes = bytes.size();
+        return module;
+#endif
+    }
+
+    const Stats& last_stats() const {
+        return stats;
+    }
+
+private:
+    Options options;
+    Stats stats;
+
+    // Sección de codificación x86-64 -> begin
+
+    enum Reg : uint8_t { RAX = 0, RCX, RDX, RBX, RSP, RBP, RSI, RDI, R8, R9, R10, R11, R12, R13, R14, R15 };
+
+    // Códigos de condición (jcc / setcc)
+    enum Condition : uint8_t { CC_B = 0x2, CC_E = 0x4, CC_NE = 0x5, CC_L = 0xC, CC_GE = 0xD, CC_LE = 0xE, CC_G = 0xF };
+
+    // Extensiones del grupo 0x81/0x83 y opcodes "r/m, r" y "r, r/m" de cada operación
+    enum Alu { ADD, SUB, AND, OR, CMP, IMUL };
+
+    std::vector<uint8_t> bytes;
+    JitContext* context = nullptr;
+    std::vector<std::pair<size_t, int>> call_fixups; // Posición del rel32 -> función llamada
+    size_t error_common = 0, division_by_zero = 0, stack_overflow = 0;
+
+    static bool fits_int8(int64_t value) { return value >= -128 && value <= 127; }
+    static bool fits_int32(int64_t value) { return value >= INT32_MIN && value <= INT32_MAX; }
+
+    void byte(uint8_t value) { bytes.push_back(value); }
+
+    void int32(int64_t value) {
+        uint32_t v = static_cast<uint32_t>(static_cast<int32_t>(value));
+        for (int i = 0; i < 4; i++) byte(static_cast<uint8_t>(v >> (8 * i)));
+    }
+
+    void int64(int64_t value) {
+        uint64_t v = static_cast<uint64_t>(value);
+        for (int i = 0; i < 8; i++) byte(static_cast<uint8_t>(v >> (8 * i)));
+    }
+
+    void rex(bool wide, int reg, int base, bool force = false) {
+        uint8_t value = 0x40 | (wide ? 0x08 : 0) | ((reg >> 3) << 2) | (base >> 3);
+        if (value != 0x40 || force) byte(value);
+    }
+
+    void modrm_reg(int reg, int rm) { byte(static_cast<uint8_t>(0xC0 | ((reg & 7) << 3) | (rm & 7))); }
+
+    // Operando de memoria [base + disp]; nunca se usa rsp ni r12 como base (necesitarían SIB)
+    void modrm_mem(int reg, int base, int32_t disp) {
+        if (fits_int8(disp)) {
+            byte(static_cast<uint8_t>(0x40 | ((reg & 7) << 3) | (base & 7)));
+            byte(static_cast<uint8_t>(disp));
+        }
+        else {
+            byte(static_cast<uint8_t>(0x80 | ((reg & 7) << 3) | (base & 7)));
+            int32(disp);
+        }
+    }
+
+    void mov_rr(int dst, int src) {
+        if (dst == src) return;
+        rex(true, src, dst);
+        byte(0x89);
+        modrm_reg(src, dst);
+    }
+
+    void mov_rm(int dst, int base, int32_t disp) {
+        rex(true, dst, base);
+        byte(0x8B);
+        modrm_mem(dst, base, disp);
+    }
+
+    void mov_mr(int base, int32_t disp, int src) {
+        rex(true, src, base);
+        byte(0x89);
+        modrm_mem(src, base, disp);
+    }
+
+    void mov_mi(int base, int32_t disp, int64_t value) {
+        rex(true, 0, base);
+        byte(0xC7);
+        modrm_mem(0, base, disp);
+        int32(value);
+    }
+
+    // Nota: con valor 0 se usa xor, que modifica las banderas
+    void mov_ri(int dst, int64_t value) {
+        if (value == 0) {
+            rex(false, dst, dst);
+            byte(0x31);
+            modrm_reg(dst, dst);
+        }
+        else if (fits_int32(value)) {
+            rex(true, 0, dst);
+            byte(0xC7);
+            modrm_reg(0, dst);
+            int32(value);
+        }
+        else if (value > 0 && value <= UINT32_MAX) {
+            rex(false, 0, dst);
+            byte(static_cast<uint8_t>(0xB8 + (dst & 7)));
+            int32(value);
+        }
+        else {
+            rex(true, 0, dst);
+            byte(static_cast<uint8_t>(0xB8 + (dst & 7)));
+            int64(value);
+        }
+    }
+
+    void movabs(int dst, const void* address) {
+        rex(true, 0, dst);
+        byte(static_cast<uint8_t>(0xB8 + (dst & 7)));
+        int64(static_cast<int64_t>(reinterpret_cast<uintptr_t>(address)));
+    }
+
+    void alu_rr(Alu op, int dst, int src) {
+        if (op == IMUL) {
+            rex(true, dst, src);
+            byte(0x0F);
+            byte(0xAF);
+            modrm_reg(dst, src);
+            return;
+        }
+        static const uint8_t opcodes[] = {0x01, 0x29, 0x21, 0x09, 0x39};
+        rex(true, src, dst);
+        byte(opcodes[op]);
+        modrm_reg(src, dst);
+    }
+
+    void alu_rm(Alu op, int dst, int base, int32_t disp) {
+        rex(true, dst, base);
+        if (op == IMUL) {
+            byte(0x0F);
+            byte(0xAF);
+        }
+        else {
+            static const uint8_t opcodes[] = {0x03, 0x2B, 0x23, 0x0B, 0x3B};
+            byte(opcodes[op]);
+        }
+        modrm_mem(dst, base, disp);
+    }
+
+    void alu_ri(Alu op, int dst, int64_t value) {
+        if (op == IMUL) {
+            rex(true, dst, dst);
+            byte(fits_int8(value) ? 0x6B : 0x69);
+            modrm_reg(dst, dst);
+        }
+        else {
+            static const uint8_t extensions[] = {0, 5, 4, 1, 7};
+            rex(true, 0, dst);
+            byte(fits_int8(value) ? 0x83 : 0x81);
+            modrm_reg(extensions[op], dst);
+        }
+        if (fits_int8(value)) byte(static_cast<uint8_t>(value));
+        else int32(value);
+    }
+
+    void test_rr(int a, int b) {
+        rex(true, b, a);
+        byte(0x85);
+        modrm_reg(b, a);
+    }
+
+    void unary_group(int extension, int reg) { // F7 /ext: neg (3), idiv (7)
+        rex(true, 0, reg);
+        byte(0xF7);
+        modrm_reg(extension, reg);
+    }
+
+    // setcc al/cl seguido de movzx para dejar 0 o 1 en el registro completo
+    void set_condition(Condition cc, int reg) {
+        byte(0x0F);
+        byte(static_cast<uint8_t>(0x90 + cc));
+        modrm_reg(0, reg);
+        byte(0x0F);
+        byte(0xB6);
+        modrm_reg(reg, reg);
+    }
+
+    size_t jcc(Condition cc) {
+        byte(0x0F);
+        byte(static_cast<uint8_t>(0x80 + cc));
+        int32(0);
+        return bytes.size() - 4;
+    }
+
+    size_t jmp() {
+        byte(0xE9);
+        int32(0);
+        return bytes.size() - 4;
+    }
+
+    size_t call() {
+        byte(0xE8);
+        int32(0);
+        return bytes.size() - 4;
+    }
+
+    // Completa un desplazamiento rel32 para que apunte a target
+    void patch(size_t position, size_t target) {
+        int64_t rel = static_cast<int64_t>(target) - static_cast<int64_t>(position + 4);
+        uint32_t v = static_cast<uint32_t>(static_cast<int32_t>(rel));
+        for (int i = 0; i < 4; i++) bytes[position + i] = static_cast<uint8_t>(v >> (8 * i));
+    }
+
+    void push(int reg) {
+        if (reg >= 8) byte(0x41);
+        byte(static_cast<uint8_t>(0x50 + (reg & 7)));
+    }
+
+    void pop(int reg) {
+        if (reg >= 8) byte(0x41);
+        byte(static_cast<uint8_t>(0x58 + (reg & 7)));
+    }
+
+    void push_m(int base, int32_t disp) {
+        rex(false, 0, base);
+        byte(0xFF);
+        modrm_mem(6, base, disp);
+    }
+
+    void lea(int dst, int base, int32_t disp) {
+        rex(true, dst, base);
+        byte(0x8D);
+        modrm_mem(dst, base, disp);
+    }
+
+    // Sección de codificación x86-64 -> end
+
+    // Ubicación de un operando: constante, registro o posición en el marco ([rbp + disp])
+    struct Location {
+        enum Kind { Immediate, Register, Memory } kind = Immediate;
+        int64_t value = 0;
+        int reg = RAX;
+        int32_t disp = 0;
+
+        bool is_register(int r) const { return kind == Register && reg == r; }
+    };
+
+    static constexpr int argument_registers[6] = {RDI, RSI, RDX, RCX, R8, R9};
+    static constexpr int variable_registers[5] = {RBX, R12, R13, R14, R15};
+
+    struct FunctionState {
+        std::string name;
+        std::unordered_map<std::string, Location> variables;
+        std::vector<int> saved_registers;
+        int32_t pending_base = 0; // disp del primer argumento pendiente (PARAM)
+        std::unordered_map<std::string, size_t> labels;
+        std::vector<std::pair<size_t, std::string>> jump_fixups;
+        std::vector<size_t> return_fixups;
+    };
+
+    Location location(const FunctionState& state, const std::string& operand) const {
+        Location loc;
+        if (operand.empty()) return loc; // RETURN sin valor
+        if (is_constant(operand)) {
+            loc.value = std::stoll(operand);
+            return loc;
+        }
+        return state.variables.at(operand);
+    }
+
+    void load(int reg, const Location& loc) {
+        if (loc.kind == Location::Immediate) mov_ri(reg, loc.value);
+        else if (loc.kind == Location::Register) mov_rr(reg, loc.reg);
+        else mov_rm(reg, RBP, loc.disp);
+    }
+
+    void store(const Location& loc, int reg) {
+        if (loc.kind == Location::Register) mov_rr(loc.reg, reg);
+        else mov_mr(RBP, loc.disp, reg);
+    }
+
+    // Aplica la operación entre el registro y el operando (dst = dst op operando)
+    void alu(Alu op, int dst, const Location& operand) {
+        if (operand.kind == Location::Immediate) {
+            if (fits_int32(operand.value)) {
+                alu_ri(op, dst, operand.value);
+                return;
+            }
+            mov_ri(RCX, operand.value);
+            alu_rr(op, dst, RCX);
+        }
+        else if (operand.kind == Location::Register) {
+            alu_rr(op, dst, operand.reg);
+        }
+        else {
+            alu_rm(op, dst, RBP, operand.disp);
+        }
+    }
+
+    static bool relational_condition(const std::string& op, Condition& cc) {
+        if (op == "==") cc = CC_E;
+        else if (op == "!=") cc = CC_NE;
+        else if (op == "<") cc = CC_L;
+        else if (op == ">") cc = CC_G;
+        else if (op == "<=") cc = CC_LE;
+        else if (op == ">=") cc = CC_GE;
+        else return false;
+        return true;
+    }
+
+    static Condition negate(Condition cc) {
+        return static_cast<Condition>(cc ^ 1);
+    }
+
+    // Código común de error: restaura la pila de la entrada y vuelve al llamador de la entrada
+    void emit_error_stubs() {
+        division_by_zero = bytes.size();
+        mov_ri(RAX, JitModule::DivisionByZero);
+        size_t to_common = jmp();
+        stack_overflow = bytes.size();
+        mov_ri(RAX, JitModule::StackOverflow);
+        size_t to_common2 = jmp();
+
+        error_common = bytes.size();
+        patch(to_common, error_common);
+        patch(to_common2, error_common);
+        movabs(RCX, context);
+        byte(0x89); // mov dword [rcx + error], eax
+        modrm_mem(RAX, RCX, static_cast<int32_t>(offsetof(JitContext, error)));
+        mov_rm(RSP, RCX, static_cast<int32_t>(offsetof(JitContext, saved_rsp)));
+        alu_ri(ADD, RSP, 8);
+        emit_entry_epilogue_pops();
+        mov_ri(RAX, 0);
+        byte(0xC3);
+    }
+
+    void emit_entry_epilogue_pops() {
+        pop(R15);
+        pop(R14);
+        pop(R13);
+        pop(R12);
+        pop(RBX);
+        pop(RBP);
+    }
+
+    // Entrada int64_t (*)(const int64_t* args): prepara el contexto y llama a la función
+    void emit_entry(size_t function, int parameter_count) {
+        push(RBP);
+        mov_rr(RBP, RSP);
+        for (int reg : variable_registers) push(reg);
+        alu_ri(SUB, RSP, 8); // rsp queda alineado a 16 bytes
+
+        movabs(RAX, context);
+        mov_mr(RAX, static_cast<int32_t>(offsetof(JitContext, saved_rsp)), RSP);
+        byte(0xC7); // mov dword [rax + error], 0
+        modrm_mem(0, RAX, static_cast<int32_t>(offsetof(JitContext, error)));
+        int32(0);
+        mov_rr(RCX, RSP);
+        if (fits_int32(options.max_stack_bytes)) alu_ri(SUB, RCX, options.max_stack_bytes);
+        else throw std::runtime_error("max_stack_bytes demasiado grande para el JIT");
+        mov_mr(RAX, static_cast<int32_t>(offsetof(JitContext, stack_limit)), RCX);
+
+        // Argumentos: los seis primeros en registros, el resto en la pila (en orden inverso)
+        mov_rr(R10, RDI);
+        int extra = std::max(0, parameter_count - 6);
+        if (extra % 2) alu_ri(SUB, RSP, 8);
+        for (int i = parameter_count - 1; i >= 6; i--) push_m(R10, 8 * i);
+        for (int i = 0; i < std::min(parameter_count, 6); i++) mov_rm(argument_registers[i], R10, 8 * i);
+        patch(call(), function);
+
+        lea(RSP, RBP, -40);
+        emit_entry_epilogue_pops();
+        byte(0xC3);
+    }
+
+    void compile_function(const std::vector<Instruction>& code, size_t begin, size_t end,
+                          const std::unordered_map<std::string, int>& index, const std::vector<int>& parameter_counts) {
+        FunctionState state;
+        state.name = code[begin].result;
+        const std::vector<std::string>& parameters = code[begin].parameters;
+
+        // Peso de cada variable: sus usos, multiplicados por 8 por cada bucle que los rodea.
+        // Un salto hacia atrás (a una etiqueta anterior) delimita un bucle.
+        std::unordered_map<std::string, size_t> label_positions;
+        for (size_t i = begin + 1; i + 1 < end; i++) {
+            if (code[i].kind == InstructionKind::Label) label_positions[code[i].label] = i;
+        }
+        std::vector<int> depth(end - begin, 0);
+        for (size_t i = begin + 1; i + 1 < end; i++) {
+            if (!code[i].is_jump()) continue;
+            auto target = label_positions.find(code[i].label);
+            if (target == label_positions.end() || target->second > i) continue;
+            for (size_t j = target->second; j <= i; j++) depth[j - begin]++;
+        }
+
+        std::vector<std::string> names(parameters.begin(), parameters.end());
+        std::unordered_map<std::string, uint64_t> weights;
+        for (const auto& param : parameters) weights[param] = 0;
+        int pending = 0, max_pending = 0;
+        for (size_t i = begin + 1; i + 1 < end; i++) {
+            const Instruction& inst = code[i];
+            if (inst.kind == InstructionKind::Raw || inst.kind == InstructionKind::Proc || inst.kind == InstructionKind::Alias) {
+                throw std::runtime_error("Instrucción no soportada por el JIT: " + inst.to_string());
+            }
+            uint64_t weight = uint64_t(1) << (3 * std::min(depth[i - begin], 6));
+            for (const std::string* name : {&inst.result, &inst.arg1, &inst.arg2}) {
+                if (name->empty() || is_constant(*name)) continue;
+                if (name == &inst.result && inst.defined().empty()) continue;
+                if (!weights.count(*name)) names.push_back(*name);
+                weights[*name] += weight;
+            }
+            if (inst.kind == InstructionKind::Param) max_pending = std::max(max_pending, ++pending);
+            if (inst.kind == InstructionKind::Call) pending = std::max(0, pending - inst.arg_count);
+        }
+
+        // Las variables más pesadas van a registros, en orden estable ante empates
+        std::vector<std::string> by_weight = names;
+        std::stable_sort(by_weight.begin(), by_weight.end(), [&](const std::string& a, const std::string& b) {
+            return weights[a] > weights[b];
+        });
+        int register_count = std::min<int>({options.register_variables, 5, static_cast<int>(by_weight.size())});
+        register_count = std::max(register_count, 0);
+        for (int r = 0; r < register_count; r++) {
+            Location loc;
+            loc.kind = Location::Register;
+            loc.reg = variable_registers[r];
+            state.variables[by_weight[r]] = loc;
+            state.saved_registers.push_back(variable_registers[r]);
+        }
+
+        int32_t saved_bytes = 8 * static_cast<int32_t>(state.saved_registers.size());
+        int32_t slots = 0;
+        for (const auto& name : names) {
+            if (state.variables.count(name)) continue;
+            Location loc;
+            loc.kind = Location::Memory;
+            loc.disp = -(saved_bytes + 8 * (++slots));
+            state.variables[name] = loc;
+        }
+        state.pending_base = -(saved_bytes + 8 * (slots + max_pending));
+        slots += max_pending;
+        stats.register_variables += register_count;
+        stats.memory_variables += static_cast<int>(names.size()) - register_count;
+
+        // Prólogo: marco alineado a 16 bytes, comprobación de pila, parámetros y variables en 0
+        push(RBP);
+        mov_rr(RBP, RSP);
+        for (int reg : state.saved_registers) push(reg);
+        int32_t frame = 8 * slots;
+        if ((saved_bytes + frame) % 16) frame += 8;
+        if (frame) alu_ri(SUB, RSP, frame);
+        movabs(RAX, &context->stack_limit);
+        alu_rm(CMP, RSP, RAX, 0);
+        patch(jcc(CC_B), stack_overflow);
+
+        for (size_t i = 0; i < parameters.size(); i++) {
+            const Location& loc = state.variables.at(parameters[i]);
+            if (i < 6) {
+                store(loc, argument_registers[i]);
+            }
+            else {
+                mov_rm(RAX, RBP, static_cast<int32_t>(16 + 8 * (i - 6)));
+                store(loc, RAX);
+            }
+        }
+        for (size_t v = parameters.size(); v < names.size(); v++) {
+            const Location& loc = state.variables.at(names[v]);
+            if (loc.kind == Location::Register) mov_ri(loc.reg, 0);
+            else mov_mi(RBP, loc.disp, 0);
+        }
+
+        pending = 0;
+        for (size_t i = begin + 1; i + 1 < end; i++) {
+            compile_instruction(code[i], state, pending, index, parameter_counts);
+        }
+
+        // Llegar a ENDP devuelve 0; luego el epílogo común de los RETURN
+        mov_ri(RAX, 0);
+        size_t epilogue = bytes.size();
+        lea(RSP, RBP, -saved_bytes);
+        for (auto it = state.saved_registers.rbegin(); it != state.saved_registers.rend(); ++it) pop(*it);
+        pop(RBP);
+        byte(0xC3);
+
+        for (size_t position : state.return_fixups) patch(position, epilogue);
+        for (const auto& [position, label] : state.jump_fixups) {
+            auto it = state.labels.find(label);
+            if (it == state.labels.end()) {
+                throw std::runtime_error("Etiqueta " + label + " no definida en la función " + state.name);
+            }
+            patch(position, it->second);
+        }
+    }
+
+    void compile_instruction(const Instruction& inst, FunctionState& state, int& pending,
+                             const std::unordered_map<std::string, int>& index, const std::vector<int>& parameter_counts) {
+        switch (inst.kind) {
+            case InstructionKind::Label:
+                state.labels[inst.label] = bytes.size();
+                break;
+            case InstructionKind::Goto:
+                state.jump_fixups.push_back({jmp(), inst.label});
+                break;
+            case InstructionKind::If:
+            case InstructionKind::IfFalse:
+                compile_branch(inst, state);
+                break;
+            case InstructionKind::Return:
+                load(RAX, location(state, inst.arg1));
+                state.return_fixups.push_back(jmp());
+                break;
+            case InstructionKind::Copy: {
+                Location dst = state.variables.at(inst.result);
+                Location src = location(state, inst.arg1);
+                if (dst.kind == Location::Register) {
+                    load(dst.reg, src);
+                }
+                else if (src.kind == Location::Immediate && fits_int32(src.value)) {
+                    mov_mi(RBP, dst.disp, src.value);
+                }
+                else if (src.kind == Location::Register) {
+                    store(dst, src.reg);
+                }
+                else {
+                    load(RAX, src);
+                    store(dst, RAX);
+                }
+                break;
+            }
+            case InstructionKind::Binary: {
+                Location dst = state.variables.at(inst.result);
+                int reg = compile_binary(canonical_operator(inst.op), location(state, inst.arg1),
+                                         location(state, inst.arg2), dst);
+                store(dst, reg);
+                break;
+            }
+            case InstructionKind::Unary: {
+                Location dst = state.variables.at(inst.result);
+                Location src = location(state, inst.arg1);
+                if (inst.op == "-") {
+                    int reg = (dst.kind == Location::Register) ? dst.reg : RAX;
+                    load(reg, src);
+                    unary_group(3, reg);
+                    store(dst, reg);
+                }
+                else {
+                    load(RAX, src);
+                    test_rr(RAX, RAX);
+                    set_condition(CC_E, RAX);
+                    store(dst, RAX);
+                }
+                break;
+            }
+            case InstructionKind::Param: {
+                Location src = location(state, inst.arg1);
+                int32_t disp = state.pending_base + 8 * pending++;
+                if (src.kind == Location::Register) {
+                    mov_mr(RBP, disp, src.reg);
+                }
+                else {
+                    load(RAX, src);
+                    mov_mr(RBP, disp, RAX);
+                }
+                break;
+            }
+            case InstructionKind::Call: {
+                auto callee = index.find(inst.callee);
+                if (callee == index.end()) {
+                    throw std::runtime_error("Llamada a una función no definida: " + inst.callee);
+                }
+                int n = inst.arg_count;
+                if (n != parameter_counts[callee->second]) {
+                    throw std::runtime_error("La función " + inst.callee + " espera " +
+                                             std::to_string(parameter_counts[callee->second]) +
+                                             " argumentos y se llama con " + std::to_string(n));
+                }
+                if (n > pending) {
+                    // Los PARAM deben preceder a su CALL en el mismo orden lineal que produce el generador
+                    throw std::runtime_error("CALL " + inst.callee + " sin sus PARAM en la función " + state.name);
+                }
+                int first = pending - n;
+                int extra = std::max(0, n - 6);
+                int32_t cleanup = 8 * extra;
+                if (extra % 2) {
+                    alu_ri(SUB, RSP, 8);
+                    cleanup += 8;
+                }
+                for (int a = n - 1; a >= 6; a--) push_m(RBP, state.pending_base + 8 * (first + a));
+                for (int a = 0; a < std::min(n, 6); a++) {
+                    mov_rm(argument_registers[a], RBP, state.pending_base + 8 * (first + a));
+                }
+                call_fixups.push_back({call(), callee->second});
+                if (cleanup) alu_ri(ADD, RSP, cleanup);
+                if (!inst.result.empty()) store(state.variables.at(inst.result), RAX);
+                pending = first;
+                break;
+            }
+            default:
+                throw std::runtime_error("Instrucción no soportada por el JIT: " + inst.to_string());
+        }
+    }
+
+    // Función para calcular a op b; devuelve el registro con el resultado (el del destino si es posible)
+    int compile_binary(const std::string& op, const Location& a, const Location& b, const Location& dst) {
+        Condition cc;
+        if (relational_condition(op, cc)) {
+            load(RAX, a);
+            alu(CMP, RAX, b);
+            set_condition(cc, RAX);
+            return RAX;
+        }
+        if (op == "&&" || op == "||") {
+            load(RAX, a);
+            test_rr(RAX, RAX);
+            byte(0x0F); byte(0x95); modrm_reg(0, RAX); // setne al
+            load(RCX, b);
+            test_rr(RCX, RCX);
+            byte(0x0F); byte(0x95); modrm_reg(0, RCX); // setne cl
+            byte(op == "&&" ? 0x20 : 0x08);            // and/or al, cl
+            modrm_reg(RCX, RAX);
+            byte(0x0F); byte(0xB6); modrm_reg(RAX, RAX); // movzx eax, al
+            return RAX;
+        }
+        if (op == "/") {
+            load(RAX, a);
+            if (b.kind == Location::Immediate) {
+                if (b.value == 0) {
+                    patch(jmp(), division_by_zero);
+                    return RAX;
+                }
+                if (b.value == -1) {
+                    unary_group(3, RAX);
+                    return RAX;
+                }
+                mov_ri(RCX, b.value);
+                byte(0x48); byte(0x99); // cqo
+                unary_group(7, RCX);    // idiv rcx
+                return RAX;
+            }
+            load(RCX, b);
+            test_rr(RCX, RCX);
+            patch(jcc(CC_E), division_by_zero);
+            alu_ri(CMP, RCX, -1);
+            size_t not_minus_one = jcc(CC_NE);
+            unary_group(3, RAX); // a / -1 = -a (idiv fallaría con el mínimo entero)
+            size_t done = jmp();
+            patch(not_minus_one, bytes.size());
+            byte(0x48); byte(0x99);
+            unary_group(7, RCX);
+            patch(done, bytes.size());
+            return RAX;
+        }
+
+        Alu alu_op;
+        if (op == "+") alu_op = ADD;
+        else if (op == "-") alu_op = SUB;
+        else if (op == "*") alu_op = IMUL;
+        else throw std::runtime_error("Operador no soportado por el JIT: " + op);
+
+        // Se opera directamente en el registro del destino salvo que b viva en ese registro
+        int reg = RAX;
+        if (dst.kind == Location::Register && !(b.is_register(dst.reg) && !a.is_register(dst.reg))) {
+            reg = dst.reg;
+        }
+        if (alu_op == IMUL && b.kind == Location::Immediate && fits_int32(b.value) && a.kind == Location::Register) {
+            // imul reg, a, imm en una sola instrucción
+            rex(true, reg, a.reg);
+            byte(fits_int8(b.value) ? 0x6B : 0x69);
+            modrm_reg(reg, a.reg);
+            if (fits_int8(b.value)) byte(static_cast<uint8_t>(b.value));
+            else int32(b.value);
+            return reg;
+        }
+        load(reg, a);
+        alu(alu_op, reg, b);
+        return reg;
+    }
+
+    void compile_branch(const Instruction& inst, FunctionState& state) {
+        bool negated = inst.kind == InstructionKind::IfFalse;
+        Location a = location(state, inst.arg1);
+
+        if (inst.op.empty()) {
+            if (a.kind == Location::Immediate) {
+                // Condición constante: salto incondicional o nada
+                if ((a.value != 0) != negated) state.jump_fixups.push_back({jmp(), inst.label});
+                return;
+            }
+            int reg = (a.kind == Location::Register) ? a.reg : RAX;
+            load(reg, a);
+            test_rr(reg, reg);
+            state.jump_fixups.push_back({jcc(negated ? CC_E : CC_NE), inst.label});
+            return;
+        }
+
+        Location b = location(state, inst.arg2);
+        std::string op = canonical_operator(inst.op);
+        Condition cc;
+        if (relational_condition(op, cc)) {
+            // cmp y jcc juntos, sin materializar la comparación
+            int reg = (a.kind == Location::Register) ? a.reg : RAX;
+            load(reg, a);
+            alu(CMP, reg, b);
+            state.jump_fixups.push_back({jcc(negated ? negate(cc) : cc), inst.label});
+            return;
+        }
+
+        Location scratch;
+        scratch.kind = Location::Register;
+        scratch.reg = RAX;
+        int reg = compile_binary(op, a, b, scratch);
+        test_rr(reg, reg);
+        state.jump_fixups.push_back({jcc(negated ? CC_E : CC_NE), inst.label});
+    }
+};
@@ -1,7 +1,10 @@
+#pragma once
+
 #include <iostream>
 #include <string>
 #include <vector>
-#include <regex>
+#include <string_view>
+#include <utility>
 
 class Token {
 public:
@@ -11,7 +14,7 @@ public:
     int column;
 
     Token(std::string type, std::string value, int line, int column) :
-        type(type), value(value), line(line), column(column) {}
+        type(std::move(type)), value(std::move(value)), line(line), column(column) {}
 
     // For debugging purposes
     friend std::ostream& operator<<(std::ostream& os, const Token& token) {
@@ -22,116 +25,94 @@ public:
 
 class Lexer {
 public:
-    Lexer(std::string code) : code(code), current_position(0), current_line(1), current_column(1) {
-        // Definir los tipos de tokens
-        keywords = {
-            {"function", "FUNCTION"},
-            {"if", "IF"},
-            {"else", "ELSE"},
-            {"while", "WHILE"},
-            {"do", "DO"},
-            {"for", "FOR"},
-            {"int", "INT_TYPE"},
-            {"bool", "BOOL_TYPE"},
-            {"return", "RETURN"},
-            {"true", "BOOL"},
-            {"false", "BOOL"}
-        };
+    Lexer(std::string code) : code(std::move(code)), current_position(0), current_line(1), current_column(1) {}
 
-        // Definir las expresiones regulares para los tokens
-        token_specs = {
-            {"ID", "[a-zA-Z_][a-zA-Z0-9_]*"},
-            {"INT", "\\d+"},
-            {"ASSIGN", "="},
-            {"EQ", "=="},
-            {"NE", "!="},
-            {"LE", "<="},
-            {"GE", ">="},
-            {"LT", "<"},
-            {"GT", ">"},
-            {"AND", "&&"},
-            {"OR", "\\|\\|"},
-            {"NOT", "!"},
-            {"PLUS", "\\+"},
-            {"MINUS", "-"},
-            {"MUL", "\\*"},
-            {"DIV", "/"},
-            {"LPAREN", "\\("},
-            {"RPAREN", "\\)"},
-            {"LBRACE", "\\{"},
-            {"RBRACE", "\\}"},
-            {"SEMICOLON", ";"},
-            {"COMMENT", "//.*"},
-            {"WHITESPACE", "\\s+"},
-            {"UNKNOWN", "."}
-        };
+    // Lexer de un fragmento que empieza en la línea y columna dadas del fuente completo,
+    // para que los tokens y los errores tengan las posiciones del programa entero
+    Lexer(std::string code, int first_line, int first_column) : Lexer(std::move(code)) {
+        current_line = first_line;
+        current_column = first_column;
     }
 
     std::vector<Token> tokenizer() {
-        // Bucle principal: mientras no se haya llegado al final del código
-        // se itera sobre el código dado como entrada
+        /*
+            Bucle principal: se reconoce un token por vuelta a partir de su primer carácter,
+            con las mismas reglas que las expresiones regulares de lexer.py y en su orden
+            (la primera alternativa que coincide gana, no la más larga):
+
+                ID [a-zA-Z_][a-zA-Z0-9_]* (o la palabra clave), INT \d+, "==" antes que "=",
+                "!=", "<=", ">=", "<", ">", "&&", "||", "!", "+", "-", "*", "//" hasta el
+                fin de línea antes que "/", "(", ")", "{", "}", ";", ",", espacios \s+ y
+                cualquier otro carácter como UNKNOWN.
+
+            Un '&' o '|' suelto es UNKNOWN, así que todo carácter produce un token o se
+            descarta y el lexer no falla. Las columnas cuentan bytes.
+        */
         while (current_position < code.length()) {
-            bool matched = false;
-
-            /*
-                Se busca coincidencia con cada expresión regular
-                en el orden definido en token_specs.
-                Se utiliza la posición actual para buscar coincidencias
-                y se actualiza la posición, línea y columna
-                según el tipo de token encontrado.
-            */
-            for (const auto& spec : token_specs) {
-                std::regex regex(spec.second);
-                std::string s = code.substr(current_position);
-                std::smatch match;
-
-                if (std::regex_search(s, match, regex) && match.position() == 0) {
-                    std::string token_type = spec.first;
-                    std::string value = match.str(0);
-
-                    if (token_type == "ID" && keywords.count(value)) {
-                        token_type = keywords[value];
-                        Token token(token_type, value, current_line, current_column);
-                        tokens.push_back(token);
-                    }
-                    else if (token_type == "COMMENT" || token_type == "WHITESPACE") {
-                        // Se ignoran los comentarios y espacios en blanco
-                    }
-                    else {
-                        Token token(token_type, value, current_line, current_column);
-                        tokens.push_back(token);
-                    }
+            size_t start = current_position;
+            char c = code[start];
 
-                    // Actualizar posición, línea y columna
-                    size_t newline_count = std::count(value.begin(), value.end(), '\n');
-                    if (newline_count > 0) {
-                        for (char c : value) {
-                            if (c == '\n') {
-                                current_line++;
-                                current_column = 1;
-                            }
-                            else {
-                                current_column++;
-                            }
-                        }
-                        size_t last_newline_pos = value.rfind('\n');
-                        if (last_newline_pos != std::string::npos) {
-                            current_column = value.length() - last_newline_pos;
-                        }
+            if (is_space(c)) {
+                // Se ignoran los espacios en blanco; cada salto de línea reinicia la columna
+                for (; current_position < code.length() && is_space(code[current_position]); current_position++) {
+                    if (code[current_position] == '\n') {
+                        current_line++;
+                        current_column = 1;
                     }
                     else {
-                        current_column += value.length();
+                        current_column++;
                     }
-
-                    current_position += value.length();
-                    matched = true;
-                    break;
                 }
+                continue;
             }
 
-            if (!matched) {
-                throw std::runtime_error("Carácter inesperado '" + std::string(1, code[current_position]) + "' en línea " + std::to_string(current_line) + ", columna " + std::to_string(current_column));
+            const char* token_type = "UNKNOWN";
+            size_t length = 1;
+            char next = start + 1 < code.length() ? code[start + 1] : '\0';
+            if (is_name_start(c)) {
+                while (start + length < code.length() && is_name_part(code[start + length])) length++;
+                token_type = word_type(std::string_view(code).substr(start, length));
+            }
+            else if (is_digit(c)) {
+                while (start + length < code.length() && is_digit(code[start + length])) length++;
+                token_type = "INT";
+            }
+            else if (c == '/' && next == '/') {
+                // Se ignoran los comentarios (hasta '\n' o '\r', donde termina ".*")
+                while (start + length < code.length() && code[start + length] != '\n' && code[start + length] != '\r') {
+                    length++;
+                }
+                current_position += length;
+                current_column += static_cast<int>(length);
+                continue;
+            }
+            else {
+                switch (c) {
+                case '=': token_type = (next == '=') ? "EQ" : "ASSIGN"; break;
+                case '!': token_type = (next == '=') ? "NE" : "NOT"; break;
+                case '<': token_type = (next == '=') ? "LE" : "LT"; break;
+                case '>': token_type = (next == '=') ? "GE" : "GT"; break;
+                case '&': if (next == '&') token_type = "AND"; break;
+                case '|': if (next == '|') token_type = "OR"; break;
+                case '+': token_type = "PLUS"; break;
+                case '-': token_type = "MINUS"; break;
+                case '*': token_type = "MUL"; break;
+                case '/': token_type = "DIV"; break;
+                case '(': token_type = "LPAREN"; break;
+                case ')': token_type = "RPAREN"; break;
+                case '{': token_type = "LBRACE"; break;
+                case '}': token_type = "RBRACE"; break;
+                case ';': token_type = "SEMICOLON"; break;
+                case ',': token_type = "COMMA"; break;
+                }
+                // Los operadores de dos caracteres
+                if (next == '=' && (c == '=' || c == '!' || c == '<' || c == '>')) length = 2;
+                if ((c == '&' || c == '|') && next == c) length = 2;
             }
+
+            tokens.emplace_back(token_type, code.substr(start, length), current_line, current_column);
+            current_position += length;
+            current_column += static_cast<int>(length);
         }
 
         return tokens;
@@ -139,10 +120,46 @@ public:
 
 private:
     std::string code;
-    int current_position;
+    size_t current_position;
     int current_line;
     int current_column;
     std::vector<Token> tokens;
-    std::map<std::string, std::string> keywords;
-    std::vector<std::pair<std::string, std::string>> token_specs;
-};
\ No newline at end of file
+
+    // Clases de caracteres de las expresiones (\s y \d en la configuración regional "C")
+    static bool is_space(char c) {
+        return c == ' ' || (c >= '\t' && c <= '\r');
+    }
+
+    static bool is_digit(char c) {
+        return c >= '0' && c <= '9';
+    }
+
+    static bool is_name_start(char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+    }
+
+    static bool is_name_part(char c) {
+        return is_name_start(c) || is_digit(c);
+    }
+
+    // Tipo de token de una palabra: el de la palabra clave o ID
+    static const char* word_type(std::string_view word) {
+        static const std::pair<std::string_view, const char*> keywords[] = {
+            {"function", "FUNCTION"},
+            {"if", "IF"},
+            {"else", "ELSE"},
+            {"while", "WHILE"},
+            {"do", "DO"},
+            {"for", "FOR"},
+            {"int", "INT_TYPE"},
+            {"bool", "BOOL_TYPE"},
+            {"return", "RETURN"},
+            {"true", "BOOL"},
+            {"false", "BOOL"}
+        };
+        for (const auto& keyword : keywords) {
+            if (keyword.first == word) return keyword.second;
+        }
+        return "ID";
+    }
+};
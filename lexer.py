@@ -36,11 +36,12 @@ class Lexer:
         }
 
         # Definir las expresiones regulares para los tokens
+        # (se prueban en orden: "==" antes que "=" y "//" antes que "/")
         self.token_specs = [
             ('ID', r'[a-zA-Z_][a-zA-Z0-9_]*'),
             ('INT', r'\d+'),
-            ('ASSIGN', r'='),
             ('EQ', r'=='),
+            ('ASSIGN', r'='),
             ('NE', r'!='),
             ('LE', r'<='),
             ('GE', r'>='),
@@ -52,13 +53,14 @@ class Lexer:
             ('PLUS', r'\+'),
             ('MINUS', r'-'),
             ('MUL', r'\*'),
+            ('COMMENT', r'//.*'),
             ('DIV', r'/'),
             ('LPAREN', r'\('),
             ('RPAREN', r'\)'),
             ('LBRACE', r'\{'),
             ('RBRACE', r'\}'),
             ('SEMICOLON', r';'),
-            ('COMMENT', r'//.*'),
+            ('COMMA', r','),
             ('WHITESPACE', r'\s+'),
             ('UNKNOWN', r'.')
         ]
@@ -0,0 +1,619 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <set>
+#include <map>
+#include <unordered_map>
+#include <algorithm>
+#include <cstdint>
+
+#include "ir_instruction.cpp"
+#include "control_flow.cpp"
+
+/*
+    Optimización de bucles sobre el código intermedio.
+
+    Se detectan los bucles naturales de cada función (aristas de retorno hacia un bloque que
+    domina a su origen) y, empezando por los más internos, se aplica:
+        - Desenrollado completo o parcial de bucles con número de iteraciones constante,
+          como "while (i <= 5)" con i inicializada con una constante antes del bucle.
+        - Movimiento de código invariante: los temporales cuyo valor no cambia dentro del
+          bucle se calculan una sola vez en un pre-encabezado.
+        - Reducción de fuerza: "t = i * k", con i variable de inducción y k constante, se
+          reemplaza por una variable que se incrementa en (paso * k) cada vez que cambia i.
+
+    La fase debe ejecutarse antes de LinearScanAllocator, porque trabaja sobre los temporales
+    %tN y el asignador los reemplaza por registros. Un temporal no siempre tiene una sola
+    definición (el inliner asigna el temporal del resultado en cada RETURN de la función
+    expandida), así que el movimiento de invariantes, la reducción de fuerza y el paso de
+    una variable de inducción leído a través de un temporal cuentan las definiciones y solo
+    usan temporales definidos una vez en la función.
+
+    Las constantes que se calculan (pasos, iteraciones) usan aritmética circular de 64 bits,
+    igual que la ejecución del código intermedio.
+*/
+
+class LoopOptimizer {
+public:
+    struct Options {
+        bool hoist_invariants = true;
+        bool reduce_strength = true;
+        bool unroll = true;
+        int full_unroll_max_trips = 16;        // Máximo de iteraciones para desenrollar por completo
+        int full_unroll_max_instructions = 128; // Tamaño máximo del código desenrollado
+        int unroll_factor = 4;                 // Copias del cuerpo en el desenrollado parcial
+        int partial_unroll_max_body = 16;      // Tamaño máximo del cuerpo para desenrollar parcialmente
+        long long first_temp = 0;              // Número mínimo de los temporales nuevos
+        long long first_label = 0;             // Número mínimo de las etiquetas nuevas
+    };
+
+    // Estadísticas de la última llamada a optimize()
+    struct Stats {
+        int loops = 0;
+        int hoisted = 0;
+        int strength_reduced = 0;
+        int fully_unrolled = 0;
+        int partially_unrolled = 0;
+    };
+
+    LoopOptimizer() {}
+    LoopOptimizer(Options options) : options(options) {}
+
+    std::vector<std::string> optimize(const std::vector<std::string>& code) {
+        stats = Stats();
+        std::vector<Instruction> instructions = parse_instructions(code);
+
+        // Los nombres nuevos continúan la numeración global de temporales y etiquetas
+        next_temp = options.first_temp;
+        next_label = options.first_label;
+        for (const auto& inst : instructions) {
+            for (const std::string* name : {&inst.result, &inst.arg1, &inst.arg2}) {
+                next_temp = std::max(next_temp, temp_number(*name) + 1);
+            }
+            next_label = std::max(next_label, name_number(inst.label, 'L') + 1);
+        }
+
+        std::vector<Instruction> result;
+        result.reserve(instructions.size());
+        size_t copied = 0;
+        for (const auto& range : function_ranges(instructions)) {
+            // Las líneas fuera de funciones se conservan sin cambios
+            result.insert(result.end(), instructions.begin() + copied, instructions.begin() + range.first);
+            std::vector<Instruction> function(instructions.begin() + range.first, instructions.begin() + range.second);
+            optimize_function(function);
+            result.insert(result.end(), function.begin(), function.end());
+            copied = range.second;
+        }
+        result.insert(result.end(), instructions.begin() + copied, instructions.end());
+        return format_instructions(result);
+    }
+
+    const Stats& last_stats() const {
+        return stats;
+    }
+
+private:
+    Options options;
+    Stats stats;
+    long long next_temp = 0;
+    long long next_label = 0;
+
+    struct Loop {
+        size_t header;              // Bloque de encabezado
+        std::set<size_t> blocks;    // Bloques del bucle (incluye el encabezado)
+        std::vector<size_t> latches; // Bloques con arista de retorno al encabezado
+    };
+
+    std::string new_temp() {
+        return temp_name(next_temp++);
+    }
+
+    std::string new_label() {
+        return "L" + std::to_string(next_label++);
+    }
+
+    // Función que aplica las transformaciones bucle por bucle.
+    // Cada transformación cambia las posiciones del código, por lo que se vuelve a construir
+    // el grafo después de cada una; cada encabezado se procesa una sola vez.
+    void optimize_function(std::vector<Instruction>& function) {
+        std::set<std::string> processed;
+        bool counted = false;
+        while (true) {
+            ControlFlowGraph cfg(function, 0, function.size());
+            std::vector<Loop> loops = find_loops(cfg);
+            if (!counted) {
+                stats.loops += static_cast<int>(loops.size());
+                counted = true;
+            }
+
+            bool changed = false;
+            for (const auto& loop : loops) {
+                std::string key = header_label(function, cfg, loop);
+                if (key.empty() || processed.count(key)) {
+                    continue;
+                }
+                processed.insert(key);
+                if (!is_simple(function, cfg, loop)) {
+                    continue;
+                }
+                if ((options.unroll && unroll(function, cfg, loop)) ||
+                    transform_body(function, cfg, loop, key)) {
+                    changed = true;
+                    break;
+                }
+            }
+            if (!changed) {
+                break;
+            }
+        }
+    }
+
+    // Sección de detección de bucles -> begin
+
+    // Función para calcular los dominadores inmediatos (algoritmo de Cooper, Harvey y Kennedy)
+    static std::vector<long> immediate_dominators(const ControlFlowGraph& cfg) {
+        size_t n = cfg.blocks.size();
+        std::vector<long> idom(n, -1);
+        if (n == 0) return idom;
+
+        // Orden postorden de los bloques alcanzables desde la entrada
+        std::vector<size_t> postorder;
+        std::vector<int> state(n, 0);
+        std::vector<std::pair<size_t, size_t>> stack = {{0, 0}};
+        state[0] = 1;
+        while (!stack.empty()) {
+            auto& [block, next] = stack.back();
+            if (next < cfg.blocks[block].successors.size()) {
+                size_t succ = cfg.blocks[block].successors[next++];
+                if (!state[succ]) {
+                    state[succ] = 1;
+                    stack.push_back({succ, 0});
+                }
+            }
+            else {
+                postorder.push_back(block);
+                stack.pop_back();
+            }
+        }
+        std::vector<long> order(n, -1);
+        for (size_t i = 0; i < postorder.size(); i++) order[postorder[i]] = static_cast<long>(i);
+
+        idom[0] = 0;
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            for (size_t i = postorder.size(); i-- > 0;) {
+                size_t b = postorder[i];
+                if (b == 0) continue;
+                long new_idom = -1;
+                for (size_t p : cfg.blocks[b].predecessors) {
+                    if (idom[p] < 0) continue;
+                    if (new_idom < 0) {
+                        new_idom = static_cast<long>(p);
+                        continue;
+                    }
+                    long a = static_cast<long>(p), c = new_idom;
+                    while (a != c) {
+                        while (order[a] < order[c]) a = idom[a];
+                        while (order[c] < order[a]) c = idom[c];
+                    }
+                    new_idom = a;
+                }
+                if (new_idom != idom[b]) {
+                    idom[b] = new_idom;
+                    changed = true;
+                }
+            }
+        }
+        return idom;
+    }
+
+    static bool dominates(const std::vector<long>& idom, size_t a, size_t b) {
+        if (idom[b] < 0) return false;
+        while (true) {
+            if (a == b) return true;
+            if (b == 0) return false;
+            b = static_cast<size_t>(idom[b]);
+        }
+    }
+
+    // Función para encontrar los bucles naturales, ordenados del más interno al más externo
+    static std::vector<Loop> find_loops(const ControlFlowGraph& cfg) {
+        std::vector<long> idom = immediate_dominators(cfg);
+        std::map<size_t, Loop> by_header;
+
+        for (size_t b = 0; b < cfg.blocks.size(); b++) {
+            for (size_t h : cfg.blocks[b].successors) {
+                if (!dominates(idom, h, b)) continue;
+
+                Loop& loop = by_header[h];
+                loop.header = h;
+                loop.latches.push_back(b);
+                loop.blocks.insert(h);
+
+                // Se agregan los bloques que llegan al origen de la arista sin pasar por el encabezado
+                std::vector<size_t> work = {b};
+                while (!work.empty()) {
+                    size_t x = work.back();
+                    work.pop_back();
+                    if (loop.blocks.insert(x).second) {
+                        for (size_t p : cfg.blocks[x].predecessors) work.push_back(p);
+                    }
+                }
+            }
+        }
+
+        std::vector<Loop> loops;
+        for (auto& entry : by_header) loops.push_back(entry.second);
+        std::stable_sort(loops.begin(), loops.end(), [](const Loop& a, const Loop& b) {
+            return a.blocks.size() < b.blocks.size();
+        });
+        return loops;
+    }
+
+    static std::string header_label(const std::vector<Instruction>& function, const ControlFlowGraph& cfg, const Loop& loop) {
+        const Instruction& first = function[cfg.blocks[loop.header].begin];
+        return first.kind == InstructionKind::Label ? first.label : "";
+    }
+
+    // Un bucle solo se transforma si todas sus instrucciones tienen un significado conocido
+    static bool is_simple(const std::vector<Instruction>& function, const ControlFlowGraph& cfg, const Loop& loop) {
+        for (size_t b : loop.blocks) {
+            for (size_t i = cfg.blocks[b].begin; i < cfg.blocks[b].end; i++) {
+                if (function[i].kind == InstructionKind::Raw) return false;
+            }
+        }
+        return true;
+    }
+
+    // Sección de detección de bucles -> end
+
+    // Sección de pre-encabezado -> begin
+
+    // Función para insertar instrucciones que se ejecutan una vez antes de entrar al bucle.
+    // Los saltos desde fuera del bucle hacia el encabezado se redirigen al pre-encabezado;
+    // la entrada por continuidad (el bloque anterior) llega a él de forma natural.
+    void insert_preheader(std::vector<Instruction>& function, const ControlFlowGraph& cfg, const Loop& loop,
+                          const std::vector<Instruction>& preheader) {
+        std::set<std::string> header_labels;
+        for (size_t i = cfg.blocks[loop.header].begin; function[i].kind == InstructionKind::Label; i++) {
+            header_labels.insert(function[i].label);
+        }
+
+        std::string label;
+        for (size_t b = 0; b < cfg.blocks.size(); b++) {
+            if (loop.blocks.count(b)) continue;
+            Instruction& last = function[cfg.blocks[b].end - 1];
+            if (last.is_jump() && header_labels.count(last.label)) {
+                if (label.empty()) label = new_label();
+                last.label = label;
+            }
+        }
+
+        std::vector<Instruction> inserted;
+        if (!label.empty()) {
+            Instruction inst;
+            inst.kind = InstructionKind::Label;
+            inst.label = label;
+            inserted.push_back(inst);
+        }
+        inserted.insert(inserted.end(), preheader.begin(), preheader.end());
+        function.insert(function.begin() + cfg.blocks[loop.header].begin, inserted.begin(), inserted.end());
+    }
+
+    // Sección de pre-encabezado -> end
+
+    // Sección de código invariante y reducción de fuerza -> begin
+
+    bool transform_body(std::vector<Instruction>& function, const ControlFlowGraph& cfg, const Loop& loop,
+                        const std::string& key) {
+        std::vector<size_t> positions;
+        for (size_t b : loop.blocks) {
+            for (size_t i = cfg.blocks[b].begin; i < cfg.blocks[b].end; i++) positions.push_back(i);
+        }
+        std::sort(positions.begin(), positions.end());
+
+        std::unordered_map<std::string, int> function_defs, loop_defs;
+        for (const auto& inst : function) {
+            if (!inst.defined().empty()) function_defs[inst.defined()]++;
+        }
+        for (size_t i : positions) {
+            if (!function[i].defined().empty()) loop_defs[function[i].defined()]++;
+        }
+
+        std::vector<Instruction> preheader;
+        std::set<size_t> removed;
+
+        // Movimiento de código invariante
+        if (options.hoist_invariants) {
+            std::set<std::string> invariant;
+            auto is_invariant = [&](const std::string& name) {
+                return !is_variable(name) || !loop_defs.count(name) || invariant.count(name);
+            };
+
+            bool changed = true;
+            while (changed) {
+                changed = false;
+                for (size_t i : positions) {
+                    const Instruction& inst = function[i];
+                    std::string def = inst.defined();
+                    if (inst.kind != InstructionKind::Copy && inst.kind != InstructionKind::Binary &&
+                        inst.kind != InstructionKind::Unary) continue;
+                    if (!is_temp(def) || function_defs[def] != 1 || invariant.count(def)) continue;
+                    if (!is_invariant(inst.arg1) || (inst.kind == InstructionKind::Binary && !is_invariant(inst.arg2))) continue;
+
+                    // Una división solo se adelanta si no puede fallar
+                    if (inst.kind == InstructionKind::Binary && canonical_operator(inst.op) == "/" &&
+                        (!is_constant(inst.arg2) || std::stoll(inst.arg2) == 0)) continue;
+
+                    invariant.insert(def);
+                    removed.insert(i);
+                    changed = true;
+                }
+            }
+            for (size_t i : removed) preheader.push_back(function[i]);
+            stats.hoisted += static_cast<int>(removed.size());
+        }
+
+        // Reducción de fuerza sobre variables de inducción básicas
+        std::map<size_t, std::vector<Instruction>> after;
+        if (options.reduce_strength) {
+            for (size_t i : positions) {
+                Instruction& inst = function[i];
+                if (removed.count(i) || inst.kind != InstructionKind::Binary || canonical_operator(inst.op) != "*") continue;
+                if (!is_temp(inst.result) || function_defs[inst.result] != 1) continue;
+
+                std::string iv = is_constant(inst.arg2) ? inst.arg1 : inst.arg2;
+                std::string factor = is_constant(inst.arg2) ? inst.arg2 : inst.arg1;
+                if (!is_constant(factor) || !is_variable(iv) || is_temp(iv)) continue;
+
+                long long step;
+                size_t update;
+                if (!induction_step(function, positions, iv, step, update)) continue;
+
+                std::string reduced = new_temp();
+                Instruction init = inst;
+                init.result = reduced;
+                preheader.push_back(init);
+
+                Instruction increment;
+                increment.kind = InstructionKind::Binary;
+                increment.result = reduced;
+                increment.arg1 = reduced;
+                increment.op = spelled_like(inst.op, "+");
+                increment.arg2 = std::to_string(wrap(0, step, std::stoll(factor)));
+                after[update].push_back(increment);
+
+                inst.kind = InstructionKind::Copy;
+                inst.op.clear();
+                inst.arg1 = reduced;
+                inst.arg2.clear();
+                stats.strength_reduced++;
+            }
+        }
+
+        if (preheader.empty()) {
+            return false;
+        }
+
+        // Se reconstruye el cuerpo sin las instrucciones adelantadas y con los incrementos nuevos
+        std::vector<Instruction> rebuilt;
+        rebuilt.reserve(function.size() + after.size());
+        for (size_t i = 0; i < function.size(); i++) {
+            if (!removed.count(i)) rebuilt.push_back(function[i]);
+            auto it = after.find(i);
+            if (it != after.end()) rebuilt.insert(rebuilt.end(), it->second.begin(), it->second.end());
+        }
+
+        // El pre-encabezado se inserta sobre el grafo del código reconstruido
+        function = rebuilt;
+        ControlFlowGraph rebuilt_cfg(function, 0, function.size());
+        size_t header = rebuilt_cfg.target_block(key);
+        for (const auto& rebuilt_loop : find_loops(rebuilt_cfg)) {
+            if (rebuilt_loop.header == header) {
+                insert_preheader(function, rebuilt_cfg, rebuilt_loop, preheader);
+                break;
+            }
+        }
+        return true;    }
+
+    // Función para reconocer una variable de inducción básica: una sola definición dentro del
+    // bucle de la forma "v = v + c", "v = v - c" o "v = t" con "t = v +/- c".
+    static bool induction_step(const std::vector<Instruction>& function, const std::vector<size_t>& positions,
+                               const std::string& iv, long long& step, size_t& update) {
+        size_t defs = 0;
+        for (size_t i : positions) {
+            if (function[i].defined() == iv) {
+                defs++;
+                update = i;
+            }
+        }
+        if (defs != 1) return false;
+
+        const Instruction* source = &function[update];
+        if (source->kind == InstructionKind::Copy && is_temp(source->arg1)) {
+            // El temporal tiene que tener una sola definición en la función, dentro del bucle
+            const std::string& temp = source->arg1;
+            size_t temp_defs = 0;
+            for (const auto& inst : function) {
+                if (inst.defined() == temp) temp_defs++;
+            }
+            source = nullptr;
+            for (size_t i : positions) {
+                if (function[i].defined() == temp) source = &function[i];
+            }
+            if (!source || temp_defs != 1) return false;
+        }
+        return constant_step(*source, iv, step);
+    }
+
+    // a + b * c con aritmética circular de 64 bits (sin desbordamiento con signo)
+    static long long wrap(long long a, long long b, long long c) {
+        return static_cast<long long>(static_cast<uint64_t>(a) + static_cast<uint64_t>(b) * static_cast<uint64_t>(c));
+    }
+
+    static bool constant_step(const Instruction& inst, const std::string& iv, long long& step) {
+        if (inst.kind != InstructionKind::Binary) return false;
+        std::string op = canonical_operator(inst.op);
+        if (op == "+" && inst.arg1 == iv && is_constant(inst.arg2)) step = std::stoll(inst.arg2);
+        else if (op == "+" && inst.arg2 == iv && is_constant(inst.arg1)) step = std::stoll(inst.arg1);
+        else if (op == "-" && inst.arg1 == iv && is_constant(inst.arg2)) step = wrap(0, -1, std::stoll(inst.arg2));
+        else return false;
+        return true;
+    }
+
+    // Escribe un operador con el mismo estilo que otro ("MUL" -> "PLUS", "*" -> "+")
+    static std::string spelled_like(const std::string& example, const std::string& symbol) {
+        if (example == canonical_operator(example)) return symbol;
+        if (symbol == "+") return "PLUS";
+        if (symbol == "-") return "MINUS";
+        if (symbol == "*") return "MUL";
+        return symbol;
+    }
+
+    // Sección de código invariante y reducción de fuerza -> end
+
+    // Sección de desenrollado -> begin
+
+    // Función para desenrollar un bucle con la forma que genera while/for:
+    //     Lh: [temporales de la condición] IF_FALSE i op n GOTO Le
+    //         [cuerpo sin saltos que actualiza i una vez] GOTO Lh
+    // con i inicializada con una constante justo antes del bucle y n constante.
+    bool unroll(std::vector<Instruction>& function, const ControlFlowGraph& cfg, const Loop& loop) {
+        size_t h = loop.header;
+        if (loop.blocks.size() != 2 || !loop.blocks.count(h + 1) || h == 0) return false;
+        const BasicBlock& header = cfg.blocks[h];
+        const BasicBlock& body = cfg.blocks[h + 1];
+        const BasicBlock& before = cfg.blocks[h - 1];
+
+        // Solo se entra al bucle por continuidad desde el bloque anterior
+        if (header.predecessors.size() != 2 || function[before.end - 1].ends_flow()) return false;
+        for (size_t p : header.predecessors) {
+            if (p != h - 1 && p != h + 1) return false;
+        }
+
+        const Instruction& exit = function[header.end - 1];
+        const Instruction& back = function[body.end - 1];
+        if (exit.kind != InstructionKind::IfFalse || back.kind != InstructionKind::Goto) return false;
+
+        // Encabezado: etiquetas, temporales de la condición y el salto de salida
+        std::unordered_map<std::string, const Instruction*> header_temps;
+        for (size_t i = header.begin; i + 1 < header.end; i++) {
+            const Instruction& inst = function[i];
+            if (inst.kind == InstructionKind::Label) continue;
+            if (!is_temp(inst.defined())) return false;
+            header_temps[inst.result] = &inst;
+        }
+
+        // Se obtiene la comparación "i op n"
+        std::string iv, op, bound;
+        const Instruction* compare = &exit;
+        if (exit.op.empty()) {
+            auto it = header_temps.find(exit.arg1);
+            if (it == header_temps.end() || it->second->kind != InstructionKind::Binary) return false;
+            compare = it->second;
+        }
+        op = canonical_operator(compare->op);
+        if (is_constant(compare->arg2) && is_variable(compare->arg1)) {
+            iv = compare->arg1;
+            bound = compare->arg2;
+        }
+        else if (is_constant(compare->arg1) && is_variable(compare->arg2)) {
+            iv = compare->arg2;
+            bound = compare->arg1;
+            op = (op == "<") ? ">" : (op == ">") ? "<" : (op == "<=") ? ">=" : (op == ">=") ? "<=" : op;
+        }
+        else {
+            return false;
+        }
+        if (is_temp(iv) || (op != "<" && op != "<=" && op != ">" && op != ">=" && op != "!=")) return false;
+
+        // Cuerpo: instrucciones simples y una sola actualización constante de i
+        std::vector<size_t> body_positions;
+        for (size_t i = body.begin; i + 1 < body.end; i++) {
+            InstructionKind kind = function[i].kind;
+            if (kind != InstructionKind::Copy && kind != InstructionKind::Binary && kind != InstructionKind::Unary) return false;
+            body_positions.push_back(i);
+        }
+        long long step;
+        size_t update;
+        if (!induction_step(function, body_positions, iv, step, update) || step == 0) return false;
+
+        // Valor inicial de i: última asignación constante en el bloque anterior
+        long long start = 0;
+        bool found = false;
+        for (size_t i = before.end; i-- > before.begin;) {
+            if (function[i].defined() == iv) {
+                if (function[i].kind != InstructionKind::Copy || !is_constant(function[i].arg1)) return false;
+                start = std::stoll(function[i].arg1);
+                found = true;
+                break;
+            }
+        }
+        if (!found) return false;
+
+        // Número de iteraciones simulando la condición
+        long long limit = std::stoll(bound), value = start, trips = 0;
+        auto holds = [&](long long v) {
+            return op == "<" ? v < limit : op == "<=" ? v <= limit : op == ">" ? v > limit : op == ">=" ? v >= limit : v != limit;
+        };
+        while (holds(value)) {
+            if (++trips > 1000000) return false;
+            value = wrap(value, 1, step);
+        }
+
+        long long body_size = static_cast<long long>(body_positions.size());
+        bool full = trips <= options.full_unroll_max_trips && trips * body_size <= options.full_unroll_max_instructions;
+        bool partial = !full && options.unroll_factor > 1 && trips >= 2 * options.unroll_factor &&
+                       body_size <= options.partial_unroll_max_body;
+        if (!full && !partial) return false;
+
+        std::vector<Instruction> replacement;
+        auto copy_body = [&](long long copies) {
+            for (long long c = 0; c < copies; c++) {
+                std::unordered_map<std::string, std::string> renamed;
+                for (size_t i : body_positions) {
+                    Instruction inst = function[i];
+                    std::string def = inst.defined();
+                    inst.result.clear();
+                    inst.rename_operands([&](const std::string& name) {
+                        auto it = renamed.find(name);
+                        return it != renamed.end() ? it->second : name;
+                    });
+                    inst.result = def;
+                    if (is_temp(def)) {
+                        inst.result = renamed[def] = new_temp();
+                    }
+                    replacement.push_back(inst);
+                }
+            }
+        };
+
+        const Instruction& exit_label = function[cfg.blocks[cfg.target_block(exit.label)].begin];
+        if (full) {
+            copy_body(trips);
+            if (cfg.target_block(exit.label) != h + 2) {
+                Instruction jump;
+                jump.kind = InstructionKind::Goto;
+                jump.label = exit_label.label;
+                replacement.push_back(jump);
+            }
+            stats.fully_unrolled++;
+        }
+        else {
+            // Prólogo con las iteraciones sobrantes y luego el bucle con varias copias del cuerpo
+            copy_body(trips % options.unroll_factor);
+            for (size_t i = header.begin; i < header.end; i++) replacement.push_back(function[i]);
+            copy_body(options.unroll_factor);
+            replacement.push_back(back);
+            stats.partially_unrolled++;
+        }
+
+        function.erase(function.begin() + header.begin, function.begin() + body.end);
+        function.insert(function.begin() + header.begin, replacement.begin(), replacement.end());
+        return true;
+    }
+
+    // Sección de desenrollado -> end
+};
@@ -0,0 +1,104 @@
+import sys
+import time
+
+import lexer
+import parser
+import intermediate_code
+import native_compiler
+
+"""
+    Comparación de la implementación en Python con el módulo nativo sobre el mismo corpus.
+
+    El corpus son --programs programas de ProgramGenerator de --size bytes (semillas
+    consecutivas desde --seed). Se mide cada fase por separado (Lexer, Parser, generador de
+    código intermedio) con las clases de Python y con las de native_compiler, el camino
+    completo con ambas y compile_many() con --threads hilos; cada tiempo es el menor de
+    --repeat repeticiones. Se comprueba que los dos caminos producen los mismos tokens, el
+    mismo AST y el mismo código; el proceso termina con código 1 si no coinciden.
+
+    Las fases sueltas reciben y devuelven objetos de Python (Token, diccionarios del AST,
+    listas de líneas), así que en el Parser y el generador el tiempo nativo es sobre todo
+    crear o recorrer esos objetos; el camino completo y compile_many muestran la ganancia
+    de las fases en C++.
+
+    Uso: python3 native_benchmark.py [--programs=20] [--size=4096] [--seed=1] [--threads=0]
+             [--repeat=5]
+"""
+
+def options(argv):
+    values = {'programs': 20, 'size': 4096, 'seed': 1, 'threads': 0, 'repeat': 5}
+    for arg in argv:
+        flag, _, value = arg.partition('=')
+        name = flag.lstrip('-')
+        if not flag.startswith('--') or name not in values:
+            raise SystemExit(f"Opción desconocida: {arg}")
+        values[name] = int(value)
+    return values
+
+def measure(function, corpus, repeat):
+
+    # Menor tiempo (en segundos) de aplicar la función a cada elemento del corpus, y los
+    # resultados de la última repetición
+    best = None
+    for _ in range(max(1, repeat)):
+        results = None
+        start = time.perf_counter()
+        results = [function(item) for item in corpus]
+        elapsed = time.perf_counter() - start
+        best = elapsed if best is None else min(best, elapsed)
+    return best, results
+
+def token_tuples(tokens):
+    return [(t.type, t.value, t.line, t.column) for t in tokens]
+
+def main():
+    config = options(sys.argv[1:])
+    corpus = [native_compiler.generate_program(config['seed'] + i, config['size']) for i in range(config['programs'])]
+    total_bytes = sum(len(source) for source in corpus)
+    print(f"{len(corpus)} programas, {total_bytes} bytes")
+
+    paths = {
+        'Python': (lexer.Lexer, parser.Parser, intermediate_code.IntermediateCodeGenerator),
+        'Nativo': (native_compiler.Lexer, native_compiler.Parser, native_compiler.IntermediateCodeGenerator)
+    }
+    times = {}
+    outputs = {}
+    for name, (Lexer, Parser, Generator) in paths.items():
+        repeat = config['repeat']
+        lex_time, tokens = measure(lambda source: Lexer(source).tokenizer(), corpus, repeat)
+        parse_time, asts = measure(lambda program_tokens: Parser(program_tokens).parse(), tokens, repeat)
+        generate_time, codes = measure(lambda ast: Generator().generate(ast), asts, repeat)
+        full_time, _ = measure(lambda source: Generator().generate(Parser(Lexer(source).tokenizer()).parse()), corpus,
+                               repeat)
+        times[name] = [lex_time, parse_time, generate_time, full_time]
+        outputs[name] = ([token_tuples(t) for t in tokens], asts, codes)
+
+    batch_time, batches = measure(lambda sources: native_compiler.compile_many(sources, threads=config['threads']),
+                                  [corpus], config['repeat'])
+    batch = batches[0]
+
+    mismatches = 0
+    for index, what in enumerate(['tokens', 'AST', 'código']):
+        for program, (expected, got) in enumerate(zip(outputs['Python'][index], outputs['Nativo'][index])):
+            if expected != got:
+                print(f"[FALLA] programa {program}: {what} distinto entre Python y el módulo nativo")
+                mismatches += 1
+    for program, (expected, got) in enumerate(zip(outputs['Python'][2], batch)):
+        if expected != got:
+            print(f"[FALLA] programa {program}: compile_many no coincide con Python")
+            mismatches += 1
+
+    print(f"{'Fase':<22}{'Python (s)':>12}{'Nativo (s)':>12}{'Aceleración':>14}{'MB/s nativo':>14}")
+    for row, phase in enumerate(['Lexer', 'Parser', 'Código intermedio', 'Completo']):
+        python_time, native_time = times['Python'][row], times['Nativo'][row]
+        print(f"{phase:<22}{python_time:>12.3f}{native_time:>12.3f}{python_time / native_time:>13.1f}x"
+              f"{total_bytes / native_time / 1e6:>14.2f}")
+    python_time = times['Python'][3]
+    print(f"{'compile_many':<22}{python_time:>12.3f}{batch_time:>12.3f}{python_time / batch_time:>13.1f}x"
+          f"{total_bytes / batch_time / 1e6:>14.2f}")
+
+    print(f"{mismatches} diferencias")
+    return 1 if mismatches else 0
+
+if __name__ == '__main__':
+    sys.exit(main())
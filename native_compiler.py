@@ -0,0 +1,78 @@
+from lexer import Token
+
+import _native_compiler
+
+"""
+    Reemplazo nativo de las clases de lexer.py, parser.py e intermediate_code.py.
+
+    Las clases tienen la misma interfaz y devuelven lo mismo (objetos Token, el AST en
+    diccionarios y las líneas del código intermedio), pero el trabajo lo hacen el Lexer, el
+    Parser y el IntermediateCodeGenerator de C++ a través del módulo _native_compiler, que
+    se compila con:
+
+        python3 setup.py build_ext --inplace
+
+    Para usarlo solo cuando está compilado:
+
+        try:
+            from native_compiler import Lexer, Parser, IntermediateCodeGenerator
+        except ImportError:
+            from lexer import Lexer
+            from parser import Parser
+            from intermediate_code import IntermediateCodeGenerator
+
+    compile_many() compila una lista de programas completos en paralelo sin el GIL y
+    devuelve el código intermedio de cada uno (el mismo que las tres clases en orden).
+"""
+
+class Lexer:
+    def __init__(self, code):
+        self.code = code
+        self.tokens = []
+
+    def tokenizer(self):
+
+        # Como en lexer.py, una segunda llamada devuelve los mismos tokens
+        if not self.tokens:
+            self.tokens.extend(_native_compiler.tokenize(self.code, Token))
+        return self.tokens
+
+class Parser:
+    def __init__(self, tokens):
+        self.tokens = tokens
+
+    def parse(self):
+        return _native_compiler.parse(self.tokens)
+
+class IntermediateCodeGenerator:
+    def __init__(self):
+        self.temp_count = 0
+        self.label_count = 0
+        self.code = []
+
+    def new_temp(self):
+        temp = f"%t{self.temp_count}"
+        self.temp_count += 1
+        return temp
+
+    def new_label(self):
+        label = f"L{self.label_count}"
+        self.label_count += 1
+        return label
+
+    def generate(self, ast):
+
+        # La numeración y el código siguen entre llamadas, como en intermediate_code.py
+        code, self.temp_count, self.label_count = _native_compiler.generate(ast, self.temp_count, self.label_count)
+        self.code.extend(code)
+        return self.code
+
+def compile_many(sources, threads=0, optimize=False):
+
+    # Código intermedio de cada programa; threads=0 usa un hilo por núcleo
+    return _native_compiler.compile_many(sources, threads=threads, optimize=optimize)
+
+def generate_program(seed=1, size=4096):
+
+    # Programa aleatorio reproducible de ProgramGenerator (C++), para pruebas y benchmarks
+    return _native_compiler.generate_program(seed, size)
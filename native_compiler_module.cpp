@@ -0,0 +1,670 @@
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <memory>
+#include <stdexcept>
+#include <climits>
+
+#include "compiler_pipeline.cpp"
+#include "thread_pool.cpp"
+#include "program_generator.cpp"
+
+/*
+    Módulo de extensión de CPython (_native_compiler) con las fases en C++, para usarlas
+    desde la implementación en Python (native_compiler.py lo envuelve con las mismas clases
+    que lexer.py, parser.py e intermediate_code.py). Se compila con setup.py.
+
+    Los resultados tienen la forma que producen las clases de Python:
+        tokenize(código, Token)         lista de Token(type, value, line, column)
+        parse(tokens)                   AST en diccionarios, con las mismas claves y en el
+                                        mismo orden que parser.py (los relacionales en
+                                        minúsculas: "lt", "le", ...)
+        generate(ast, temps, etiquetas) (líneas, temps, etiquetas): código intermedio de un
+                                        AST en diccionarios, numerando desde los contadores
+                                        dados (para continuar la numeración entre llamadas)
+        compile_many(fuentes, threads=0, optimize=False)
+                                        código intermedio de cada fuente, igual al de
+                                        Lexer -> Parser -> IntermediateCodeGenerator de Python
+                                        (u optimizado con optimize_code)
+        generate_program(seed, size)    programa de ProgramGenerator (para los benchmarks)
+
+    tokenize, parse y generate sueltan el GIL mientras trabajan las fases en C++; compile_many
+    lo suelta durante todo el lote y reparte los programas en un ThreadPool. Los errores del
+    lexer y del parser se lanzan como SyntaxError con el mismo mensaje que en Python.
+
+    Fuera de las fases en C++, el tiempo de tokenize y parse está en crear los Token y los
+    diccionarios, y el de generate en leer el AST: las claves y los valores que se repiten
+    (tipos, operadores, palabras clave) son cadenas creadas una sola vez, y el AST leído se
+    escribe directamente en las estructuras del generador.
+
+    El lexer de C++ trabaja sobre bytes UTF-8: para fuentes ASCII (todo el lenguaje) los
+    tokens son idénticos; un carácter no ASCII fuera de un comentario produce un token
+    UNKNOWN por byte en vez de uno por carácter.
+*/
+
+// Error de Python ya establecido con PyErr_*; se propaga hasta la función del módulo
+struct PythonError {};
+
+// Referencia a un objeto de Python que se libera al salir del ámbito
+class Reference {
+public:
+    explicit Reference(PyObject* object = nullptr) : object(object) {}
+    ~Reference() { Py_XDECREF(object); }
+    Reference(const Reference&) = delete;
+    Reference& operator=(const Reference&) = delete;
+
+    PyObject* get() const { return object; }
+
+    void reset(PyObject* replacement) {
+        Py_XDECREF(object);
+        object = replacement;
+    }
+
+    // Cede la referencia a quien la recibe
+    PyObject* release() {
+        PyObject* result = object;
+        object = nullptr;
+        return result;
+    }
+
+private:
+    PyObject* object;
+};
+
+static PyObject* checked(PyObject* object) {
+    if (!object) throw PythonError();
+    return object;
+}
+
+static PyObject* text(const std::string& value) {
+    return checked(PyUnicode_DecodeUTF8(value.data(), static_cast<Py_ssize_t>(value.size()), "replace"));
+}
+
+static std::string utf8(PyObject* object, const char* what) {
+    Py_ssize_t size = 0;
+    const char* data = PyUnicode_AsUTF8AndSize(object, &size);
+    if (!data) {
+        PyErr_Format(PyExc_TypeError, "%s debe ser str", what);
+        throw PythonError();
+    }
+    return std::string(data, static_cast<size_t>(size));
+}
+
+// Claves de los diccionarios del AST; sus cadenas se crean al importar el módulo
+enum Key {
+    TYPE, OP, LEFT, RIGHT, OPERAND, NAME, VALUE, ARGS, VAR_TYPE, VAR_NAME, INIT, TARGET, EXPR, CONDITION,
+    IF_BODY, ELSE_BODY, BODY, STEP, PARAMETERS, FUNCTIONS, LINE, COLUMN, KEY_COUNT
+};
+
+static const char* const key_names[KEY_COUNT] = {
+    "type", "op", "left", "right", "operand", "name", "value", "args", "var_type", "var_name", "init", "target",
+    "expr", "condition", "if_body", "else_body", "body", "step", "parameters", "functions", "line", "column"
+};
+
+static PyObject* keys[KEY_COUNT];
+
+// Cadena de Python creada una sola vez (tipos de nodo y de token, operadores); devuelve una
+// referencia nueva. Solo se llama con el GIL tomado.
+static PyObject* interned(const std::string& value) {
+    static std::unordered_map<std::string, PyObject*> cache;
+    auto found = cache.find(value);
+    if (found == cache.end()) {
+        PyObject* object = text(value);
+        PyUnicode_InternInPlace(&object);
+        found = cache.emplace(value, object).first;
+    }
+    Py_INCREF(found->second);
+    return found->second;
+}
+
+// Convierte cualquier error de C++ en una excepción de Python
+template <typename Body>
+static PyObject* guarded(PyObject* error_type, Body body) {
+    try {
+        return body();
+    }
+    catch (const PythonError&) {
+        return nullptr;
+    }
+    catch (const std::out_of_range& e) {
+        PyErr_SetString(PyExc_OverflowError, e.what());
+        return nullptr;
+    }
+    catch (const std::exception& e) {
+        PyErr_SetString(error_type, e.what());
+        return nullptr;
+    }
+}
+
+// Sección de diccionarios -> begin
+
+class Dictionary {
+public:
+    Dictionary() : object(checked(PyDict_New())) {}
+
+    Dictionary& set(Key key, PyObject* value) {
+        Reference owned(value);
+        if (PyDict_SetItem(object.get(), keys[key], value) != 0) throw PythonError();
+        return *this;
+    }
+
+    Dictionary& set(Key key, const std::string& value) {
+        return set(key, text(value));
+    }
+
+    // Valores que se repiten en todo el AST (tipos y operadores)
+    Dictionary& set_name(Key key, const std::string& value) {
+        return set(key, interned(value));
+    }
+
+    PyObject* release() {
+        return object.release();
+    }
+
+private:
+    Reference object;
+};
+
+// Operadores del parser de C++ en la forma del parser de Python
+static std::string python_operator(const std::string& op) {
+    if (op == "LT") return "lt";
+    if (op == "GT") return "gt";
+    if (op == "LE") return "le";
+    if (op == "GE") return "ge";
+    return op;
+}
+
+static PyObject* expression_dict(const ExpressionNode* node);
+
+static PyObject* list_of(size_t size) {
+    return checked(PyList_New(static_cast<Py_ssize_t>(size)));
+}
+
+static PyObject* expression_list(const std::vector<ExpressionNode*>& nodes) {
+    Reference list(list_of(nodes.size()));
+    for (size_t i = 0; i < nodes.size(); i++) PyList_SET_ITEM(list.get(), i, expression_dict(nodes[i]));
+    return list.release();
+}
+
+static PyObject* expression_dict(const ExpressionNode* node) {
+    if (!node) Py_RETURN_NONE;
+    Dictionary dict;
+    dict.set_name(TYPE, node->type);
+    if (node->type == "binary") {
+        dict.set_name(OP, python_operator(node->op)).set(LEFT, expression_dict(node->left)).set(RIGHT, expression_dict(node->right));
+    }
+    else if (node->type == "unary") {
+        dict.set_name(OP, node->op).set(OPERAND, expression_dict(node->operand));
+    }
+    else if (node->type == "id") {
+        dict.set(NAME, node->value.id_name);
+    }
+    else if (node->type == "number") {
+        dict.set(VALUE, checked(PyLong_FromLong(node->value.int_val)));
+    }
+    else if (node->type == "boolean") {
+        dict.set(VALUE, PyBool_FromLong(node->value.bool_val));
+    }
+    else if (node->type == "call") {
+        dict.set(NAME, node->value.id_name).set(ARGS, expression_list(node->args));
+    }
+    return dict.release();
+}
+
+static PyObject* statement_dict(const StatementNode* node);
+
+static PyObject* statement_list(const std::vector<StatementNode*>& nodes) {
+    Reference list(list_of(nodes.size()));
+    for (size_t i = 0; i < nodes.size(); i++) PyList_SET_ITEM(list.get(), i, statement_dict(nodes[i]));
+    return list.release();
+}
+
+static PyObject* statement_dict(const StatementNode* node) {
+    if (!node) Py_RETURN_NONE;
+    Dictionary dict;
+    dict.set_name(TYPE, node->type);
+    if (auto n = dynamic_cast<const DeclarationNode*>(node)) {
+        dict.set_name(VAR_TYPE, n->var_type).set(VAR_NAME, n->var_name);
+        if (n->init) dict.set(INIT, expression_dict(n->init));
+    }
+    else if (auto n = dynamic_cast<const AssignmentNode*>(node)) {
+        dict.set(TARGET, n->target).set(EXPR, expression_dict(n->expr));
+    }
+    else if (auto n = dynamic_cast<const IfNode*>(node)) {
+        dict.set(CONDITION, expression_dict(n->condition))
+            .set(IF_BODY, statement_list(n->if_body))
+            .set(ELSE_BODY, statement_list(n->else_body));
+    }
+    else if (auto n = dynamic_cast<const WhileNode*>(node)) {
+        dict.set(CONDITION, expression_dict(n->condition)).set(BODY, statement_list(n->body));
+    }
+    else if (auto n = dynamic_cast<const DoWhileNode*>(node)) {
+        dict.set(CONDITION, expression_dict(n->condition)).set(BODY, statement_list(n->body));
+    }
+    else if (auto n = dynamic_cast<const ForNode*>(node)) {
+        dict.set(INIT, statement_dict(n->init))
+            .set(CONDITION, expression_dict(n->condition))
+            .set(STEP, statement_dict(n->step))
+            .set(BODY, statement_list(n->body));
+    }
+    else if (auto n = dynamic_cast<const ReturnNode*>(node)) {
+        dict.set(EXPR, expression_dict(n->expr));
+    }
+    else if (auto n = dynamic_cast<const CallNode*>(node)) {
+        dict.set(EXPR, expression_dict(n->call));
+    }
+    return dict.release();
+}
+
+static PyObject* program_dict(const ProgramNode* program) {
+    Reference functions(list_of(program->functions.size()));
+    for (size_t f = 0; f < program->functions.size(); f++) {
+        const FunctionNode* node = program->functions[f];
+        Reference parameters(list_of(node->parameters.size()));
+        for (size_t p = 0; p < node->parameters.size(); p++) {
+            Dictionary parameter;
+            parameter.set_name(VAR_TYPE, node->parameters[p].var_type).set(VAR_NAME, node->parameters[p].var_name);
+            PyList_SET_ITEM(parameters.get(), p, parameter.release());
+        }
+        Dictionary function;
+        function.set_name(TYPE, "function")
+            .set(NAME, node->name)
+            .set(PARAMETERS, parameters.release())
+            .set(BODY, statement_list(node->body));
+        PyList_SET_ITEM(functions.get(), f, function.release());
+    }
+    Dictionary dict;
+    dict.set_name(TYPE, "program").set(FUNCTIONS, functions.release());
+    return dict.release();
+}
+
+// Sección de diccionarios -> end
+
+// Sección de conversión a las estructuras del generador -> begin
+
+// Valor de una clave obligatoria (KeyError si falta, como en intermediate_code.py)
+static PyObject* item(PyObject* dict, Key key) {
+    if (!PyDict_Check(dict)) {
+        PyErr_Format(PyExc_TypeError, "Se esperaba un diccionario del AST con la clave '%s'", key_names[key]);
+        throw PythonError();
+    }
+    PyObject* value = PyDict_GetItemWithError(dict, keys[key]);
+    if (!value) {
+        if (!PyErr_Occurred()) PyErr_SetObject(PyExc_KeyError, keys[key]);
+        throw PythonError();
+    }
+    return value;
+}
+
+// Valor de una clave opcional; nullptr si falta o es None
+static PyObject* optional_item(PyObject* dict, Key key) {
+    if (!PyDict_Check(dict)) return nullptr;
+    PyObject* value = PyDict_GetItemWithError(dict, keys[key]);
+    if (!value && PyErr_Occurred()) throw PythonError();
+    return (value && value != Py_None) ? value : nullptr;
+}
+
+// Copia el texto de una clave obligatoria en target (sin crear una cadena intermedia)
+static void read_string(PyObject* dict, Key key, std::string& target) {
+    Py_ssize_t size = 0;
+    const char* data = PyUnicode_AsUTF8AndSize(item(dict, key), &size);
+    if (!data) {
+        PyErr_Format(PyExc_TypeError, "%s debe ser str", key_names[key]);
+        throw PythonError();
+    }
+    target.assign(data, static_cast<size_t>(size));
+}
+
+static std::string string_item(PyObject* dict, Key key) {
+    std::string value;
+    read_string(dict, key, value);
+    return value;
+}
+
+// Las estructuras se llenan en su lugar (sin devolverlas por valor y moverlas a su padre):
+// la conversión recorre cada nodo una vez y es la mayor parte del tiempo de generate()
+static void to_expression(PyObject* dict, Expression& expr);
+
+static std::shared_ptr<Expression> expression_item(PyObject* dict, Key key) {
+    auto expr = std::make_shared<Expression>();
+    to_expression(item(dict, key), *expr);
+    return expr;
+}
+
+static void to_expression(PyObject* dict, Expression& expr) {
+    if (!dict || dict == Py_None) return; // Condición omitida de un for
+    read_string(dict, TYPE, expr.type);
+    if (expr.type == "binary") {
+        read_string(dict, OP, expr.op);
+        expr.left = expression_item(dict, LEFT);
+        expr.right = expression_item(dict, RIGHT);
+    }
+    else if (expr.type == "unary") {
+        read_string(dict, OP, expr.op);
+        expr.operand = expression_item(dict, OPERAND);
+    }
+    else if (expr.type == "id") {
+        read_string(dict, NAME, expr.name);
+    }
+    else if (expr.type == "number") {
+        int overflow = 0;
+        long value = PyLong_AsLongAndOverflow(item(dict, VALUE), &overflow);
+        if (value == -1 && PyErr_Occurred()) throw PythonError();
+        if (overflow || value < INT_MIN || value > INT_MAX) {
+            PyErr_SetString(PyExc_OverflowError, "El número no entra en un int del generador de C++");
+            throw PythonError();
+        }
+        expr.value = static_cast<int>(value);
+    }
+    else if (expr.type == "boolean") {
+        int truth = PyObject_IsTrue(item(dict, VALUE));
+        if (truth < 0) throw PythonError();
+        expr.value = truth;
+    }
+    else if (expr.type == "call") {
+        read_string(dict, NAME, expr.name);
+        PyObject* args = item(dict, ARGS);
+        Reference sequence(checked(PySequence_Fast(args, "args debe ser una lista")));
+        expr.args.resize(static_cast<size_t>(PySequence_Fast_GET_SIZE(sequence.get())));
+        for (size_t i = 0; i < expr.args.size(); i++) {
+            to_expression(PySequence_Fast_GET_ITEM(sequence.get(), i), expr.args[i]);
+        }
+    }
+}
+
+static void to_statement(PyObject* dict, Statement& stmt);
+
+static void to_body(PyObject* list, std::vector<Statement>& body) {
+    if (!list || list == Py_None) return;
+    Reference sequence(checked(PySequence_Fast(list, "el cuerpo debe ser una lista")));
+    body.resize(static_cast<size_t>(PySequence_Fast_GET_SIZE(sequence.get())));
+    for (size_t i = 0; i < body.size(); i++) {
+        to_statement(PySequence_Fast_GET_ITEM(sequence.get(), i), body[i]);
+    }
+}
+
+static std::shared_ptr<Statement> optional_statement(PyObject* dict, Key key) {
+    PyObject* value = optional_item(dict, key);
+    if (!value) return nullptr;
+    auto stmt = std::make_shared<Statement>();
+    to_statement(value, *stmt);
+    return stmt;
+}
+
+static void to_statement(PyObject* dict, Statement& stmt) {
+    read_string(dict, TYPE, stmt.type);
+    if (stmt.type == "declaration") {
+        read_string(dict, VAR_NAME, stmt.target);
+        to_expression(optional_item(dict, INIT), stmt.expr);
+    }
+    else if (stmt.type == "assignment") {
+        read_string(dict, TARGET, stmt.target);
+        to_expression(item(dict, EXPR), stmt.expr);
+    }
+    else if (stmt.type == "if") {
+        to_expression(item(dict, CONDITION), stmt.condition);
+        to_body(item(dict, IF_BODY), stmt.if_body);
+        to_body(optional_item(dict, ELSE_BODY), stmt.else_body);
+    }
+    else if (stmt.type == "while" || stmt.type == "do_while") {
+        to_expression(item(dict, CONDITION), stmt.condition);
+        to_body(item(dict, BODY), stmt.body);
+    }
+    else if (stmt.type == "for") {
+        stmt.init = optional_statement(dict, INIT);
+        to_expression(optional_item(dict, CONDITION), stmt.condition);
+        stmt.increment = optional_statement(dict, STEP);
+        to_body(item(dict, BODY), stmt.body);
+    }
+    else if (stmt.type == "return" || stmt.type == "call") {
+        to_expression(item(dict, EXPR), stmt.expr);
+    }
+}
+
+static std::vector<Function> to_functions(PyObject* ast) {
+    std::vector<Function> functions;
+    Reference sequence(checked(PySequence_Fast(item(ast, FUNCTIONS), "functions debe ser una lista")));
+    for (Py_ssize_t f = 0; f < PySequence_Fast_GET_SIZE(sequence.get()); f++) {
+        PyObject* node = PySequence_Fast_GET_ITEM(sequence.get(), f);
+        Function function;
+        function.name = string_item(node, NAME);
+        if (PyObject* parameters = optional_item(node, PARAMETERS)) {
+            Reference list(checked(PySequence_Fast(parameters, "parameters debe ser una lista")));
+            for (Py_ssize_t p = 0; p < PySequence_Fast_GET_SIZE(list.get()); p++) {
+                function.parameters.push_back(string_item(PySequence_Fast_GET_ITEM(list.get(), p), VAR_NAME));
+            }
+        }
+        to_body(item(node, BODY), function.body);
+        functions.push_back(std::move(function));
+    }
+    return functions;
+}
+
+// Cambia los relacionales de una Function convertida del parser de C++ a la forma de Python
+static void to_python_operators(Expression& expr) {
+    expr.op = python_operator(expr.op);
+    if (expr.left) to_python_operators(*expr.left);
+    if (expr.right) to_python_operators(*expr.right);
+    if (expr.operand) to_python_operators(*expr.operand);
+    for (auto& arg : expr.args) to_python_operators(arg);
+}
+
+static void to_python_operators(Statement& stmt) {
+    to_python_operators(stmt.expr);
+    to_python_operators(stmt.condition);
+    for (auto& inner : stmt.if_body) to_python_operators(inner);
+    for (auto& inner : stmt.else_body) to_python_operators(inner);
+    for (auto& inner : stmt.body) to_python_operators(inner);
+    if (stmt.init) to_python_operators(*stmt.init);
+    if (stmt.increment) to_python_operators(*stmt.increment);
+}
+
+// Sección de conversión a las estructuras del generador -> end
+
+static std::vector<std::string> compile_python(const std::string& source, bool optimize) {
+    Lexer lexer(source);
+    Parser parser(lexer.tokenizer());
+    std::unique_ptr<ProgramNode> ast(parser.parse());
+    std::vector<Function> functions = convert_program(ast.get());
+    for (auto& function : functions) {
+        for (auto& stmt : function.body) to_python_operators(stmt);
+    }
+    IntermediateCodeGenerator generator;
+    std::vector<std::string> code = generator.generate(functions);
+    return optimize ? optimize_code(code) : code;
+}
+
+static PyObject* string_list(const std::vector<std::string>& lines) {
+    Reference list(list_of(lines.size()));
+    for (size_t i = 0; i < lines.size(); i++) PyList_SET_ITEM(list.get(), i, text(lines[i]));
+    return list.release();
+}
+
+static PyObject* tokenize(PyObject*, PyObject* args) {
+    PyObject* source;
+    PyObject* token_class;
+    if (!PyArg_ParseTuple(args, "UO:tokenize", &source, &token_class)) return nullptr;
+    return guarded(PyExc_SyntaxError, [&]() -> PyObject* {
+        std::string code = utf8(source, "el código");
+        std::vector<Token> tokens;
+        std::string error;
+        Py_BEGIN_ALLOW_THREADS
+        try {
+            Lexer lexer(code);
+            tokens = lexer.tokenizer();
+        }
+        catch (const std::exception& e) {
+            error = e.what();
+        }
+        Py_END_ALLOW_THREADS
+        if (!error.empty()) throw std::runtime_error(error);
+
+        // Los valores de operadores y palabras clave se repiten en todo el programa y se crean
+        // una sola vez; cada Token se crea con vectorcall, sin armar una tupla de argumentos
+        Reference list(list_of(tokens.size()));
+        for (size_t i = 0; i < tokens.size(); i++) {
+            const Token& token = tokens[i];
+            bool word = token.type == "ID" || token.type == "INT" || token.type == "UNKNOWN";
+            Reference type(interned(token.type));
+            Reference value(word ? text(token.value) : interned(token.value));
+            Reference line(checked(PyLong_FromLong(token.line)));
+            Reference column(checked(PyLong_FromLong(token.column)));
+            PyObject* fields[] = {type.get(), value.get(), line.get(), column.get()};
+            PyList_SET_ITEM(list.get(), i, checked(PyObject_Vectorcall(token_class, fields, 4, nullptr)));
+        }
+        return list.release();
+    });
+}
+
+static PyObject* parse(PyObject*, PyObject* args) {
+    PyObject* token_objects;
+    if (!PyArg_ParseTuple(args, "O:parse", &token_objects)) return nullptr;
+    return guarded(PyExc_SyntaxError, [&]() -> PyObject* {
+        Reference sequence(checked(PySequence_Fast(token_objects, "tokens debe ser una lista")));
+        std::vector<Token> tokens;
+        tokens.reserve(static_cast<size_t>(PySequence_Fast_GET_SIZE(sequence.get())));
+        for (Py_ssize_t i = 0; i < PySequence_Fast_GET_SIZE(sequence.get()); i++) {
+            PyObject* token = PySequence_Fast_GET_ITEM(sequence.get(), i);
+            Reference type(checked(PyObject_GetAttr(token, keys[TYPE])));
+            Reference value(checked(PyObject_GetAttr(token, keys[VALUE])));
+            Reference line(checked(PyObject_GetAttr(token, keys[LINE])));
+            Reference column(checked(PyObject_GetAttr(token, keys[COLUMN])));
+            long line_number = PyLong_AsLong(line.get());
+            long column_number = PyLong_AsLong(column.get());
+            if (PyErr_Occurred()) throw PythonError();
+            tokens.emplace_back(utf8(type.get(), "Token.type"), utf8(value.get(), "Token.value"),
+                                static_cast<int>(line_number), static_cast<int>(column_number));
+        }
+
+        std::unique_ptr<ProgramNode> ast;
+        std::string error;
+        bool overflow = false;
+        Py_BEGIN_ALLOW_THREADS
+        try {
+            Parser parser(std::move(tokens));
+            ast.reset(parser.parse());
+        }
+        catch (const std::out_of_range& e) {
+            error = e.what();
+            overflow = true;
+        }
+        catch (const std::exception& e) {
+            error = e.what();
+        }
+        Py_END_ALLOW_THREADS
+        if (overflow) throw std::out_of_range(error);
+        if (!ast) throw std::runtime_error(error);
+        return program_dict(ast.get());
+    });
+}
+
+static PyObject* generate(PyObject*, PyObject* args) {
+    PyObject* ast;
+    int temps = 0, labels = 0;
+    if (!PyArg_ParseTuple(args, "O|ii:generate", &ast, &temps, &labels)) return nullptr;
+    return guarded(PyExc_RuntimeError, [&]() -> PyObject* {
+        std::vector<Function> functions = to_functions(ast);
+        IntermediateCodeGenerator generator(temps, labels);
+        std::vector<std::string> code;
+        std::string error;
+        Py_BEGIN_ALLOW_THREADS
+        try {
+            code = generator.generate(functions);
+        }
+        catch (const std::exception& e) {
+            error = e.what();
+        }
+        Py_END_ALLOW_THREADS
+        if (!error.empty()) throw std::runtime_error(error);
+        Reference lines(string_list(code));
+        return checked(Py_BuildValue("(Nii)", lines.release(), generator.temps_created(), generator.labels_created()));
+    });
+}
+
+static PyObject* compile_many(PyObject*, PyObject* args, PyObject* kwargs) {
+    static const char* keywords[] = {"sources", "threads", "optimize", nullptr};
+    PyObject* source_objects;
+    unsigned threads = 0;
+    int optimize = 0;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|Ip:compile_many", const_cast<char**>(keywords), &source_objects,
+                                     &threads, &optimize)) {
+        return nullptr;
+    }
+    return guarded(PyExc_SyntaxError, [&]() -> PyObject* {
+        Reference sequence(checked(PySequence_Fast(source_objects, "sources debe ser una lista")));
+        std::vector<std::string> sources;
+        for (Py_ssize_t i = 0; i < PySequence_Fast_GET_SIZE(sequence.get()); i++) {
+            sources.push_back(utf8(PySequence_Fast_GET_ITEM(sequence.get(), i), "cada fuente"));
+        }
+
+        // Sin el GIL: cada tarea escribe solo sus posiciones de results y errors
+        std::vector<std::vector<std::string>> results(sources.size());
+        std::vector<std::string> errors(sources.size());
+        Py_BEGIN_ALLOW_THREADS
+        {
+            ThreadPool pool(threads);
+            size_t chunk = std::max<size_t>(1, sources.size() / (pool.size() * 16));
+            for (size_t first = 0; first < sources.size(); first += chunk) {
+                size_t last = std::min(sources.size(), first + chunk);
+                pool.submit([&, first, last] {
+                    for (size_t i = first; i < last; i++) {
+                        try {
+                            results[i] = compile_python(sources[i], optimize != 0);
+                        }
+                        catch (const std::exception& e) {
+                            errors[i] = e.what();
+                            if (errors[i].empty()) errors[i] = "error";
+                        }
+                    }
+                });
+            }
+            pool.wait();
+        }
+        Py_END_ALLOW_THREADS
+
+        for (size_t i = 0; i < errors.size(); i++) {
+            if (!errors[i].empty()) throw std::runtime_error("programa " + std::to_string(i) + ": " + errors[i]);
+        }
+        Reference list(list_of(results.size()));
+        for (size_t i = 0; i < results.size(); i++) PyList_SET_ITEM(list.get(), i, string_list(results[i]));
+        return list.release();
+    });
+}
+
+static PyObject* generate_program(PyObject*, PyObject* args) {
+    unsigned long long seed = 1;
+    Py_ssize_t size = 4096;
+    if (!PyArg_ParseTuple(args, "|Kn:generate_program", &seed, &size)) return nullptr;
+    return guarded(PyExc_RuntimeError, [&]() -> PyObject* {
+        ProgramGenerator::Options options;
+        options.seed = seed;
+        return text(ProgramGenerator(options).generate_bytes(static_cast<size_t>(size)));
+    });
+}
+
+static PyMethodDef methods[] = {
+    {"tokenize", tokenize, METH_VARARGS, "tokenize(código, Token) -> lista de Token"},
+    {"parse", parse, METH_VARARGS, "parse(tokens) -> AST en diccionarios"},
+    {"generate", generate, METH_VARARGS, "generate(ast, temps=0, etiquetas=0) -> (líneas, temps, etiquetas)"},
+    {"compile_many", reinterpret_cast<PyCFunction>(reinterpret_cast<void (*)(void)>(compile_many)),
+     METH_VARARGS | METH_KEYWORDS, "compile_many(fuentes, threads=0, optimize=False) -> lista de códigos"},
+    {"generate_program", generate_program, METH_VARARGS, "generate_program(seed=1, size=4096) -> str"},
+    {nullptr, nullptr, 0, nullptr}
+};
+
+static PyModuleDef module_definition = {
+    PyModuleDef_HEAD_INIT, "_native_compiler", "Fases del compilador en C++ para la implementación en Python", -1,
+    methods, nullptr, nullptr, nullptr, nullptr
+};
+
+PyMODINIT_FUNC PyInit__native_compiler() {
+    for (int key = 0; key < KEY_COUNT; key++) {
+        if (!keys[key]) keys[key] = PyUnicode_InternFromString(key_names[key]);
+        if (!keys[key]) return nullptr;
+    }
+    return PyModule_Create(&module_definition);
+}
@@ -1,3 +1,5 @@
+#pragma once
+
 #include <iostream>
 #include <vector>
 #include <string>
@@ -16,6 +18,7 @@ struct WhileNode;
 struct DoWhileNode;
 struct ForNode;
 struct ReturnNode;
+struct CallNode;
 struct ExpressionNode;
 
 // Union to hold different expression values
@@ -28,19 +31,28 @@ struct Value {
 
 // Expression Node
 struct ExpressionNode {
-    std::string type; // "binary", "unary", "id", "number", "boolean"
+    std::string type; // "binary", "unary", "id", "number", "boolean", "call"
     std::string op;    // "+", "-", "*", "/", "==", "!=", "<", ">", "<=", ">=", "&&", "||", "!", "-"
-    Value value;
+    Value value;       // For calls, value.id_name is the function name
     ExpressionNode* left;   // For binary expressions
     ExpressionNode* right;  // For binary expressions
     ExpressionNode* operand; // For unary expressions
+    std::vector<ExpressionNode*> args; // For call expressions
 
     ExpressionNode() : left(nullptr), right(nullptr), operand(nullptr) {}
+    ~ExpressionNode() {
+        delete left;
+        delete right;
+        delete operand;
+        for (auto arg : args) delete arg;
+    }
 };
 
 // Statement Node (Base class for all statements)
 struct StatementNode {
     std::string type; // "declaration", "assignment", "if", "while", "do_while", "for", "return"
+    int line = 0;     // Position of the first token of the statement
+    int column = 0;
     virtual ~StatementNode() {}
 };
 
@@ -125,11 +137,28 @@ struct ReturnNode : public StatementNode {
     ~ReturnNode() { delete expr; }
 };
 
+// Call Node (function call used as a statement)
+struct CallNode : public StatementNode {
+    ExpressionNode* call; // Expression of type "call"
+
+    CallNode() : call(nullptr) { type = "call"; }
+    ~CallNode() { delete call; }
+};
+
+// Parameter of a function
+struct ParameterNode {
+    std::string var_type; // "INT_TYPE", "BOOL_TYPE"
+    std::string var_name;
+};
+
 // Function Node
 struct FunctionNode {
     std::string type; // "function"
     std::string name;
+    std::vector<ParameterNode> parameters;
     std::vector<StatementNode*> body;
+    int line = 0;     // Position of the "function" keyword
+    int column = 0;
 
     FunctionNode() { type = "function"; }
     ~FunctionNode() {
@@ -150,8 +179,10 @@ struct ProgramNode {
 
 class Parser {
 public:
-    Parser(std::vector<Token> tokens) : tokens(tokens), token_index(-1), current_token(nullptr) {
-        advance();
+    Parser(std::vector<Token> tokens) : tokens(std::move(tokens)), token_index(0), current_token(nullptr) {
+        if (!this->tokens.empty()) {
+            current_token = &this->tokens[0];
+        }
     }
 
     ~Parser() {}
@@ -162,7 +193,7 @@ public:
 
 private:
     std::vector<Token> tokens;
-    int token_index;
+    size_t token_index; // Posición de current_token en tokens
     Token* current_token;
 
     void advance() {
@@ -175,7 +206,15 @@ private:
         }
     }
 
-    void eat(std::string token_type) {
+    Token* peek() {
+        // Token siguiente al actual, sin consumirlo
+        if (token_index + 1 < tokens.size()) {
+            return &tokens[token_index + 1];
+        }
+        return nullptr;
+    }
+
+    void eat(const std::string& token_type) {
         if (current_token && current_token->type == token_type) {
             advance();
         }
@@ -194,10 +233,22 @@ private:
 
     FunctionNode* function() {
         FunctionNode* node = new FunctionNode();
+        node->line = current_token->line;
+        node->column = current_token->column;
         eat("FUNCTION");
         node->name = current_token->value;
         eat("ID");
         eat("LPAREN");
+
+        // Parameters (optional): type name {, type name}
+        if (current_token && current_token->type != "RPAREN") {
+            node->parameters.push_back(parameter());
+            while (current_token && current_token->type == "COMMA") {
+                eat("COMMA");
+                node->parameters.push_back(parameter());
+            }
+        }
+
         eat("RPAREN");
         eat("LBRACE");
 
@@ -209,10 +260,39 @@ private:
         return node;
     }
 
+    ParameterNode parameter() {
+        ParameterNode param;
+        if (!current_token || (current_token->type != "INT_TYPE" && current_token->type != "BOOL_TYPE")) {
+            throw std::runtime_error("Se esperaba el tipo del parámetro, se encontró " + (current_token ? current_token->type : "EOF"));
+        }
+        param.var_type = current_token->type;
+        eat(param.var_type);
+
+        param.var_name = current_token ? current_token->value : "";
+        eat("ID");
+        return param;
+    }
+
     StatementNode* statement() {
+        // Se guarda dónde empieza la declaración para relacionar el código generado con el fuente
+        const Token& start = *current_token;
+        return located(statement_node(), start);
+    }
+
+    template <typename Node>
+    static Node* located(Node* node, const Token& start) {
+        node->line = start.line;
+        node->column = start.column;
+        return node;
+    }
+
+    StatementNode* statement_node() {
         if (current_token->type == "INT_TYPE" || current_token->type == "BOOL_TYPE") {
             return declaration();
         }
+        else if (current_token->type == "ID" && peek() && peek()->type == "LPAREN") {
+            return call_statement();
+        }
         else if (current_token->type == "ID") {
             return assignment();
         }
@@ -255,14 +335,17 @@ private:
         return node;
     }
 
-    AssignmentNode* assignment() {
+    // El paso de un for es una asignación sin ';' antes del ')'
+    AssignmentNode* assignment(bool semicolon = true) {
         AssignmentNode* node = new AssignmentNode();
         node->target = current_token->value;
         eat("ID");
         eat("ASSIGN");
 
         node->expr = expression();
-        eat("SEMICOLON");
+        if (semicolon) {
+            eat("SEMICOLON");
+        }
 
         return node;
     }
@@ -333,11 +416,12 @@ private:
         eat("LPAREN");
 
         // Initialization (optional)
+        Token start = *current_token;
         if (current_token->type == "INT_TYPE" || current_token->type == "BOOL_TYPE") {
-            node->init = declaration();
+            node->init = located(declaration(), start);
         }
         else if (current_token->type == "ID") {
-            node->init = assignment();
+            node->init = located(assignment(), start);
         }
         else {
             eat("SEMICOLON");
@@ -351,7 +435,8 @@ private:
 
         // Step (optional)
         if (current_token->type != "RPAREN") {
-            node->step = assignment();
+            start = *current_token;
+            node->step = located(assignment(false), start);
         }
         eat("RPAREN");
 
@@ -373,6 +458,34 @@ private:
         return node;
     }
 
+    CallNode* call_statement() {
+        CallNode* node = new CallNode();
+        node->call = call();
+        eat("SEMICOLON");
+
+        return node;
+    }
+
+    ExpressionNode* call() {
+        ExpressionNode* node = new ExpressionNode();
+        node->type = "call";
+        node->value.id_name = current_token->value;
+        eat("ID");
+        eat("LPAREN");
+
+        // Arguments (optional): expression {, expression}
+        if (current_token && current_token->type != "RPAREN") {
+            node->args.push_back(expression());
+            while (current_token && current_token->type == "COMMA") {
+                eat("COMMA");
+                node->args.push_back(expression());
+            }
+        }
+        eat("RPAREN");
+
+        return node;
+    }
+
     ExpressionNode* expression() {
         return logical_or();
     }
@@ -489,7 +602,10 @@ private:
     ExpressionNode* primary() {
         Token* token = current_token;
 
-        if (token->type == "ID") {
+        if (token->type == "ID" && peek() && peek()->type == "LPAREN") {
+            return call();
+        }
+        else if (token->type == "ID") {
             eat("ID");
             ExpressionNode* node = new ExpressionNode();
             node->type = "id";
@@ -520,4 +636,41 @@ private:
             throw std::runtime_error("Token inesperado: " + token->type);
         }
     }
-};
\ No newline at end of file
+};
+
+// Funciones para contar los nodos del AST (para los informes de rendimiento)
+inline size_t count_nodes(const ExpressionNode* node) {
+    if (!node) return 0;
+    size_t count = 1 + count_nodes(node->left) + count_nodes(node->right) + count_nodes(node->operand);
+    for (const ExpressionNode* arg : node->args) count += count_nodes(arg);
+    return count;
+}
+
+inline size_t count_nodes(const StatementNode* node);
+
+inline size_t count_nodes(const std::vector<StatementNode*>& body) {
+    size_t count = 0;
+    for (const StatementNode* stmt : body) count += count_nodes(stmt);
+    return count;
+}
+
+// Función para contar los nodos de una declaración y de todo lo que contiene
+inline size_t count_nodes(const StatementNode* node) {
+    if (!node) return 0;
+    size_t count = 1;
+    if (auto n = dynamic_cast<const DeclarationNode*>(node)) count += count_nodes(n->init);
+    else if (auto n = dynamic_cast<const AssignmentNode*>(node)) count += count_nodes(n->expr);
+    else if (auto n = dynamic_cast<const IfNode*>(node)) count += count_nodes(n->condition) + count_nodes(n->if_body) + count_nodes(n->else_body);
+    else if (auto n = dynamic_cast<const WhileNode*>(node)) count += count_nodes(n->condition) + count_nodes(n->body);
+    else if (auto n = dynamic_cast<const DoWhileNode*>(node)) count += count_nodes(n->condition) + count_nodes(n->body);
+    else if (auto n = dynamic_cast<const ForNode*>(node)) count += count_nodes(n->init) + count_nodes(n->condition) + count_nodes(n->step) + count_nodes(n->body);
+    else if (auto n = dynamic_cast<const ReturnNode*>(node)) count += count_nodes(n->expr);
+    else if (auto n = dynamic_cast<const CallNode*>(node)) count += count_nodes(n->call);
+    return count;
+}
+
+inline size_t count_nodes(const ProgramNode* program) {
+    size_t count = 1;
+    for (const FunctionNode* function : program->functions) count += 1 + count_nodes(function->body);
+    return count;
+}
@@ -18,6 +18,14 @@ class Parser:
         else:
             self.current_token = None
     
+    def peek(self):
+
+        # Se obtiene el token siguiente al actual sin consumirlo
+
+        if self.token_index + 1 < len(self.tokens):
+            return self.tokens[self.token_index + 1]
+        return None
+
     def eat(self, token_type):
         
         # Se consume el token actual si coincide con el tipo esperado
@@ -50,6 +58,15 @@ class Parser:
         
         self.eat('ID')  
         self.eat('LPAREN')
+
+        # Se analizan los parámetros (opcionales): tipo nombre {, tipo nombre}
+        parameters = []
+        if self.current_token and self.current_token.type != 'RPAREN':
+            parameters.append(self.parameter())
+            while self.current_token and self.current_token.type == 'COMMA':
+                self.eat('COMMA')
+                parameters.append(self.parameter())
+
         self.eat('RPAREN')
         self.eat('LBRACE')
         
@@ -60,7 +77,20 @@ class Parser:
         
         # Se consume la llave de cierre y se retorna la estructura de la función
         self.eat('RBRACE')
-        return {'type': 'function', 'name': name, 'body': statements}
+        return {'type': 'function', 'name': name, 'parameters': parameters, 'body': statements}
+
+    def parameter(self):
+
+        # Se analiza un parámetro de función (int o bool)
+
+        if not self.current_token or self.current_token.type not in ['INT_TYPE', 'BOOL_TYPE']:
+            raise SyntaxError(f"Se esperaba el tipo del parámetro, se encontró {self.current_token.type if self.current_token else 'EOF'}")
+        var_type = self.current_token.type
+        self.eat(var_type)
+
+        var_name = self.current_token.value if self.current_token else None
+        self.eat('ID')
+        return {'var_type': var_type, 'var_name': var_name}
     
     def statement(self):
 
@@ -68,6 +98,8 @@ class Parser:
         
         if self.current_token.type == 'INT_TYPE' or self.current_token.type == 'BOOL_TYPE':
             return self.declaration()
+        elif self.current_token.type == 'ID' and self.peek() and self.peek().type == 'LPAREN':
+            return self.call_statement()
         elif self.current_token.type == 'ID':
             return self.assignment()
         elif self.current_token.type == 'IF':
@@ -103,16 +135,18 @@ class Parser:
             self.eat('SEMICOLON')
             return {'type': 'declaration', 'var_type': var_type, 'var_name': var_name}
 
-    def assignment(self):
+    def assignment(self, semicolon=True):
         
         #Se analizan las asignaciones de variables
+        #(el paso de un for no lleva ';' antes del ')')
         
         var_name = self.current_token.value
         self.eat('ID')
         self.eat('ASSIGN')
         
         expr = self.expression()
-        self.eat('SEMICOLON')
+        if semicolon:
+            self.eat('SEMICOLON')
 
         return {'type': 'assignment', 'target': var_name, 'expr': expr}
 
@@ -218,7 +252,7 @@ class Parser:
         # Paso (opcional)
         step = None
         if self.current_token.type != 'RPAREN':
-            step = self.assignment()
+            step = self.assignment(False)
         self.eat('RPAREN')
         
         # Se analiza el cuerpo del for
@@ -248,6 +282,35 @@ class Parser:
         # Se retorna la estructura del return
         return {'type': 'return', 'expr': expr}
 
+    def call_statement(self):
+
+        # Se analiza una llamada a función usada como instrucción
+
+        expr = self.call()
+        self.eat('SEMICOLON')
+
+        # Se retorna la estructura de la llamada
+        return {'type': 'call', 'expr': expr}
+
+    def call(self):
+
+        # Se analiza una llamada a función: nombre(argumentos)
+
+        name = self.current_token.value
+        self.eat('ID')
+        self.eat('LPAREN')
+
+        # Se analizan los argumentos (opcionales): expresión {, expresión}
+        args = []
+        if self.current_token and self.current_token.type != 'RPAREN':
+            args.append(self.expression())
+            while self.current_token and self.current_token.type == 'COMMA':
+                self.eat('COMMA')
+                args.append(self.expression())
+        self.eat('RPAREN')
+
+        return {'type': 'call', 'name': name, 'args': args}
+
     def expression(self):
         #Se analiza una expresión completa
         #Punto de entrada para la expresión
@@ -402,7 +465,10 @@ class Parser:
         token = self.current_token
         
         # Se analiza el tipo de token
-        if token.type == 'ID':
+        if token.type == 'ID' and self.peek() and self.peek().type == 'LPAREN':
+            return self.call() # Se retorna la llamada a función
+
+        elif token.type == 'ID':
             self.eat('ID')
             return {'type': 'id', 'name': token.value} # Se retorna el token ID
         
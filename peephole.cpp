@@ -0,0 +1,259 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <functional>
+#include <algorithm>
+
+#include "ir_instruction.cpp"
+#include "control_flow.cpp"
+
+/*
+    Optimizador de mirilla (peephole) y simplificación de saltos.
+
+    La traducción de if/while/for deja muchos patrones redundantes, por ejemplo el if sin
+    else genera "GOTO L1" seguido de "L0:" y "L1:". En cada función se repiten hasta que
+    el código no cambia las siguientes simplificaciones, cada una en tiempo lineal:
+        - Etiquetas consecutivas se unen en una sola.
+        - Los saltos a una etiqueta seguida de "GOTO L" saltan directamente a L.
+        - Los saltos condicionales con condición constante se vuelven GOTO o se eliminan.
+        - "IF c GOTO L1 / GOTO L2 / L1:" se invierte a "IF_FALSE c GOTO L2 / L1:".
+        - Se eliminan los saltos a la instrucción siguiente.
+        - Se eliminan los bloques inalcanzables y las etiquetas sin referencias.
+*/
+
+class PeepholeOptimizer {
+public:
+    // Estadísticas de la última llamada a optimize()
+    struct Stats {
+        int iterations = 0;          // Iteraciones hasta el punto fijo (máximo entre funciones)
+        int removed_instructions = 0;
+        int threaded_jumps = 0;
+        int folded_branches = 0;
+        int inverted_branches = 0;
+    };
+
+    PeepholeOptimizer() {}
+
+    std::vector<std::string> optimize(const std::vector<std::string>& code) {
+        stats = Stats();
+        std::vector<Instruction> instructions = parse_instructions(code);
+
+        std::vector<Instruction> result;
+        result.reserve(instructions.size());
+        size_t copied = 0;
+        for (const auto& range : function_ranges(instructions)) {
+            // Las líneas fuera de funciones se conservan sin cambios
+            result.insert(result.end(), instructions.begin() + copied, instructions.begin() + range.first);
+            std::vector<Instruction> function(instructions.begin() + range.first, instructions.begin() + range.second);
+            size_t before = function.size();
+            optimize_function(function);
+            stats.removed_instructions += static_cast<int>(before - function.size());
+            result.insert(result.end(), function.begin(), function.end());
+            copied = range.second;
+        }
+        result.insert(result.end(), instructions.begin() + copied, instructions.end());
+        return format_instructions(result);
+    }
+
+    const Stats& last_stats() const {
+        return stats;
+    }
+
+private:
+    Stats stats;
+
+    void optimize_function(std::vector<Instruction>& function) {
+        int iterations = 0;
+        bool changed = true;
+        while (changed) {
+            iterations++;
+            changed = false;
+            changed |= thread_jumps(function);
+            changed |= fold_branches(function);
+            changed |= remove_unreachable(function);
+            changed |= remove_unused_labels(function);
+        }
+        stats.iterations = std::max(stats.iterations, iterations);
+    }
+
+    // Sección de saltos -> begin
+
+    // Función para redirigir cada salto a su destino final.
+    // Una etiqueta se resuelve a la primera etiqueta de su grupo de etiquetas consecutivas;
+    // si después del grupo hay un "GOTO M", se resuelve al destino final de M.
+    bool thread_jumps(std::vector<Instruction>& function) {
+        std::unordered_map<std::string, size_t> positions; // Etiqueta -> posición
+        for (size_t i = 0; i < function.size(); i++) {
+            if (function[i].kind == InstructionKind::Label) positions[function[i].label] = i;
+        }
+
+        std::unordered_map<std::string, std::string> resolved;
+        std::unordered_set<std::string> visiting;
+        std::function<std::string(const std::string&)> resolve = [&](const std::string& label) -> std::string {
+            auto done = resolved.find(label);
+            if (done != resolved.end()) return done->second;
+            auto it = positions.find(label);
+            if (it == positions.end() || visiting.count(label)) return label; // Ciclo de GOTOs
+            visiting.insert(label);
+
+            size_t first = it->second;
+            while (first > 0 && function[first - 1].kind == InstructionKind::Label) first--;
+            size_t next = it->second;
+            while (next < function.size() && function[next].kind == InstructionKind::Label) next++;
+
+            std::string target = function[first].label;
+            if (next < function.size() && function[next].kind == InstructionKind::Goto) {
+                target = resolve(function[next].label);
+            }
+            visiting.erase(label);
+            resolved[label] = target;
+            return target;
+        };
+
+        bool changed = false;
+        for (auto& inst : function) {
+            if (!inst.is_jump()) continue;
+            std::string target = resolve(inst.label);
+            if (target != inst.label) {
+                inst.label = target;
+                stats.threaded_jumps++;
+                changed = true;
+            }
+        }
+        return changed;
+    }
+
+    // Indica si la etiqueta está entre las etiquetas que siguen inmediatamente a la posición i
+    static bool labels_follow(const std::vector<Instruction>& function, size_t i, const std::string& label) {
+        for (size_t j = i + 1; j < function.size() && function[j].kind == InstructionKind::Label; j++) {
+            if (function[j].label == label) return true;
+        }
+        return false;
+    }
+
+    // Función para simplificar saltos condicionales y saltos a la instrucción siguiente
+    bool fold_branches(std::vector<Instruction>& function) {
+        bool changed = false;
+        std::vector<Instruction> result;
+        result.reserve(function.size());
+
+        for (size_t i = 0; i < function.size(); i++) {
+            Instruction inst = function[i];
+
+            // Condición constante: el salto siempre o nunca se toma
+            if (inst.is_conditional_jump()) {
+                long long value;
+                if (constant_condition(inst, value)) {
+                    bool taken = (inst.kind == InstructionKind::If) ? value != 0 : value == 0;
+                    stats.folded_branches++;
+                    changed = true;
+                    if (!taken) continue;
+                    inst.kind = InstructionKind::Goto;
+                    inst.arg1.clear();
+                    inst.op.clear();
+                    inst.arg2.clear();
+                }
+            }
+
+            // IF c GOTO L1 / GOTO L2 / L1:  ->  IF_FALSE c GOTO L2 / L1:
+            if (inst.is_conditional_jump() && i + 1 < function.size() &&
+                function[i + 1].kind == InstructionKind::Goto && labels_follow(function, i + 1, inst.label)) {
+                inst.kind = (inst.kind == InstructionKind::If) ? InstructionKind::IfFalse : InstructionKind::If;
+                inst.label = function[i + 1].label;
+                result.push_back(inst);
+                i++;
+                stats.inverted_branches++;
+                changed = true;
+                continue;
+            }
+
+            // Salto a la instrucción siguiente (la condición no tiene efectos secundarios)
+            if (inst.is_jump() && labels_follow(function, i, inst.label)) {
+                changed = true;
+                continue;
+            }
+
+            result.push_back(inst);
+        }
+
+        function.swap(result);
+        return changed;
+    }
+
+    static bool constant_condition(const Instruction& inst, long long& value) {
+        if (inst.op.empty()) {
+            if (!is_constant(inst.arg1)) return false;
+            value = std::stoll(inst.arg1);
+            return true;
+        }
+        if (!is_constant(inst.arg1) || !is_constant(inst.arg2)) return false;
+        return evaluate_binary(inst.op, std::stoll(inst.arg1), std::stoll(inst.arg2), value);
+    }
+
+    // Sección de saltos -> end
+
+    // Sección de limpieza -> begin
+
+    // Función para eliminar los bloques a los que no se llega desde la entrada de la función
+    bool remove_unreachable(std::vector<Instruction>& function) {
+        ControlFlowGraph cfg(function, 0, function.size());
+        if (cfg.blocks.empty()) return false;
+
+        std::vector<bool> reachable(cfg.blocks.size(), false);
+        std::vector<size_t> work = {0};
+        reachable[0] = true;
+        while (!work.empty()) {
+            size_t b = work.back();
+            work.pop_back();
+            for (size_t s : cfg.blocks[b].successors) {
+                if (!reachable[s]) {
+                    reachable[s] = true;
+                    work.push_back(s);
+                }
+            }
+        }
+
+        bool changed = false;
+        std::vector<Instruction> result;
+        result.reserve(function.size());
+        result.push_back(function.front()); // PROC
+        for (size_t b = 0; b < cfg.blocks.size(); b++) {
+            if (!reachable[b]) {
+                changed = true;
+                continue;
+            }
+            result.insert(result.end(), function.begin() + cfg.blocks[b].begin, function.begin() + cfg.blocks[b].end);
+        }
+        result.push_back(function.back()); // ENDP
+
+        function.swap(result);
+        return changed;
+    }
+
+    // Función para eliminar las etiquetas a las que ningún salto hace referencia
+    bool remove_unused_labels(std::vector<Instruction>& function) {
+        std::unordered_set<std::string> referenced;
+        for (const auto& inst : function) {
+            if (inst.is_jump()) referenced.insert(inst.label);
+        }
+
+        bool changed = false;
+        std::vector<Instruction> result;
+        result.reserve(function.size());
+        for (const auto& inst : function) {
+            if (inst.kind == InstructionKind::Label && !referenced.count(inst.label)) {
+                changed = true;
+                continue;
+            }
+            result.push_back(inst);
+        }
+
+        function.swap(result);
+        return changed;
+    }
+
+    // Sección de limpieza -> end
+};
@@ -0,0 +1,240 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <sstream>
+#include <iomanip>
+#include <chrono>
+#include <cstdint>
+#include <algorithm>
+#include <sys/resource.h>
+
+/*
+    Informe de tiempo y memoria por fase del compilador (--time-report / --mem-report).
+
+    Las fases se marcan con PhaseReport::Scope, un objeto RAII que mide desde su
+    construcción hasta su destrucción. Solo se mide mientras haya un informe activo en el
+    hilo (PhaseReport::start()); sin informe cada Scope solo compara un puntero con nullptr, así
+    que las fases pueden quedar marcadas en el código sin costo.
+
+    Cada fase guarda:
+        - Tiempo de reloj.
+        - Asignaciones y bytes asignados por operator new durante la fase, bytes que siguen
+          vivos al terminar (el resultado de la fase: los tokens, el AST o las líneas del
+          código intermedio) y el pico de memoria viva dentro de la fase. Estos datos vienen
+          de AllocationTracker y solo existen si el programa incluye tracking_allocator.cpp.
+        - Pico de memoria residente (RSS) del proceso al terminar la fase.
+        - Conteos propios de la fase (tokens, nodos, instrucciones, temporales, etiquetas).
+
+    Las fases pueden anidarse (por ejemplo cada pasada dentro de la optimización); el
+    informe las lista en el orden en que empezaron, con su profundidad.
+*/
+
+// Contadores de memoria dinámica que actualiza el operator new de tracking_allocator.cpp.
+// Son de cada hilo, como el informe activo: con varios hilos compilando a la vez cada uno
+// mide sus propias fases (un bloque liberado en otro hilo se descuenta en ese hilo).
+struct AllocationTracker {
+    static inline bool installed = false;
+    static inline thread_local uint64_t allocations = 0;
+    static inline thread_local uint64_t bytes = 0;  // Bytes asignados desde el inicio del hilo
+    static inline thread_local int64_t live = 0;    // Bytes asignados y todavía no liberados
+    static inline thread_local int64_t peak = 0;    // Máximo de live (se reinicia al empezar cada fase)
+
+    static void allocated(size_t size) {
+        allocations++;
+        bytes += size;
+        live += static_cast<int64_t>(size);
+        if (live > peak) peak = live;
+    }
+
+    static void released(size_t size) {
+        live -= static_cast<int64_t>(size);
+    }
+};
+
+class PhaseReport {
+public:
+    struct Phase {
+        std::string name;
+        int depth = 0;                 // Fases que la contienen
+        double seconds = 0;
+        uint64_t allocations = 0;
+        uint64_t allocated_bytes = 0;
+        int64_t retained_bytes = 0;    // Memoria viva al terminar menos memoria viva al empezar
+        int64_t peak_bytes = 0;        // Pico de memoria viva sobre la del inicio de la fase
+        long peak_rss = 0;             // KB
+        std::vector<std::pair<std::string, uint64_t>> counts;
+    };
+
+    // Medición de una fase, desde la construcción hasta la destrucción del objeto
+    class Scope {
+    public:
+        explicit Scope(const char* name) : report(current) {
+            if (report) begin(name);
+        }
+
+        ~Scope() {
+            if (report) end();
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+        // Indica si hay un informe activo (para no calcular conteos que no se van a usar)
+        bool enabled() const {
+            return report != nullptr;
+        }
+
+        void count(const char* what, uint64_t value) {
+            if (report) report->phase_list[index].counts.push_back({what, value});
+        }
+
+    private:
+        PhaseReport* report;
+        size_t index = 0;
+        std::chrono::steady_clock::time_point start;
+        uint64_t start_allocations = 0;
+        uint64_t start_bytes = 0;
+        int64_t start_live = 0;
+        int64_t outer_peak = 0;
+
+        void begin(const char* name) {
+            index = report->phase_list.size();
+            Phase phase;
+            phase.name = name;
+            phase.depth = report->depth++;
+            report->phase_list.push_back(phase);
+
+            // El pico se mide desde la memoria viva al empezar; el de la fase que contiene a
+            // esta se restaura al terminar
+            outer_peak = AllocationTracker::peak;
+            AllocationTracker::peak = AllocationTracker::live;
+            start_live = AllocationTracker::live;
+            start_allocations = AllocationTracker::allocations;
+            start_bytes = AllocationTracker::bytes;
+            start = std::chrono::steady_clock::now();
+        }
+
+        void end() {
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            Phase& phase = report->phase_list[index];
+            phase.seconds = seconds;
+            phase.allocations = AllocationTracker::allocations - start_allocations;
+            phase.allocated_bytes = AllocationTracker::bytes - start_bytes;
+            phase.retained_bytes = AllocationTracker::live - start_live;
+            phase.peak_bytes = AllocationTracker::peak - start_live;
+            AllocationTracker::peak = std::max(outer_peak, AllocationTracker::peak);
+
+            struct rusage usage;
+            if (getrusage(RUSAGE_SELF, &usage) == 0) phase.peak_rss = usage.ru_maxrss;
+            report->depth--;
+        }
+    };
+
+    PhaseReport() {}
+
+    ~PhaseReport() {
+        stop();
+    }
+
+    // Activa este informe: las fases que empiecen desde ahora en este hilo se registran en él
+    void start() {
+        current = this;
+    }
+
+    void stop() {
+        if (current == this) current = nullptr;
+    }
+
+    void clear() {
+        phase_list.clear();
+    }
+
+    const std::vector<Phase>& phases() const {
+        return phase_list;
+    }
+
+    // Tabla con las columnas de tiempo, de memoria o ambas
+    std::string table(bool time, bool memory) const {
+        double total = 0;
+        for (const auto& phase : phase_list) {
+            if (phase.depth == 0) total += phase.seconds;
+        }
+        bool allocations = memory && AllocationTracker::installed;
+
+        std::ostringstream out;
+        out << padded("Fase", 28);
+        if (time) out << std::setw(12) << "Tiempo (ms)" << std::setw(8) << "%";
+        if (allocations) {
+            out << std::setw(14) << "Asignaciones" << std::setw(14) << "KB asignados" << std::setw(14) << "KB retenidos"
+                << std::setw(12) << "Pico (KB)";
+        }
+        if (memory) out << std::setw(14) << "Pico RSS (KB)";
+        out << "  Conteos\n";
+
+        for (const auto& phase : phase_list) {
+            out << padded(std::string(2 * phase.depth, ' ') + phase.name, 28);
+            if (time) {
+                out << std::fixed << std::setprecision(3) << std::setw(12) << phase.seconds * 1e3 << std::setprecision(1)
+                    << std::setw(8) << (total > 0 ? 100 * phase.seconds / total : 0);
+            }
+            if (allocations) {
+                out << std::setw(14) << phase.allocations << std::setw(14) << phase.allocated_bytes / 1024
+                    << std::setw(14) << phase.retained_bytes / 1024 << std::setw(12) << phase.peak_bytes / 1024;
+            }
+            if (memory) out << std::setw(14) << phase.peak_rss;
+            out << " ";
+            for (const auto& [what, value] : phase.counts) out << " " << what << "=" << value;
+            out << "\n";
+        }
+        if (time) out << padded("Total", 28) << std::fixed << std::setprecision(3) << std::setw(12) << total * 1e3 << "\n";
+        if (memory && !AllocationTracker::installed) out << "(sin contadores de asignaciones: falta tracking_allocator.cpp)\n";
+        return out.str();
+    }
+
+    // Todas las fases en JSON; los campos de asignaciones solo si hay contadores
+    std::string to_json() const {
+        std::ostringstream out;
+        out << "{\"allocations_tracked\": " << (AllocationTracker::installed ? "true" : "false") << ", \"phases\": [";
+        for (size_t p = 0; p < phase_list.size(); p++) {
+            const Phase& phase = phase_list[p];
+            out << (p ? "," : "") << "\n  {\"name\": " << quoted(phase.name) << ", \"depth\": " << phase.depth
+                << ", \"seconds\": " << std::setprecision(9) << phase.seconds;
+            if (AllocationTracker::installed) {
+                out << ", \"allocations\": " << phase.allocations << ", \"allocated_bytes\": " << phase.allocated_bytes
+                    << ", \"retained_bytes\": " << phase.retained_bytes << ", \"peak_bytes\": " << phase.peak_bytes;
+            }
+            out << ", \"peak_rss_kb\": " << phase.peak_rss << ", \"counts\": {";
+            for (size_t c = 0; c < phase.counts.size(); c++) {
+                out << (c ? ", " : "") << quoted(phase.counts[c].first) << ": " << phase.counts[c].second;
+            }
+            out << "}}";
+        }
+        out << "\n]}";
+        return out.str();
+    }
+
+private:
+    static inline thread_local PhaseReport* current = nullptr; // Informe activo del hilo
+
+    std::vector<Phase> phase_list;
+    int depth = 0;
+
+    // Texto alineado a la izquierda en 'width' columnas (los caracteres UTF-8 ocupan una)
+    static std::string padded(const std::string& text, size_t width) {
+        size_t columns = 0;
+        for (char c : text) {
+            if ((static_cast<unsigned char>(c) & 0xC0) != 0x80) columns++;
+        }
+        return text + std::string(columns < width ? width - columns : 1, ' ');
+    }
+
+    static std::string quoted(const std::string& text) {
+        std::string result = "\"";
+        for (char c : text) {
+            if (c == '"' || c == '\\') result += '\\';
+            result += c;
+        }
+        return result + "\"";
+    }
+};
@@ -0,0 +1,346 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <random>
+#include <cstdint>
+#include <algorithm>
+
+/*
+    Generador de programas sintéticos del lenguaje, para medir el compilador con entradas
+    de cualquier tamaño.
+
+    Con la misma semilla y las mismas opciones el programa generado es siempre el mismo:
+    se usa mt19937_64 directamente (sin las distribuciones de <random>, cuyo resultado
+    depende de la biblioteca estándar).
+
+    Los programas son válidos para todas las fases, incluida la ejecución:
+        - Cada función declara con valor inicial todas sus variables al principio, así que
+          la tabla de símbolos encuentra cada nombre usado.
+        - Solo se llama a funciones definidas antes que no llaman a otras, con el número
+          correcto de argumentos: no hay recursión y el tiempo de ejecución no crece con
+          el número de funciones.
+        - Los bucles tienen un contador propio por nivel de anidamiento y un límite fijo.
+        - Los divisores son constantes distintas de cero y los literales caben en int.
+        - Los nombres (v3_abcd, p0_bcde, k1_cdef, f12_defg) no coinciden con palabras
+          clave ni con los temporales, etiquetas y registros del código intermedio.
+
+    Las opciones controlan el número de funciones y de declaraciones, la profundidad de
+    las expresiones, el anidamiento de bucles, la longitud de los identificadores y la
+    densidad de comentarios y de espacio en blanco. generate_bytes() agrega funciones
+    hasta alcanzar un tamaño dado.
+*/
+
+class ProgramGenerator {
+public:
+    struct Options {
+        uint64_t seed = 1;
+        int functions = 8;
+        int statements = 12;          // Declaraciones del nivel superior de cada función
+        int expression_depth = 3;     // Profundidad máxima de los operadores en una expresión
+        int loop_nesting = 2;         // Niveles de bucles o if anidados
+        int identifier_length = 6;    // Longitud mínima de los nombres
+        double comment_density = 0.1; // Probabilidad de un comentario antes de cada declaración
+        double whitespace_density = 0.1; // Probabilidad de líneas en blanco y espacios extra
+        int max_parameters = 4;
+        int variables = 6;            // Variables locales de cada función
+    };
+
+    // Estadísticas de la última llamada a generate() o generate_bytes()
+    struct Stats {
+        int functions = 0;
+        long long statements = 0;
+        long long expressions = 0; // Nodos de expresión generados
+        long long loops = 0;
+        long long calls = 0;
+        long long comments = 0;
+        size_t bytes = 0;
+    };
+
+    ProgramGenerator() {}
+    explicit ProgramGenerator(const Options& options) : options(options) {}
+
+    std::string generate() {
+        start();
+        for (int f = 0; f < options.functions; f++) function();
+        return finish();
+    }
+
+    // Programa de aproximadamente 'bytes' bytes: la última función deja de agregar
+    // declaraciones al llegar al tamaño y solo se completa
+    std::string generate_bytes(size_t bytes) {
+        start();
+        out.reserve(bytes + 4096);
+        while (out.size() < bytes) function(bytes);
+        return finish();
+    }
+
+    const Stats& last_stats() const {
+        return stats;
+    }
+
+private:
+    Options options;
+    Stats stats;
+    std::mt19937_64 rng;
+    std::string out;
+    std::vector<std::pair<int, int>> leaves; // Funciones ya generadas sin llamadas: (índice, parámetros)
+    bool calls_in_function = false;
+    std::vector<std::string> readable;    // Nombres que pueden leerse en la función actual
+    std::vector<std::string> assignable;  // Variables locales (no los contadores)
+    std::vector<std::string> counters;    // Contador de cada nivel de bucle
+
+    static constexpr size_t max_called = 16; // Las llamadas van a una de las últimas hojas
+
+    void start() {
+        stats = Stats();
+        rng.seed(options.seed);
+        out.clear();
+        leaves.clear();
+    }
+
+    std::string finish() {
+        stats.bytes = out.size();
+        std::string result;
+        result.swap(out);
+        return result;
+    }
+
+    uint64_t below(uint64_t n) {
+        return n ? rng() % n : 0;
+    }
+
+    bool chance(double probability) {
+        return static_cast<double>(rng() >> 11) * 0x1.0p-53 < probability;
+    }
+
+    template <typename T>
+    const T& pick(const std::vector<T>& items) {
+        return items[below(items.size())];
+    }
+
+    // Prefijo, número y relleno hasta la longitud pedida
+    std::string name(char prefix, int index) {
+        std::string result = prefix + std::to_string(index);
+        if (static_cast<int>(result.size()) < options.identifier_length) {
+            result += '_';
+            for (int i = 0; static_cast<int>(result.size()) < options.identifier_length; i++) {
+                result += static_cast<char>('a' + (index + i) % 26);
+            }
+        }
+        return result;
+    }
+
+    void indent(int level) {
+        out.append(4 * level, ' ');
+    }
+
+    // Comentario y espacio en blanco opcionales antes de una declaración
+    void decorate(int level) {
+        if (chance(options.whitespace_density)) {
+            out += '\n';
+            out.append(below(6), ' ');
+            if (chance(0.5)) out += "\t\n";
+        }
+        if (chance(options.comment_density)) {
+            static const char* words[] = {"calcula", "el", "valor", "del", "acumulado", "para", "cada", "caso",
+                                          "límite", "total", "a / b", "x == y", "// anidado", "if (x) { }"};
+            indent(level);
+            out += "//";
+            int count = 1 + static_cast<int>(below(8));
+            for (int i = 0; i < count; i++) {
+                out += ' ';
+                out += words[below(sizeof(words) / sizeof(words[0]))];
+            }
+            out += '\n';
+            stats.comments++;
+        }
+        indent(level);
+    }
+
+    void function(size_t limit = SIZE_MAX) {
+        int index = stats.functions++;
+        int parameters = static_cast<int>(below(options.max_parameters + 1));
+        readable.clear();
+        assignable.clear();
+        counters.clear();
+        calls_in_function = false;
+
+        if (index > 0 && chance(options.whitespace_density)) out += '\n';
+        out += "function " + name('f', index) + "(";
+        for (int p = 0; p < parameters; p++) {
+            std::string parameter = name('p', p);
+            out += (p ? ", int " : "int ") + parameter;
+            readable.push_back(parameter);
+        }
+        out += ") {\n";
+
+        // Declaraciones de todas las variables al principio
+        for (int v = 0; v < std::max(1, options.variables); v++) {
+            std::string variable = name('v', v);
+            decorate(1);
+            out += "int " + variable + " = ";
+            expression(options.expression_depth);
+            out += ";\n";
+            readable.push_back(variable);
+            assignable.push_back(variable);
+            stats.statements++;
+        }
+        for (int k = 0; k < options.loop_nesting; k++) {
+            std::string counter = name('k', k);
+            decorate(1);
+            out += "int " + counter + " = 0;\n";
+            counters.push_back(counter);
+            readable.push_back(counter);
+            stats.statements++;
+        }
+
+        for (int s = 0; s < options.statements && out.size() < limit; s++) statement(1);
+
+        decorate(1);
+        out += "return ";
+        expression(options.expression_depth);
+        out += ";\n}\n";
+        stats.statements++;
+        if (!calls_in_function) leaves.push_back({index, parameters});
+    }
+
+    void statement(int level) {
+        decorate(level);
+        stats.statements++;
+        int nesting = level - 1;
+        uint64_t kind = below(10);
+
+        if (nesting < options.loop_nesting && kind >= 6) {
+            if (kind == 6) {
+                out += "if (";
+                expression(options.expression_depth);
+                out += ") {\n";
+                block(level + 1);
+                indent(level);
+                if (chance(0.5)) {
+                    out += "} else {\n";
+                    block(level + 1);
+                    indent(level);
+                }
+                out += "}\n";
+                return;
+            }
+
+            // Bucle con límite fijo sobre el contador de su nivel
+            const std::string& counter = counters[nesting];
+            std::string limit = std::to_string(1 + below(10));
+            stats.loops++;
+            stats.expressions += 6;
+            if (kind == 7) {
+                out += "for (" + counter + " = 0; " + counter + " < " + limit + "; " + counter + " = " + counter + " + 1) {\n";
+                block(level + 1);
+                indent(level);
+                out += "}\n";
+            }
+            else if (kind == 8) {
+                out += counter + " = 0;\n";
+                indent(level);
+                out += "while (" + counter + " < " + limit + ") {\n";
+                block(level + 1);
+                indent(level + 1);
+                out += counter + " = " + counter + " + 1;\n";
+                indent(level);
+                out += "}\n";
+            }
+            else {
+                out += counter + " = 0;\n";
+                indent(level);
+                out += "do {\n";
+                block(level + 1);
+                indent(level + 1);
+                out += counter + " = " + counter + " + 1;\n";
+                indent(level);
+                out += "} while (" + counter + " < " + limit + ");\n";
+            }
+            return;
+        }
+
+        if (kind == 0 && !leaves.empty()) {
+            // Llamada como declaración
+            call(options.expression_depth - 1);
+            out += ";\n";
+            return;
+        }
+
+        out += pick(assignable) + " = ";
+        expression(options.expression_depth);
+        out += ";\n";
+    }
+
+    void block(int level) {
+        int count = 1 + static_cast<int>(below(3));
+        for (int s = 0; s < count; s++) statement(level);
+    }
+
+    void expression(int depth) {
+        stats.expressions++;
+        if (depth <= 0 || chance(0.2)) {
+            primary();
+            return;
+        }
+
+        uint64_t kind = below(20);
+        if (kind == 0 && !leaves.empty()) {
+            stats.expressions--;
+            call(depth - 1);
+            return;
+        }
+        if (kind == 1) {
+            // Los operadores unarios se aplican a un primario o a una expresión entre paréntesis
+            out += chance(0.5) ? "-(" : "!(";
+            expression(depth - 1);
+            out += ")";
+            return;
+        }
+
+        static const char* operators[] = {"+", "-", "*", "+", "-", "*", "<", ">", "<=", ">=", "==", "!=", "&&", "||"};
+        out += "(";
+        expression(depth - 1);
+        if (kind == 2) {
+            // División entre una constante distinta de cero
+            out += " / " + std::to_string(1 + below(100));
+            stats.expressions++;
+        }
+        else {
+            bool spaced = !chance(options.whitespace_density);
+            out += spaced ? " " : "";
+            out += operators[below(sizeof(operators) / sizeof(operators[0]))];
+            out += spaced ? " " : "  ";
+            expression(depth - 1);
+        }
+        out += ")";
+    }
+
+    void primary() {
+        uint64_t kind = below(10);
+        if (kind < 6 && !readable.empty()) {
+            out += pick(readable);
+        }
+        else if (kind < 9) {
+            out += std::to_string(below(1000));
+        }
+        else {
+            out += chance(0.5) ? "true" : "false";
+        }
+    }
+
+    void call(int depth) {
+        stats.calls++;
+        stats.expressions++;
+        calls_in_function = true;
+        size_t first = leaves.size() > max_called ? leaves.size() - max_called : 0;
+        const auto& [callee, parameters] = leaves[first + below(leaves.size() - first)];
+        out += name('f', callee) + "(";
+        for (int a = 0; a < parameters; a++) {
+            if (a) out += ", ";
+            expression(std::max(0, depth));
+        }
+        out += ")";
+    }
+};
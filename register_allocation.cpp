@@ -0,0 +1,317 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <functional>
+#include <iterator>
+
+#include "ir_instruction.cpp"
+#include "control_flow.cpp"
+
+/*
+    Asignación de temporales por barrido lineal (linear scan).
+
+    IntermediateCodeGenerator crea un temporal nuevo (%tN) por cada operación y nunca reinicia
+    el contador, por lo que una función grande puede usar cientos de miles de temporales
+    distintos. Esta fase calcula el intervalo de vida de cada temporal dentro de su función y
+    los asigna a un conjunto pequeño de registros virtuales (%r0, %r1, ...) que se reutilizan
+    cuando un intervalo termina. Si se fija un presupuesto de registros, los intervalos que
+    no caben se guardan en ranuras de memoria (%s0, %s1, ...), que también se reutilizan.
+
+    Las variables del programa no se tocan: solo se renombran los temporales. Los nombres
+    de registros y ranuras llevan '%', que un identificador no puede contener (como el '.'
+    de las copias del inliner), así que no chocan con ninguna variable.
+*/
+
+// Nombre del registro virtual o de la ranura de derrame con el número dado
+inline std::string register_name(long long number) {
+    return "%r" + std::to_string(number);
+}
+
+inline std::string spill_slot_name(long long number) {
+    return "%s" + std::to_string(number);
+}
+
+// Número de un registro virtual ("%r3" -> 3) o de una ranura ("%s1" -> 1), -1 si no lo es
+inline long long register_number(const std::string& name) {
+    return (name.size() > 2 && name[0] == '%') ? name_number(name.substr(1), 'r') : -1;
+}
+
+inline long long spill_slot_number(const std::string& name) {
+    return (name.size() > 2 && name[0] == '%') ? name_number(name.substr(1), 's') : -1;
+}
+
+class LinearScanAllocator {
+public:
+    struct Options {
+        int max_registers = 0; // 0 -> registros virtuales ilimitados (sin derrames)
+    };
+
+    // Estadísticas de la última llamada a allocate()
+    struct Stats {
+        int temps = 0;          // Temporales distintos en el código de entrada
+        int registers = 0;      // Máximo de registros usados en una función
+        int spill_slots = 0;    // Máximo de ranuras de derrame usadas en una función
+        int spilled_temps = 0;  // Temporales que terminaron en memoria
+    };
+
+    LinearScanAllocator() {}
+    LinearScanAllocator(Options options) : options(options) {}
+
+    // Función para asignar los temporales de todo el código intermedio
+    std::vector<std::string> allocate(const std::vector<std::string>& code) {
+        stats = Stats();
+        std::vector<Instruction> instructions = parse_instructions(code);
+        for (const auto& range : function_ranges(instructions)) {
+            allocate_function(instructions, range.first, range.second);
+        }
+        return format_instructions(instructions);
+    }
+
+    const Stats& last_stats() const {
+        return stats;
+    }
+
+private:
+    Options options;
+    Stats stats;
+
+    struct Interval {
+        int temp;       // Índice denso del temporal dentro de la función
+        size_t start;   // Primera posición donde el temporal está vivo
+        size_t end;     // Última posición donde el temporal está vivo
+        int location;   // Registro o ranura asignada
+        bool spilled;
+    };
+
+    void allocate_function(std::vector<Instruction>& code, size_t begin, size_t end) {
+        // Se numeran los temporales de la función de forma densa
+        std::unordered_map<std::string, int> temp_ids;
+        std::vector<std::string> temp_names;
+        for (size_t i = begin; i < end; i++) {
+            for (const auto& name : operands(code[i])) {
+                if (is_temp(name) && !temp_ids.count(name)) {
+                    temp_ids[name] = static_cast<int>(temp_names.size());
+                    temp_names.push_back(name);
+                }
+            }
+        }
+        stats.temps += static_cast<int>(temp_names.size());
+        if (temp_names.empty()) {
+            return;
+        }
+
+        std::vector<Interval> intervals = live_intervals(code, begin, end, temp_ids);
+
+        // Se asignan registros y, si hace falta, ranuras de derrame
+        std::vector<Interval*> spilled;
+        int registers = scan(intervals, options.max_registers, spilled);
+
+        std::vector<Interval> spill_intervals;
+        for (Interval* interval : spilled) {
+            spill_intervals.push_back(*interval);
+        }
+        std::vector<Interval*> unused;
+        int slots = scan(spill_intervals, 0, unused);
+
+        // Se construye el nombre final de cada temporal
+        std::vector<std::string> locations(temp_names.size());
+        for (const auto& interval : intervals) {
+            if (!interval.spilled) {
+                locations[interval.temp] = register_name(interval.location);
+            }
+        }
+        for (const auto& interval : spill_intervals) {
+            locations[interval.temp] = spill_slot_name(interval.location);
+        }
+
+        for (size_t i = begin; i < end; i++) {
+            code[i].rename_operands([&](const std::string& name) {
+                auto it = temp_ids.find(name);
+                return (it != temp_ids.end()) ? locations[it->second] : name;
+            });
+        }
+
+        stats.registers = std::max(stats.registers, registers);
+        stats.spill_slots = std::max(stats.spill_slots, slots);
+        stats.spilled_temps += static_cast<int>(spill_intervals.size());
+    }
+
+    // Función para obtener todos los nombres que lee o escribe una instrucción
+    static std::vector<std::string> operands(const Instruction& inst) {
+        std::vector<std::string> names = inst.uses();
+        std::string def = inst.defined();
+        if (!def.empty()) names.push_back(def);
+        return names;
+    }
+
+    // Sección de vida de los temporales -> begin
+
+    // Función para calcular el intervalo de vida de cada temporal.
+    // Se resuelve el análisis de vida por bloques básicos y luego cada temporal se
+    // resume en un único intervalo [inicio, fin] que cubre todas sus posiciones vivas.
+    std::vector<Interval> live_intervals(const std::vector<Instruction>& code, size_t begin, size_t end,
+                                         const std::unordered_map<std::string, int>& temp_ids) {
+        ControlFlowGraph cfg(code, begin, end);
+        size_t block_count = cfg.blocks.size();
+
+        // Conjuntos use/def de cada bloque (vectores ordenados, casi siempre muy pequeños)
+        std::vector<std::vector<int>> use(block_count), def(block_count);
+        for (size_t b = 0; b < block_count; b++) {
+            std::vector<int> defined;
+            for (size_t i = cfg.blocks[b].begin; i < cfg.blocks[b].end; i++) {
+                for (const auto& name : code[i].uses()) {
+                    auto it = temp_ids.find(name);
+                    if (it != temp_ids.end() && !contains(defined, it->second)) {
+                        insert_sorted(use[b], it->second);
+                    }
+                }
+                auto it = temp_ids.find(code[i].defined());
+                if (it != temp_ids.end()) {
+                    insert_sorted(defined, it->second);
+                }
+            }
+            def[b] = defined;
+        }
+
+        // live_in = use U (live_out - def), live_out = U live_in(sucesores)
+        std::vector<std::vector<int>> live_in(block_count), live_out(block_count);
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            for (size_t b = block_count; b-- > 0;) {
+                std::vector<int> out;
+                for (size_t s : cfg.blocks[b].successors) {
+                    out = merge(out, live_in[s]);
+                }
+                std::vector<int> in;
+                std::set_difference(out.begin(), out.end(), def[b].begin(), def[b].end(), std::back_inserter(in));
+                in = merge(in, use[b]);
+                if (in != live_in[b] || out != live_out[b]) {
+                    live_in[b] = in;
+                    live_out[b] = out;
+                    changed = true;
+                }
+            }
+        }
+
+        // Se extienden los intervalos con cada posición donde aparece o está vivo el temporal
+        std::vector<Interval> intervals(temp_ids.size());
+        std::vector<bool> seen(temp_ids.size(), false);
+        auto extend = [&](int temp, size_t position) {
+            if (!seen[temp]) {
+                intervals[temp] = {temp, position, position, -1, false};
+                seen[temp] = true;
+            }
+            else {
+                intervals[temp].start = std::min(intervals[temp].start, position);
+                intervals[temp].end = std::max(intervals[temp].end, position);
+            }
+        };
+
+        for (size_t b = 0; b < block_count; b++) {
+            for (int temp : live_in[b]) extend(temp, cfg.blocks[b].begin);
+            for (int temp : live_out[b]) extend(temp, cfg.blocks[b].end - 1);
+        }
+        for (size_t i = begin; i < end; i++) {
+            for (const auto& name : operands(code[i])) {
+                auto it = temp_ids.find(name);
+                if (it != temp_ids.end()) extend(it->second, i);
+            }
+        }
+
+        return intervals;
+    }
+
+    static bool contains(const std::vector<int>& set, int value) {
+        return std::binary_search(set.begin(), set.end(), value);
+    }
+
+    static void insert_sorted(std::vector<int>& set, int value) {
+        auto it = std::lower_bound(set.begin(), set.end(), value);
+        if (it == set.end() || *it != value) set.insert(it, value);
+    }
+
+    static std::vector<int> merge(const std::vector<int>& a, const std::vector<int>& b) {
+        std::vector<int> result;
+        result.reserve(a.size() + b.size());
+        std::set_union(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(result));
+        return result;
+    }
+
+    // Sección de vida de los temporales -> end
+
+    // Sección de barrido lineal -> begin
+
+    // Función que recorre los intervalos por orden de inicio y les asigna una ubicación.
+    // Un intervalo que termina en la misma posición donde empieza otro puede ceder su
+    // ubicación, porque la instrucción lee sus operandos antes de escribir el resultado.
+    // Con budget > 0, los intervalos que no caben se devuelven en spilled.
+    // Devuelve el número de ubicaciones distintas usadas.
+    static int scan(std::vector<Interval>& intervals, int budget, std::vector<Interval*>& spilled) {
+        std::vector<Interval*> order;
+        for (auto& interval : intervals) order.push_back(&interval);
+        std::sort(order.begin(), order.end(), [](const Interval* a, const Interval* b) {
+            return a->start != b->start ? a->start < b->start : a->temp < b->temp;
+        });
+
+        std::vector<Interval*> active;  // Ordenados por fin de intervalo
+        std::vector<int> free_locations; // Pila con la ubicación más baja al final
+        int location_count = 0;
+
+        for (Interval* current : order) {
+            // Se liberan los intervalos que ya terminaron
+            size_t expired = 0;
+            while (expired < active.size() && active[expired]->end <= current->start) {
+                release(free_locations, active[expired]->location);
+                expired++;
+            }
+            active.erase(active.begin(), active.begin() + expired);
+
+            if (budget > 0 && static_cast<int>(active.size()) == budget) {
+                // Se derrama el intervalo que termina más tarde
+                Interval* last = active.back();
+                if (last->end > current->end) {
+                    current->location = last->location;
+                    last->spilled = true;
+                    last->location = -1;
+                    spilled.push_back(last);
+                    active.pop_back();
+                    insert_active(active, current);
+                }
+                else {
+                    current->spilled = true;
+                    spilled.push_back(current);
+                }
+                continue;
+            }
+
+            if (!free_locations.empty()) {
+                current->location = free_locations.back();
+                free_locations.pop_back();
+            }
+            else {
+                current->location = location_count++;
+            }
+            insert_active(active, current);
+        }
+
+        return location_count;
+    }
+
+    static void insert_active(std::vector<Interval*>& active, Interval* interval) {
+        auto it = std::upper_bound(active.begin(), active.end(), interval, [](const Interval* a, const Interval* b) {
+            return a->end < b->end;
+        });
+        active.insert(it, interval);
+    }
+
+    static void release(std::vector<int>& free_locations, int location) {
+        auto it = std::lower_bound(free_locations.begin(), free_locations.end(), location, std::greater<int>());
+        free_locations.insert(it, location);
+    }
+
+    // Sección de barrido lineal -> end
+};
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// Programas de ejemplo del lenguaje, usados por use_example y por las herramientas de prueba
+inline std::vector<std::string> sample_programs() {
+    return {
+        R"(
+            function main() {
+                int x;
+                int y;
+                x = 10;
+                y = 20;
+
+                if (x < y) {
+                    return x + y;
+                } else {
+                    return x - y;
+                }
+            }
+        )",
+        R"(
+            function suma() {
+                int i;
+                int sum;
+                sum = 0;
+                i = 1;
+
+                while (i <= 5) {
+                    sum = sum + i;
+                    i = i + 1;
+                }
+
+                return sum;
+            }
+        )",
+        R"(
+            function main() {
+                int a;
+                a = 5;
+                int b = 10;
+                if (a < b) {
+                    return a + b;
+                } else {
+                    return a - b;
+                }
+            }
+        )",
+        R"(
+            function calculo_salario_neto() {
+                int salario = 1000;
+                int descuento = 25;
+                return salario - (salario * descuento / 100);
+            }
+        )",
+        R"(
+            function cuadrado(int n) {
+                return n * n;
+            }
+
+            function main() {
+                int a;
+                a = 4;
+                return cuadrado(a) + cuadrado(3);
+            }
+        )",
+        R"(
+            function f(int t0) {
+                int t1 = t0 + 1;
+                return t1 * 2;
+            }
+
+            function main() {
+                return f(3);
+            }
+        )"
+    };
+}
+
+// Programas fuente con bucles (invariantes, reducción de fuerza, bucles internos y llamadas
+// que se expanden en línea), usados por vm_benchmark y aot_harness
+struct LoopProgram {
+    std::string name;
+    std::string source;
+    std::vector<int64_t> args;
+    int vm_repetitions;
+};
+
+inline std::vector<LoopProgram> loop_programs() {
+    return {
+        {"invariante", R"(
+            function main(int n) {
+                int i;
+                int sum;
+                int base;
+                sum = 0;
+                base = n / 1000;
+                i = 0;
+                while (i < n) {
+                    sum = sum + (base + 7) * 3 + i * 12;
+                    i = i + 1;
+                }
+                return sum;
+            }
+        )", {200000}, 20},
+        {"internos", R"(
+            function main(int n) {
+                int i;
+                int j;
+                int total;
+                total = 0;
+                for (i = 0; i < n; i = i + 1) {
+                    for (j = 0; j < 4; j = j + 1) {
+                        total = total + i * 4 + j;
+                    }
+                }
+                return total;
+            }
+        )", {50000}, 20},
+        {"llamadas", R"(
+            function cuadrado(int x) {
+                return x * x;
+            }
+
+            function main(int n) {
+                int i;
+                int acc;
+                acc = 0;
+                i = 0;
+                while (i < n) {
+                    acc = acc + cuadrado(i) / (n + 1);
+                    i = i + 1;
+                }
+                return acc;
+            }
+        )", {100000}, 20},
+        {"suma", R"(
+            function main(int n) {
+                int i;
+                int sum;
+                int k;
+                sum = 0;
+                k = 0;
+                while (k < n) {
+                    i = 1;
+                    while (i <= 5) {
+                        sum = sum + i;
+                        i = i + 1;
+                    }
+                    k = k + 1;
+                }
+                return sum;
+            }
+        )", {100000}, 20}
+    };
+}
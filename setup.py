@@ -0,0 +1,25 @@
+from setuptools import setup, Extension
+
+"""
+    Compilación del módulo nativo para la implementación en Python:
+
+        python3 setup.py build_ext --inplace
+
+    deja _native_compiler junto a los demás módulos; native_compiler.py lo envuelve.
+"""
+
+native_compiler = Extension(
+    '_native_compiler',
+    sources=['native_compiler_module.cpp'],
+    include_dirs=['.'],
+    extra_compile_args=['-std=c++17', '-O2'],
+    extra_link_args=['-pthread'],
+    language='c++'
+)
+
+setup(
+    name='native_compiler',
+    version='1.0',
+    py_modules=['native_compiler'],
+    ext_modules=[native_compiler]
+)
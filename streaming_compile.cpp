@@ -0,0 +1,121 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "streaming_compiler.cpp"
+#include "tracking_allocator.cpp"
+
+/*
+    Compilación en flujo con StreamingCompiler: lee el programa de un archivo (o de la
+    entrada estándar con "-") y escribe su código intermedio en --output (o en la salida
+    estándar) sin tener nunca el programa entero en memoria.
+
+    Con --stats informa por la salida de errores las funciones, las instrucciones, la
+    función más larga y el pico de memoria dinámica de la compilación (contado por
+    tracking_allocator.cpp). Con --check además compila el programa entero con
+    compile_source(), informa su pico de memoria y comprueba que el código sea el mismo; el
+    proceso termina con código 1 si no coincide (no se puede usar con la entrada estándar
+    ni con --optimize, que no optimiza igual que optimize_code()).
+
+    Uso: streaming_compile [--optimize] [--buffer=64] [--output=archivo] [--stats] [--check]
+             programa.src | -
+*/
+
+// Pico de memoria viva (sobre la del inicio) mientras se ejecuta la función dada
+template <typename Work>
+static int64_t measure_peak(Work work) {
+    int64_t base = AllocationTracker::live;
+    AllocationTracker::peak = base;
+    work();
+    return AllocationTracker::peak - base;
+}
+
+int main(int argc, char* argv[]) {
+    StreamingCompiler::Options options;
+    std::string input_path, output_path;
+    bool show_stats = false;
+    bool check = false;
+
+    try {
+        for (int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+            size_t equals = arg.find('=');
+            std::string flag = arg.substr(0, equals);
+            std::string value = equals == std::string::npos ? "" : arg.substr(equals + 1);
+            if (flag == "--optimize") options.optimize = true;
+            else if (flag == "--buffer") options.buffer_bytes = std::stoul(value) << 10;
+            else if (flag == "--output") output_path = value;
+            else if (flag == "--stats") show_stats = true;
+            else if (flag == "--check") check = show_stats = true;
+            else if (arg.rfind("--", 0) == 0) throw std::runtime_error("Opción desconocida: " + arg);
+            else if (!input_path.empty()) throw std::runtime_error("Solo se compila un programa");
+            else input_path = arg;
+        }
+        if (input_path.empty()) throw std::runtime_error("Falta el programa (o - para la entrada estándar)");
+        if (check && (input_path == "-" || options.optimize)) {
+            throw std::runtime_error("--check necesita un archivo y no admite --optimize");
+        }
+    }
+    catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    StreamingCompiler compiler(options);
+    int64_t peak = 0;
+    try {
+        std::ifstream file;
+        if (input_path != "-") {
+            file.open(input_path, std::ios::binary);
+            if (!file) throw std::runtime_error("No se pudo leer " + input_path);
+        }
+        std::istream& input = (input_path == "-") ? std::cin : file;
+
+        std::ofstream output_file;
+        if (!output_path.empty()) {
+            output_file.open(output_path, std::ios::binary | std::ios::trunc);
+            if (!output_file) throw std::runtime_error("No se pudo escribir " + output_path);
+        }
+        std::ostream& output = output_path.empty() ? std::cout : output_file;
+
+        peak = measure_peak([&] { compiler.compile(input, output); });
+        output.flush();
+    }
+    catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    const StreamingCompiler::Stats& stats = compiler.last_stats();
+    if (show_stats) {
+        std::cerr << "bytes=" << stats.bytes_read << " funciones=" << stats.functions
+                  << " instrucciones=" << stats.instructions << " función_más_larga=" << stats.largest_function
+                  << " pico_KB=" << peak / 1024 << " s=" << stats.seconds << std::endl;
+    }
+    if (!check) return 0;
+
+    // Comparación con el programa entero: la salida se vuelve a compilar en memoria
+    std::vector<std::string> expected, streamed;
+    int64_t batch_peak = 0;
+    try {
+        std::ifstream file(input_path, std::ios::binary);
+        std::stringstream source;
+        source << file.rdbuf();
+        std::string program = source.str();
+        batch_peak = measure_peak([&] { expected = compile_source(program); });
+        streamed = compiler.compile(program);
+    }
+    catch (const std::exception& e) {
+        std::cerr << "compile_source: " << e.what() << std::endl;
+        return 1;
+    }
+    std::cerr << "compile_source pico_KB=" << batch_peak / 1024 << std::endl;
+    if (streamed != expected) {
+        std::cerr << "[FALLA] el código en flujo no coincide con compile_source()" << std::endl;
+        return 1;
+    }
+    std::cerr << "[OK] mismo código que compile_source() (" << expected.size() << " instrucciones)" << std::endl;
+    return 0;
+}
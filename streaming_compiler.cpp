@@ -0,0 +1,279 @@
+#pragma once
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <algorithm>
+#include <cctype>
+#include <stdexcept>
+
+#include "compiler_pipeline.cpp"
+
+/*
+    Compilación en flujo, una función a la vez, con memoria acotada por la función más grande.
+
+    compile_source() tiene vivos al mismo tiempo el fuente, todos los tokens, el AST entero,
+    las Function convertidas y todo el código intermedio. StreamingCompiler lee la entrada por
+    bloques y la recorre con un autómata de caracteres (palabra function, llaves balanceadas,
+    comentarios //) que corta el texto de cada función. Cada función se analiza, se convierte
+    y se genera sola, sus líneas se agregan a un búfer de salida que se vuelca cada
+    Options::buffer_bytes bytes, y su texto, tokens, AST y código se liberan antes de leer la
+    siguiente. Un único par de contadores continúa la numeración de temporales y etiquetas
+    de una función a la otra, igual que IntermediateCodeGenerator sobre el programa entero.
+
+    Sin optimización la salida es exactamente la de compile_source(). Como el Parser, el
+    recorrido se detiene en el primer texto fuera de una función que no empieza con la
+    palabra function y descarta el resto (el Lexer acepta cualquier carácter como UNKNOWN,
+    así que ese resto no puede dar un error). Un programa mal formado da un error del
+    Lexer o del Parser como en compile_source(), el de la primera función que falla; el
+    código de las anteriores puede estar ya escrito en la salida.
+
+    Con Options::optimize cada función pasa por LoopOptimizer y PeepholeOptimizer por
+    separado. La unión de funciones y la expansión en línea necesitan el programa completo,
+    así que no se aplican y el resultado no es el de optimize_code(); los nombres nuevos
+    del optimizador de bucles se numeran después de los de las funciones anteriores y las
+    funciones siguientes continúan después de ellos, así que siguen siendo únicos.
+*/
+
+class StreamingCompiler {
+public:
+    struct Options {
+        bool optimize = false;
+        size_t buffer_bytes = 1 << 16; // Tamaño del búfer de salida antes de volcarlo
+        size_t read_bytes = 1 << 16;   // Tamaño de cada lectura de la entrada
+    };
+
+    // Estadísticas de la última llamada a compile()
+    struct Stats {
+        size_t functions = 0;
+        size_t bytes_read = 0;
+        size_t instructions = 0;
+        size_t largest_function = 0;  // Bytes del fuente de la función más larga
+        size_t flushes = 0;
+        double seconds = 0;
+    };
+
+    StreamingCompiler() {}
+    explicit StreamingCompiler(const Options& options) : options(options) {}
+
+    // Compila la entrada completa y escribe su código intermedio, una línea por instrucción
+    const Stats& compile(std::istream& input, std::ostream& output) {
+        stats = Stats();
+        auto start = std::chrono::steady_clock::now();
+        reset();
+        out = &output;
+
+        std::vector<char> block(std::max<size_t>(1, options.read_bytes));
+        while (state != State::Rest && input) {
+            input.read(block.data(), static_cast<std::streamsize>(block.size()));
+            size_t count = static_cast<size_t>(input.gcount());
+            stats.bytes_read += count;
+            for (size_t i = 0; i < count && state != State::Rest; i++) step(block[i]);
+        }
+        // Lo que queda después del corte no se analiza, pero se lee para contar los bytes
+        while (input) {
+            input.read(block.data(), static_cast<std::streamsize>(block.size()));
+            stats.bytes_read += static_cast<size_t>(input.gcount());
+        }
+        finish();
+
+        flush();
+        out = nullptr;
+        stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return stats;
+    }
+
+    // Compila un fuente que ya está en memoria (por ejemplo, para comparar con compile_source())
+    std::vector<std::string> compile(const std::string& source) {
+        std::istringstream input(source);
+        std::ostringstream output;
+        compile(input, output);
+        std::vector<std::string> code;
+        std::istringstream lines(output.str());
+        std::string line;
+        while (std::getline(lines, line)) code.push_back(line);
+        return code;
+    }
+
+    const Stats& last_stats() const {
+        return stats;
+    }
+
+private:
+    // Between: entre funciones; Word: leyendo una palabra entre funciones; Slash: una '/'
+    // entre funciones; Comment: comentario entre funciones; Function: dentro de una función;
+    // Rest: después del corte
+    enum class State { Between, Word, Slash, Comment, Function, Rest };
+
+    Options options;
+    Stats stats;
+    std::ostream* out = nullptr;
+    std::string buffer;
+
+    State state = State::Between;
+    std::string text;                 // Texto de la función actual (o la palabra que se lee)
+    int line = 1, column = 1;         // Posición del carácter actual
+    int text_line = 1, text_column = 1;
+    int depth = 0;
+    bool opened = false;
+    bool in_comment = false;          // Dentro de un comentario de la función actual
+    bool after_slash = false;         // El carácter anterior de la función fue '/'
+    int temps = 0, labels = 0;        // Numeración para la función siguiente
+
+    static bool is_name(char c) {
+        return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+    }
+
+    void reset() {
+        buffer.clear();
+        text.clear();
+        state = State::Between;
+        line = column = text_line = text_column = 1;
+        depth = 0;
+        opened = in_comment = after_slash = false;
+        temps = labels = 0;
+    }
+
+    void step(char c) {
+        switch (state) {
+        case State::Between:
+            if (std::isspace(static_cast<unsigned char>(c))) break;
+            if (c == '/') {
+                state = State::Slash;
+            }
+            else if (is_name(c)) {
+                state = State::Word;
+                text.assign(1, c);
+                text_line = line;
+                text_column = column;
+            }
+            else {
+                state = State::Rest;
+            }
+            break;
+        case State::Slash:
+            state = (c == '/') ? State::Comment : State::Rest;
+            break;
+        case State::Comment:
+            if (c == '\n' || c == '\r') state = State::Between; // Donde termina "//.*" del Lexer
+            break;
+        case State::Word:
+            if (is_name(c)) {
+                text += c;
+                if (text.size() > 8) state = State::Rest;
+            }
+            else if (text == "function") {
+                state = State::Function;
+                depth = 0;
+                opened = in_comment = after_slash = false;
+                function_character(c);
+            }
+            else {
+                state = State::Rest;
+            }
+            break;
+        case State::Function:
+            function_character(c);
+            break;
+        case State::Rest:
+            break;
+        }
+
+        if (c == '\n') {
+            line++;
+            column = 1;
+        }
+        else {
+            column++;
+        }
+    }
+
+    // Un carácter dentro de una función; la función termina en la llave que cierra su cuerpo
+    // (o en una '}' antes de abrirlo, que el Parser rechaza igual que en el programa entero)
+    void function_character(char c) {
+        text += c;
+        if (in_comment) {
+            if (c == '\n' || c == '\r') in_comment = false;
+            return;
+        }
+        if (c == '/' && after_slash) {
+            in_comment = true;
+            after_slash = false;
+            return;
+        }
+        after_slash = (c == '/');
+        if (c == '{') {
+            depth++;
+            opened = true;
+        }
+        else if (c == '}' && (--depth == 0 || !opened)) {
+            compile_function();
+            state = State::Between;
+        }
+    }
+
+    // Una función sin cerrar al final de la entrada se compila igual para que el Parser
+    // informe el mismo error; una palabra function suelta también
+    void finish() {
+        if (state == State::Function || (state == State::Word && text == "function")) compile_function();
+        state = State::Rest;
+    }
+
+    void compile_function() {
+        stats.functions++;
+        stats.largest_function = std::max(stats.largest_function, text.size());
+
+        std::vector<std::string> code;
+        {
+            Lexer lexer(text, text_line, text_column);
+            Parser parser(lexer.tokenizer());
+            std::unique_ptr<ProgramNode> ast(parser.parse());
+            std::vector<Function> functions = convert_program(ast.get());
+            ast.reset();
+
+            IntermediateCodeGenerator generator(temps, labels);
+            code = generator.generate(functions);
+            temps = generator.temps_created();
+            labels = generator.labels_created();
+        }
+        text.clear();
+        text.shrink_to_fit();
+
+        if (options.optimize) optimize(code);
+        for (const auto& instruction : code) {
+            buffer += instruction;
+            buffer += '\n';
+        }
+        stats.instructions += code.size();
+        if (buffer.size() >= options.buffer_bytes) flush();
+    }
+
+    void optimize(std::vector<std::string>& code) {
+        LoopOptimizer::Options loop_options;
+        loop_options.first_temp = temps;
+        loop_options.first_label = labels;
+        LoopOptimizer loop_optimizer(loop_options);
+        code = loop_optimizer.optimize(code);
+        PeepholeOptimizer peephole;
+        code = peephole.optimize(code);
+
+        // Las funciones siguientes continúan después de los nombres que creó el optimizador
+        for (const auto& inst : parse_instructions(code)) {
+            for (const std::string* name : {&inst.result, &inst.arg1, &inst.arg2}) {
+                temps = std::max(temps, static_cast<int>(temp_number(*name) + 1));
+            }
+            labels = std::max(labels, static_cast<int>(name_number(inst.label, 'L') + 1));
+        }
+    }
+
+    void flush() {
+        if (buffer.empty() || !out) return;
+        out->write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        if (!*out) throw std::runtime_error("No se pudo escribir el código intermedio");
+        buffer.clear();
+        stats.flushes++;
+    }
+};
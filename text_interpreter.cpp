@@ -0,0 +1,161 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <stdexcept>
+
+#include "ir_instruction.cpp"
+#include "execution_outcome.cpp"
+
+/*
+    Intérprete directo del código intermedio en texto.
+
+    Cada paso vuelve a decodificar la línea con parse_instruction() y guarda las variables
+    en un diccionario por nombre, sin ninguna traducción previa. Es la forma más simple de
+    ejecutar el código y sirve como referencia (misma semántica que VirtualMachine) y como
+    punto de comparación en las mediciones de rendimiento.
+*/
+
+class TextInterpreter {
+public:
+    struct Options {
+        size_t max_call_depth = 1 << 12; // Cada llamada usa la pila nativa (recursión de call())
+    };
+
+    TextInterpreter(const std::vector<std::string>& code) : TextInterpreter(code, Options()) {}
+    TextInterpreter(const std::vector<std::string>& code, Options options) : code(code), options(options) {
+        std::vector<Instruction> instructions = parse_instructions(code);
+        for (const auto& range : function_ranges(instructions)) {
+            functions[instructions[range.first].result] = range.first;
+            for (size_t i = range.first; i < range.second; i++) {
+                if (instructions[i].kind == InstructionKind::Label) {
+                    labels[range.first][instructions[i].label] = i;
+                }
+            }
+        }
+        for (const auto& inst : instructions) {
+            if (inst.kind == InstructionKind::Alias && functions.count(inst.callee)) {
+                functions[inst.result] = functions[inst.callee];
+            }
+        }
+    }
+
+    // Función para ejecutar una función y obtener el valor de su RETURN
+    int64_t run(const std::string& name, const std::vector<int64_t>& args = {}) {
+        steps = 0;
+        return call(name, args, 0);
+    }
+
+    // Instrucciones ejecutadas en la última llamada a run() (sin contar etiquetas)
+    uint64_t executed_instructions() const {
+        return steps;
+    }
+
+private:
+    std::vector<std::string> code;
+    Options options;
+    std::unordered_map<std::string, size_t> functions; // Nombre -> línea de PROC
+    std::unordered_map<size_t, std::unordered_map<std::string, size_t>> labels; // PROC -> etiqueta -> línea
+    uint64_t steps = 0;
+
+    int64_t call(const std::string& name, const std::vector<int64_t>& args, size_t depth) {
+        auto function = functions.find(name);
+        if (function == functions.end()) {
+            throw std::runtime_error("Llamada a una función no definida: " + name);
+        }
+        if (depth >= options.max_call_depth) {
+            throw StackOverflowError("Desbordamiento de la pila al llamar a " + name);
+        }
+
+        Instruction header = parse_instruction(code[function->second]);
+        if (header.parameters.size() != args.size()) {
+            throw std::runtime_error("La función " + name + " espera " + std::to_string(header.parameters.size()) +
+                                     " argumentos");
+        }
+        std::unordered_map<std::string, int64_t> variables;
+        for (size_t i = 0; i < args.size(); i++) variables[header.parameters[i]] = args[i];
+        std::vector<int64_t> pending;
+
+        auto value = [&](const std::string& operand) -> int64_t {
+            if (operand.empty()) return 0;
+            if (is_constant(operand)) return std::stoll(operand);
+            auto it = variables.find(operand);
+            return (it == variables.end()) ? 0 : it->second;
+        };
+        auto evaluate = [&](const std::string& op, int64_t a, int64_t b) -> int64_t {
+            long long result;
+            if (!evaluate_binary(op, a, b, result)) {
+                if (canonical_operator(op) == "/") throw std::runtime_error("División entre cero");
+                throw std::runtime_error("Operador no soportado: " + op);
+            }
+            return result;
+        };
+        auto jump = [&](const std::string& label) -> size_t {
+            auto it = labels[function->second].find(label);
+            if (it == labels[function->second].end()) {
+                throw std::runtime_error("Etiqueta " + label + " no definida en la función " + name);
+            }
+            return it->second;
+        };
+
+        size_t pc = function->second + 1;
+        for (;;) {
+            Instruction inst = parse_instruction(code[pc]);
+            if (inst.kind != InstructionKind::Label) steps++;
+            switch (inst.kind) {
+                case InstructionKind::EndProc:
+                    return 0;
+                case InstructionKind::Label:
+                    pc++;
+                    break;
+                case InstructionKind::Goto:
+                    pc = jump(inst.label);
+                    break;
+                case InstructionKind::If:
+                case InstructionKind::IfFalse: {
+                    int64_t condition = inst.op.empty() ? value(inst.arg1)
+                                                        : evaluate(inst.op, value(inst.arg1), value(inst.arg2));
+                    bool taken = (inst.kind == InstructionKind::If) ? condition != 0 : condition == 0;
+                    pc = taken ? jump(inst.label) : pc + 1;
+                    break;
+                }
+                case InstructionKind::Return:
+                    return value(inst.arg1);
+                case InstructionKind::Copy:
+                    variables[inst.result] = value(inst.arg1);
+                    pc++;
+                    break;
+                case InstructionKind::Binary:
+                    variables[inst.result] = evaluate(inst.op, value(inst.arg1), value(inst.arg2));
+                    pc++;
+                    break;
+                case InstructionKind::Unary: {
+                    long long result = 0;
+                    evaluate_unary(inst.op, value(inst.arg1), result);
+                    variables[inst.result] = result;
+                    pc++;
+                    break;
+                }
+                case InstructionKind::Param:
+                    pending.push_back(value(inst.arg1));
+                    pc++;
+                    break;
+                case InstructionKind::Call: {
+                    if (inst.arg_count < 0 || static_cast<size_t>(inst.arg_count) > pending.size()) {
+                        throw std::runtime_error("Faltan argumentos para " + inst.callee);
+                    }
+                    std::vector<int64_t> call_args(pending.end() - inst.arg_count, pending.end());
+                    pending.resize(pending.size() - inst.arg_count);
+                    int64_t result = call(inst.callee, call_args, depth + 1);
+                    if (!inst.result.empty()) variables[inst.result] = result;
+                    pc++;
+                    break;
+                }
+                default:
+                    throw std::runtime_error("Instrucción no soportada: " + code[pc]);
+            }
+        }
+    }
+};
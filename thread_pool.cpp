@@ -0,0 +1,156 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <algorithm>
+#include <cstdint>
+
+/*
+    Grupo de hilos con robo de trabajo.
+
+    Cada hilo tiene su propia cola. Una tarea enviada desde un hilo del grupo va a la cola
+    de ese hilo; las enviadas desde afuera se reparten por turno entre las colas. Cada hilo
+    toma las tareas del final de su cola (la última que agregó, todavía en caché) y, cuando
+    la suya está vacía, roba del principio de la cola de otro hilo, de modo que las tareas
+    largas no dejan hilos parados mientras otros tienen trabajo pendiente.
+
+    Cada cola tiene su propio mutex, así que al tomar una tarea un hilo solo compite con
+    los que intentan robarle; un mutex común solo lleva la cuenta de las tareas en cola
+    para dormir y despertar a los hilos. wait() bloquea hasta que terminan todas las tareas
+    enviadas y no debe llamarse desde una tarea. Las tareas no deben lanzar excepciones
+    (las que lo hagan terminan el proceso).
+*/
+
+class ThreadPool {
+public:
+    // Estadísticas desde la creación del grupo
+    struct Stats {
+        uint64_t executed = 0;
+        uint64_t stolen = 0;   // Tareas que ejecutó un hilo distinto del de su cola
+    };
+
+    explicit ThreadPool(unsigned threads = 0) {
+        if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned i = 0; i < threads; i++) queues.push_back(std::make_unique<Queue>());
+        for (unsigned i = 0; i < threads; i++) workers.emplace_back([this, i] { work(i); });
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& worker : workers) worker.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t size() const {
+        return workers.size();
+    }
+
+    void submit(std::function<void()> task) {
+        size_t target = (current_pool == this) ? current_worker : next_queue++ % queues.size();
+        pending++;
+        {
+            std::lock_guard<std::mutex> lock(queues[target]->mutex);
+            queues[target]->tasks.push_back(std::move(task));
+        }
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex);
+            queued++;
+        }
+        wake.notify_one();
+    }
+
+    // Bloquea hasta que no quedan tareas pendientes
+    void wait() {
+        std::unique_lock<std::mutex> lock(sleep_mutex);
+        finished.wait(lock, [this] { return pending == 0; });
+    }
+
+    Stats stats() const {
+        Stats result;
+        result.executed = executed;
+        result.stolen = stolen;
+        return result;
+    }
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+
+    std::mutex sleep_mutex;              // Protege queued y stopping
+    std::condition_variable wake;        // Hay tareas en alguna cola o el grupo termina
+    std::condition_variable finished;    // pending llegó a 0
+    size_t queued = 0;                   // Tareas en colas, todavía sin tomar
+    bool stopping = false;
+    std::atomic<size_t> pending{0};      // Tareas enviadas y no terminadas
+    std::atomic<size_t> next_queue{0};
+    std::atomic<uint64_t> executed{0};
+    std::atomic<uint64_t> stolen{0};
+
+    // Hilo actual, para que las tareas enviadas desde una tarea vayan a la cola propia
+    static inline thread_local ThreadPool* current_pool = nullptr;
+    static inline thread_local size_t current_worker = 0;
+
+    void work(size_t index) {
+        current_pool = this;
+        current_worker = index;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(sleep_mutex);
+                wake.wait(lock, [this] { return queued > 0 || stopping; });
+                if (queued == 0) return;
+                queued--;
+            }
+
+            // Hay una tarea reservada: está en la cola propia o en la de otro hilo
+            std::function<void()> task;
+            while (!take(index, task)) std::this_thread::yield();
+            task();
+            executed++;
+
+            if (--pending == 0) {
+                std::lock_guard<std::mutex> lock(sleep_mutex);
+                finished.notify_all();
+            }
+        }
+    }
+
+    bool take(size_t index, std::function<void()>& task) {
+        {
+            Queue& own = *queues[index];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.tasks.empty()) {
+                task = std::move(own.tasks.back());
+                own.tasks.pop_back();
+                return true;
+            }
+        }
+        for (size_t k = 1; k < queues.size(); k++) {
+            Queue& victim = *queues[(index + k) % queues.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty()) {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                stolen++;
+                return true;
+            }
+        }
+        return false;
+    }
+};
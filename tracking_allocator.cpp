@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdlib>
+#include <new>
+#include <malloc.h>
+
+#include "phase_report.cpp"
+
+/*
+    Reemplazo de operator new y operator delete que lleva la cuenta de la memoria dinámica
+    en AllocationTracker. Cubre todo lo que asignan las fases: los Token y sus cadenas, los
+    nodos del AST y las líneas del código intermedio.
+
+    Define funciones globales, así que solo debe incluirlo el archivo que tiene main(). El
+    tamaño de cada bloque se toma de malloc_usable_size(), sin cabecera extra: el costo por
+    asignación son unas pocas sumas, haya o no un informe activo.
+*/
+
+static const bool allocation_tracker_installed = (AllocationTracker::installed = true);
+
+void* operator new(size_t size) {
+    void* pointer = std::malloc(size ? size : 1);
+    if (!pointer) throw std::bad_alloc();
+    AllocationTracker::allocated(malloc_usable_size(pointer));
+    return pointer;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+// Sin inline: al expandirla GCC advierte (en falso) que el free() no corresponde a operator new
+#if defined(__GNUC__)
+__attribute__((noinline))
+#endif
+void operator delete(void* pointer) noexcept {
+    if (!pointer) return;
+    AllocationTracker::released(malloc_usable_size(pointer));
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept {
+    operator delete(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept {
+    operator delete(pointer);
+}
+
+void operator delete[](void* pointer, size_t) noexcept {
+    operator delete(pointer);
+}
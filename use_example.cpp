@@ -2,68 +2,227 @@
 #include <string>
 #include <vector>
 #include <sstream>
+#include <fstream>
 
 #include "lexer.cpp"
 #include "parser.cpp"
 #include "intermediate_code.cpp"
+#include "compiler_pipeline.cpp"
+#include "sample_programs.cpp"
+#include "register_allocation.cpp"
+#include "bytecode_vm.cpp"
+#include "text_interpreter.cpp"
+#include "jit_compiler.cpp"
+#include "assembly_backend.cpp"
+#include "execution_profiler.cpp"
+#include "tracking_allocator.cpp"
+#include "execution_outcome.cpp"
 
 /*
     Código básico de ejemplo para el uso de un analizador léxico, sintáctico y generador de código intermedio.
     Este código no es funcional y solo sirve como ejemplo de cómo se pueden usar las clases definidas en los módulos.
     Se espera que el código fuente sea un fragmento de un lenguaje de programación ficticio.
+
+    Con el argumento --check no se imprimen las fases: cada función de cada programa se
+    ejecuta con argumentos fijos en el intérprete de texto (referencia), en la máquina
+    virtual y en el JIT, y se informa cualquier diferencia (el proceso termina con código 1).
+    Si un motor agota su pila (cada uno tiene su propio límite) la función se informa con
+    [LÍMITE] y no cuenta como diferencia.
+
+    Con --profile cada función se ejecuta con los mismos argumentos en ExecutionProfiler
+    (sobre el código sin optimizar, para relacionarlo con las líneas del fuente) y se
+    imprime un resumen; --profile=folded imprime las pilas para flamegraph.pl (con el
+    programa como primer marco) y --profile=json los contadores de todos los programas.
+
+    Con --time-report y --mem-report cada programa pasa por el compilador, la máquina
+    virtual y la ejecución de sus funciones con los argumentos de --check, y se imprime el
+    tiempo o la memoria de cada fase (ver phase_report.cpp); pueden usarse juntos, y con
+    =json se imprime un arreglo con el informe completo de cada programa.
+
+    Los archivos que se pasen como argumentos reemplazan a los programas de ejemplo.
 */
 
-int main() {
-    std::vector<std::string> programs = {
-        R"(
-            function main() {
-                int x;
-                int y;
-                x = 10;
-                y = 20;
-
-                if (x < y) {
-                    return x + y;
-                } else {
-                    return x - y;
-                }
-            }
-        )",
-        R"(
-            function suma() {
-                int i;
-                int sum;
-                sum = 0;
-                i = 1;
-
-                while (i <= 5) {
-                    sum = sum + i;
-                    i = i + 1;
-                }
-
-                return sum;
+// Función para comparar el JIT con la referencia en todas las funciones de un programa
+static int check_program(size_t number, const std::string& program) {
+    std::vector<std::string> code = compile_source(program);
+    std::vector<std::string> optimized_code = optimize_code(code);
+
+    TextInterpreter reference(code);
+    BytecodeCompiler bytecode_compiler;
+    BytecodeModule bytecode = bytecode_compiler.compile(optimized_code);
+    VirtualMachine vm;
+    JitCompiler jit_compiler;
+    JitModule jit = jit_compiler.compile(code);
+    JitModule jit_optimized = jit_compiler.compile(optimized_code);
+    JitCompiler::Options memory_only;
+    memory_only.register_variables = 0;
+    JitModule jit_memory = JitCompiler(memory_only).compile(code);
+
+    int failures = 0;
+    for (const auto& inst : parse_instructions(code)) {
+        if (inst.kind != InstructionKind::Proc) continue;
+
+        // Argumentos fijos para que la prueba sea determinista
+        std::vector<int64_t> args;
+        for (size_t i = 0; i < inst.parameters.size(); i++) args.push_back(static_cast<int64_t>(3 + 2 * i));
+
+        const std::string& name = inst.result;
+        Outcome expected = execute([&] { return reference.run(name, args); });
+        std::vector<std::pair<std::string, Outcome>> outcomes = {
+            {"vm", execute([&] { return vm.run(bytecode, name, args); })},
+            {"jit", execute([&] { return jit.run(name, args); })},
+            {"jit optimizado", execute([&] { return jit_optimized.run(name, args); })},
+            {"jit sin registros", execute([&] { return jit_memory.run(name, args); })}
+        };
+
+        bool ok = true;
+        bool limited = false;
+        for (const auto& [engine, outcome] : outcomes) {
+            if (expected.exhausted || outcome.exhausted) {
+                // Límite de pila de uno de los motores: no se puede comparar, pero no es una falla
+                std::cout << "[LÍMITE] programa " << number << ", " << name << ": referencia " << expected.to_string()
+                          << ", " << engine << " " << outcome.to_string() << std::endl;
+                limited = true;
             }
-        )",
-        R"(
-            function main() {
-                int a;
-                a = 5;
-                int b = 10;
-                if (a < b) {
-                    return a + b;
-                } else {
-                    return a - b;
-                }
+            else if (!(outcome == expected)) {
+                std::cout << "[FALLA] programa " << number << ", " << name << ": referencia " << expected.to_string()
+                          << ", " << engine << " " << outcome.to_string() << std::endl;
+                ok = false;
             }
-        )",
-        R"(
-            function calculo_salario_neto() {
-                int salario = 1000;
-                int descuento = 25;
-                return salario - (salario * descuento / 100);
+        }
+        if (ok && !limited) {
+            std::cout << "[OK] programa " << number << ", " << name << " = " << expected.to_string() << std::endl;
+        }
+        else if (!ok) {
+            failures++;
+        }
+    }
+    return failures;
+}
+
+// Función para perfilar todas las funciones de un programa con los argumentos de --check
+static void profile_program(size_t number, const std::string& program, const std::string& format, bool first) {
+    std::vector<SourcePosition> positions;
+    std::vector<std::string> code = compile_source(program, positions);
+    ExecutionProfiler profiler(code, positions);
+    for (const auto& inst : parse_instructions(code)) {
+        if (inst.kind != InstructionKind::Proc) continue;
+        std::vector<int64_t> args;
+        for (size_t i = 0; i < inst.parameters.size(); i++) args.push_back(static_cast<int64_t>(3 + 2 * i));
+        execute([&] { return profiler.run(inst.result, args); });
+    }
+
+    std::string prefix = "programa" + std::to_string(number);
+    if (format == "folded") {
+        std::istringstream stacks(profiler.collapsed_stacks());
+        std::string line;
+        while (std::getline(stacks, line)) std::cout << prefix << ";" << line << "\n";
+    }
+    else if (format == "json") {
+        std::cout << (first ? "[\n" : ",\n") << profiler.to_json();
+    }
+    else {
+        std::cout << "\n<----- Perfil del " << prefix << " ----->\n" << profiler.report();
+    }
+}
+
+// Función para medir las fases de un programa: compilación, bytecode y ejecución
+static void report_program(size_t number, const std::string& program, bool time, bool memory, bool json) {
+    PhaseReport report;
+    report.start();
+    {
+        std::vector<std::string> optimized_code = optimize_code(compile_source(program));
+        BytecodeModule bytecode;
+        {
+            PhaseReport::Scope phase("bytecode");
+            BytecodeCompiler bytecode_compiler;
+            bytecode = bytecode_compiler.compile(optimized_code);
+            phase.count("instrucciones", bytecode.code.size());
+        }
+
+        PhaseReport::Scope phase("ejecución");
+        VirtualMachine vm;
+        uint64_t functions = 0;
+        for (const auto& inst : parse_instructions(optimized_code)) {
+            if (inst.kind != InstructionKind::Proc) continue;
+            std::vector<int64_t> args;
+            for (size_t i = 0; i < inst.parameters.size(); i++) args.push_back(static_cast<int64_t>(3 + 2 * i));
+            execute([&] { return vm.run(bytecode, inst.result, args); });
+            functions++;
+        }
+        phase.count("funciones", functions);
+    }
+    report.stop();
+
+    if (json) {
+        std::cout << (number ? ",\n" : "[\n") << report.to_json();
+    }
+    else {
+        std::cout << "\n<----- Informe del programa " << number << " ----->\n" << report.table(time, memory);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::string mode;
+    bool time_report = false;
+    bool memory_report = false;
+    bool json_report = false;
+    std::vector<std::string> programs;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--time-report" || arg == "--time-report=json") {
+            time_report = true;
+            json_report = json_report || arg != "--time-report";
+        }
+        else if (arg == "--mem-report" || arg == "--mem-report=json") {
+            memory_report = true;
+            json_report = json_report || arg != "--mem-report";
+        }
+        else if (arg.rfind("--", 0) == 0) {
+            mode = arg;
+        }
+        else {
+            std::ifstream file(arg);
+            if (!file) {
+                std::cerr << "No se pudo leer " << arg << std::endl;
+                return 1;
             }
-        )"
-    };
+            std::stringstream source;
+            source << file.rdbuf();
+            programs.push_back(source.str());
+        }
+    }
+    bool check = mode == "--check";
+    if (programs.empty()) programs = sample_programs();
+
+    if (time_report || memory_report) {
+        for (size_t i = 0; i < programs.size(); i++) {
+            report_program(i, programs[i], time_report, memory_report, json_report);
+        }
+        if (json_report) std::cout << "\n]" << std::endl;
+        return 0;
+    }
+
+    if (mode == "--profile" || mode.rfind("--profile=", 0) == 0) {
+        std::string format = (mode == "--profile") ? "" : mode.substr(std::string("--profile=").size());
+        if (!format.empty() && format != "folded" && format != "json") {
+            std::cerr << "Formato de perfil desconocido: " << format << std::endl;
+            return 1;
+        }
+        for (size_t i = 0; i < programs.size(); i++) {
+            profile_program(i, programs[i], format, i == 0);
+        }
+        if (format == "json") std::cout << "]" << std::endl;
+        return 0;
+    }
+
+    if (check) {
+        int failures = 0;
+        for (size_t i = 0; i < programs.size(); i++) {
+            failures += check_program(i, programs[i]);
+        }
+        return failures == 0 ? 0 : 1;
+    }
 
     for (const auto& program : programs) {
         std::cout << "\n<----- Código Fuente ----->\n" << program << std::endl;
@@ -89,18 +248,8 @@ int main() {
         IntermediateCodeGenerator generator;
 
         // Convert ProgramNode* to vector<Function>
-        std::vector<Function> functions;
-        for (FunctionNode* funcNode : ast->functions) {
-            Function func;
-            func.name = funcNode->name;
-            for (StatementNode* stmtNode : funcNode->body) {
-                // Convert StatementNode* to Statement
-                Statement stmt;
-                stmt.type = stmtNode->type;
-                func.body.push_back(stmt);
-            }
-            functions.push_back(func);
-        }
+        std::vector<Function> functions = convert_program(ast);
+        delete ast;
 
         std::vector<std::string> intermediate_code = generator.generate(functions);
 
@@ -109,6 +258,55 @@ int main() {
         for (const auto& instruction : intermediate_code) {
             std::cout << instruction << std::endl;
         }
+
+        // Optimizaciones sobre el código intermedio
+        std::vector<std::string> optimized_code = optimize_code(intermediate_code);
+
+        std::cout << "\n<----- Código Intermedio Optimizado ----->\n";
+        for (const auto& instruction : optimized_code) {
+            std::cout << instruction << std::endl;
+        }
+
+        // Ejecución del código optimizado en la máquina virtual
+        BytecodeCompiler bytecode_compiler;
+        BytecodeModule module = bytecode_compiler.compile(optimized_code);
+        int main_index = module.find_function("main");
+        if (main_index >= 0) {
+            // Los mismos argumentos fijos que --check; un error (división entre cero, pila
+            // agotada) se informa en lugar de terminar el ejemplo
+            std::vector<int64_t> args;
+            for (int i = 0; i < module.functions[main_index].parameter_count; i++) {
+                args.push_back(static_cast<int64_t>(3 + 2 * i));
+            }
+
+            VirtualMachine vm;
+            std::cout << "\n<----- Ejecución ----->\n";
+            std::cout << "main devuelve " << execute([&] { return vm.run(module, "main", args); }).to_string()
+                      << std::endl;
+
+            // JitModule::run() llama al puntero a función de jit.entry() y revisa los errores
+            JitCompiler jit_compiler;
+            JitModule jit = jit_compiler.compile(optimized_code);
+            std::cout << "main (JIT) devuelve " << execute([&] { return jit.run("main", args); }).to_string()
+                      << std::endl;
+        }
+
+        // Asignación de temporales a registros virtuales por barrido lineal
+        LinearScanAllocator allocator;
+        std::vector<std::string> allocated_code = allocator.allocate(optimized_code);
+
+        std::cout << "\n<----- Código Intermedio con Registros ----->\n";
+        for (const auto& instruction : allocated_code) {
+            std::cout << instruction << std::endl;
+        }
+        std::cout << "Temporales: " << allocator.last_stats().temps
+                  << ", registros: " << allocator.last_stats().registers << std::endl;
+
+        // Ensamblador x86-64 para GNU as (ver aot_harness.cpp para ensamblarlo y ejecutarlo)
+        AssemblyBackend::Options assembly_options;
+        assembly_options.symbol_prefix = "ir_";
+        AssemblyBackend backend(assembly_options);
+        std::cout << "\n<----- Código Ensamblador x86-64 ----->\n" << backend.emit(optimized_code);
     }
 
     return 0;
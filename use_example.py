@@ -64,11 +64,24 @@ source_code_03 = """
     }
 """
 
+source_code_04 = """
+    function cuadrado(int n) {
+        return n * n;
+    }
+
+    function main() {
+        int a;
+        a = 4;
+        return cuadrado(a) + cuadrado(3);
+    }
+"""
+
 programs = [
     sourc_code_00,
     sourc_code_01,
     source_code_02,
-    source_code_03
+    source_code_03,
+    source_code_04
 ]
 
 for program in programs:
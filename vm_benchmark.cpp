@@ -0,0 +1,324 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+
+#include "bytecode_vm.cpp"
+#include "text_interpreter.cpp"
+#include "batch_execution.cpp"
+#include "execution_profiler.cpp"
+#include "compiler_pipeline.cpp"
+#include "sample_programs.cpp"
+
+/*
+    Medición de rendimiento de la máquina virtual contra el intérprete directo del texto.
+
+    Los programas están escritos directamente en código intermedio, con el mismo formato
+    que produce IntermediateCodeGenerator (operadores "PLUS", "LT", ...). Cada programa se
+    ejecuta una vez con TextInterpreter, que además cuenta las instrucciones ejecutadas, y
+    varias veces con VirtualMachine; ambos resultados deben coincidir.
+
+    La segunda tabla repite los programas después de BlockLayoutOptimizer, con el perfil de
+    una ejecución de entrenamiento con los mismos argumentos, y cuenta los saltos tomados
+    antes y después del reordenamiento.
+
+    La tercera tabla compara el código sin optimizar con el de optimize_code() sobre los
+    programas de loop_programs() (invariantes, reducción de fuerza, bucles internos que se
+    desenrollan y llamadas que se expanden en línea): instrucciones ejecutadas, contadas
+    por TextInterpreter, y tiempo en VirtualMachine.
+
+    Las últimas tablas miden la ejecución por lotes: dos funciones pequeñas, una con un salto
+    que diverge entre registros y otra con control uniforme, evaluadas sobre un millón de
+    registros por columnas con BatchExecutor (con la versión genérica y con la que elige
+    según el procesador) y registro por registro con TextInterpreter y VirtualMachine. La
+    aceleración se da respecto de la VM por registro.
+*/
+
+struct BenchmarkProgram {
+    std::string name;
+    std::vector<std::string> code;
+    std::vector<int64_t> args;
+    int vm_repetitions;
+};
+
+// Sueldo neto con horas extra: la mitad de los registros toma el salto y la otra mitad no
+static const std::vector<std::string> salary_program = {
+    "PROC salario_neto(salario, descuento, horas):",
+    "IF_FALSE horas GT 160 GOTO L0",
+    "%t0 = horas MINUS 160",
+    "%t1 = %t0 MUL 15",
+    "salario = salario PLUS %t1",
+    "L0:",
+    "%t2 = salario MUL descuento",
+    "%t3 = %t2 DIV 100",
+    "%t4 = salario MINUS %t3",
+    "RETURN %t4",
+    "ENDP"
+};
+
+// Bono con el mismo formato de registro: el salto va igual en todos los registros (salario > 0)
+static const std::vector<std::string> bonus_program = {
+    "PROC bono(salario, descuento, horas):",
+    "%t0 = horas MUL 12",
+    "%t1 = salario PLUS %t0",
+    "IF_FALSE salario GT 0 GOTO L0",
+    "%t2 = descuento MUL 4",
+    "%t1 = %t1 MINUS %t2",
+    "L0:",
+    "%t3 = %t1 MUL 3",
+    "%t4 = %t3 MINUS horas",
+    "RETURN %t4",
+    "ENDP"
+};
+
+static double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main() {
+    std::vector<BenchmarkProgram> programs = {
+        {"bucle", {
+            "PROC main(n):",
+            "sum = 0",
+            "i = 0",
+            "L0:",
+            "IF_FALSE i LT n GOTO L1",
+            "%t0 = i MUL 3",
+            "%t1 = %t0 DIV 2",
+            "sum = sum PLUS %t1",
+            "i = i PLUS 1",
+            "GOTO L0",
+            "L1:",
+            "RETURN sum",
+            "ENDP"
+        }, {1000000}, 20},
+        {"anidados", {
+            "PROC main(n):",
+            "count = 0",
+            "i = 0",
+            "L0:",
+            "IF_FALSE i LT n GOTO L1",
+            "j = 0",
+            "L2:",
+            "IF_FALSE j LT n GOTO L3",
+            "%t0 = i MUL j",
+            "%t1 = %t0 DIV 7",
+            "%t2 = %t1 MUL 7",
+            "IF %t0 != %t2 GOTO L4",
+            "count = count PLUS 1",
+            "L4:",
+            "j = j PLUS 1",
+            "GOTO L2",
+            "L3:",
+            "i = i PLUS 1",
+            "GOTO L0",
+            "L1:",
+            "RETURN count",
+            "ENDP"
+        }, {1000}, 20},
+        {"fibonacci", {
+            "PROC fib(n):",
+            "IF_FALSE n LT 2 GOTO L0",
+            "RETURN n",
+            "L0:",
+            "%t0 = n MINUS 1",
+            "PARAM %t0",
+            "%t1 = CALL fib, 1",
+            "%t2 = n MINUS 2",
+            "PARAM %t2",
+            "%t3 = CALL fib, 1",
+            "%t4 = %t1 PLUS %t3",
+            "RETURN %t4",
+            "ENDP",
+            "PROC main(n):",
+            "PARAM n",
+            "%t5 = CALL fib, 1",
+            "RETURN %t5",
+            "ENDP"
+        }, {24}, 20}
+    };
+
+    std::cout << std::left << std::setw(12) << "Programa" << std::right << std::setw(14) << "Instrucciones"
+              << std::setw(14) << "Texto (s)" << std::setw(14) << "VM (s)" << std::setw(16) << "Texto (M/s)"
+              << std::setw(14) << "VM (M/s)" << std::setw(12) << "Aceleración" << std::endl;
+
+    for (const auto& program : programs) {
+        TextInterpreter interpreter(program.code);
+        auto start = std::chrono::steady_clock::now();
+        int64_t expected = interpreter.run("main", program.args);
+        double text_seconds = seconds_since(start);
+        double instructions = static_cast<double>(interpreter.executed_instructions());
+
+        BytecodeCompiler compiler;
+        BytecodeModule module = compiler.compile(program.code);
+        VirtualMachine vm;
+        start = std::chrono::steady_clock::now();
+        int64_t result = 0;
+        for (int r = 0; r < program.vm_repetitions; r++) {
+            result = vm.run(module, "main", program.args);
+        }
+        double vm_seconds = seconds_since(start) / program.vm_repetitions;
+
+        if (result != expected) {
+            std::cerr << "Resultados distintos en " << program.name << ": texto " << expected << ", VM " << result
+                      << std::endl;
+            return 1;
+        }
+
+        std::cout << std::left << std::setw(12) << program.name << std::right << std::setw(14)
+                  << static_cast<uint64_t>(instructions) << std::fixed << std::setprecision(4) << std::setw(14)
+                  << text_seconds << std::setw(14) << vm_seconds << std::setprecision(1) << std::setw(16)
+                  << instructions / text_seconds / 1e6 << std::setw(14) << instructions / vm_seconds / 1e6
+                  << std::setw(11) << text_seconds / vm_seconds << "x" << std::endl;
+    }
+
+    // Orden de bloques guiado por perfil
+    std::cout << "\n" << std::left << std::setw(12) << "Programa" << std::right << std::setw(16) << "Saltos antes"
+              << std::setw(16) << "Saltos después" << std::setw(14) << "VM antes (s)" << std::setw(16)
+              << "VM después (s)" << std::endl;
+    for (const auto& program : programs) {
+        ExecutionProfiler training(program.code);
+        int64_t expected = training.run("main", program.args);
+        BlockLayoutOptimizer layout;
+        std::vector<std::string> laid_out = layout.optimize(program.code, training.block_profile());
+        ExecutionProfiler check(laid_out);
+        if (check.run("main", program.args) != expected) {
+            std::cerr << "Resultados distintos en " << program.name << " después de reordenar los bloques" << std::endl;
+            return 1;
+        }
+
+        std::vector<double> seconds;
+        for (const auto& code : {program.code, laid_out}) {
+            BytecodeCompiler compiler;
+            BytecodeModule module = compiler.compile(code);
+            VirtualMachine vm;
+            auto start = std::chrono::steady_clock::now();
+            for (int r = 0; r < program.vm_repetitions; r++) vm.run(module, "main", program.args);
+            seconds.push_back(seconds_since(start) / program.vm_repetitions);
+        }
+
+        std::cout << std::left << std::setw(12) << program.name << std::right << std::setw(16)
+                  << training.taken_branches() << std::setw(16) << check.taken_branches() << std::fixed
+                  << std::setprecision(4) << std::setw(14) << seconds[0] << std::setw(16) << seconds[1] << std::endl;
+    }
+
+    // Código optimizado contra el original sobre programas con bucles
+    std::cout << "\n" << std::left << std::setw(12) << "Programa" << std::right << std::setw(16) << "Instr. antes"
+              << std::setw(16) << "Instr. después" << std::setw(14) << "VM antes (s)" << std::setw(16)
+              << "VM después (s)" << std::setw(13) << "Aceleración" << std::endl;
+    for (const auto& program : loop_programs()) {
+        std::vector<std::string> code = compile_source(program.source);
+        std::vector<std::string> optimized_code = optimize_code(code);
+
+        std::vector<uint64_t> instructions;
+        std::vector<double> seconds;
+        int64_t expected = 0;
+        for (const auto& version : {code, optimized_code}) {
+            TextInterpreter interpreter(version);
+            int64_t result = interpreter.run("main", program.args);
+            instructions.push_back(interpreter.executed_instructions());
+
+            BytecodeCompiler compiler;
+            BytecodeModule module = compiler.compile(version);
+            VirtualMachine vm;
+            auto start = std::chrono::steady_clock::now();
+            for (int r = 0; r < program.vm_repetitions; r++) {
+                if (vm.run(module, "main", program.args) != result) result = INT64_MIN;
+            }
+            seconds.push_back(seconds_since(start) / program.vm_repetitions);
+
+            if (instructions.size() == 1) expected = result;
+            if (result != expected) {
+                std::cerr << "Resultados distintos en " << program.name << " con el código optimizado" << std::endl;
+                return 1;
+            }
+        }
+
+        std::cout << std::left << std::setw(12) << program.name << std::right << std::setw(16) << instructions[0]
+                  << std::setw(16) << instructions[1] << std::fixed << std::setprecision(4) << std::setw(14)
+                  << seconds[0] << std::setw(16) << seconds[1] << std::setprecision(1) << std::setw(12)
+                  << seconds[0] / seconds[1] << "x" << std::endl;
+    }
+
+    // Ejecución por lotes sobre columnas de registros
+    const size_t records = 1 << 20;
+    std::mt19937_64 random(42);
+    std::vector<std::vector<int64_t>> columns(3, std::vector<int64_t>(records));
+    std::vector<const int64_t*> column_pointers;
+    for (size_t r = 0; r < records; r++) {
+        columns[0][r] = 800 + static_cast<int64_t>(random() % 1200);
+        columns[1][r] = static_cast<int64_t>(random() % 30);
+        columns[2][r] = 120 + static_cast<int64_t>(random() % 80);
+    }
+    for (const auto& column : columns) column_pointers.push_back(column.data());
+
+    const int batch_repetitions = 5;
+    std::vector<std::pair<std::string, const std::vector<std::string>*>> batch_programs = {
+        {"salario_neto", &salary_program}, {"bono", &bonus_program}};
+    for (const auto& [name, code] : batch_programs) {
+        // Los resultados se escriben en un arreglo ya reservado, igual que en la VM por registro
+        BatchExecutor batch(*code);
+        std::vector<int64_t> batch_results(records);
+        auto start = std::chrono::steady_clock::now();
+        for (int r = 0; r < batch_repetitions; r++) batch.run(name, column_pointers, records, batch_results.data());
+        double batch_seconds = seconds_since(start) / batch_repetitions;
+
+        // La misma ejecución por lotes con la versión genérica (SSE2 en x86-64)
+        BatchExecutor::Options generic_options;
+        generic_options.dispatch = false;
+        BatchExecutor generic(*code, generic_options);
+        std::vector<int64_t> generic_results(records);
+        start = std::chrono::steady_clock::now();
+        for (int r = 0; r < batch_repetitions; r++) generic.run(name, column_pointers, records, generic_results.data());
+        double generic_seconds = seconds_since(start) / batch_repetitions;
+        if (generic_results != batch_results) {
+            std::cerr << "Resultados distintos entre las versiones de los lotes de " << name << std::endl;
+            return 1;
+        }
+
+        BytecodeCompiler compiler;
+        BytecodeModule module = compiler.compile(*code);
+        VirtualMachine vm;
+        std::vector<int64_t> args(3);
+        start = std::chrono::steady_clock::now();
+        for (size_t r = 0; r < records; r++) {
+            for (size_t i = 0; i < 3; i++) args[i] = columns[i][r];
+            if (vm.run(module, name, args) != batch_results[r]) {
+                std::cerr << "Resultados distintos en el registro " << r << " de " << name << std::endl;
+                return 1;
+            }
+        }
+        double vm_seconds = seconds_since(start);
+
+        // El intérprete de texto es lento: se mide sobre una parte de los registros
+        const size_t text_records = records / 64;
+        TextInterpreter interpreter(*code);
+        start = std::chrono::steady_clock::now();
+        for (size_t r = 0; r < text_records; r++) {
+            for (size_t i = 0; i < 3; i++) args[i] = columns[i][r];
+            if (interpreter.run(name, args) != batch_results[r]) {
+                std::cerr << "Resultados distintos en el registro " << r << " de " << name << std::endl;
+                return 1;
+            }
+        }
+        double text_seconds = seconds_since(start) * (static_cast<double>(records) / text_records);
+
+        std::cout << "\nLotes: " << records << " registros de " << name << ", " << BatchExecutor::lanes
+                  << " carriles, " << batch.last_stats().divergent_branches << " saltos divergentes, "
+                  << batch.instruction_set() << std::endl;
+        std::cout << std::left << std::setw(22) << "Modo" << std::right << std::setw(14) << "Tiempo (s)"
+                  << std::setw(18) << "Registros (M/s)" << std::setw(14) << "vs. VM" << std::endl;
+        std::vector<std::pair<std::string, double>> modes = {
+            {"Texto por registro", text_seconds}, {"VM por registro", vm_seconds},
+            {"Lotes (genérico)", generic_seconds}, {std::string("Lotes (") + batch.instruction_set() + ")", batch_seconds}};
+        for (const auto& [mode, seconds] : modes) {
+            std::cout << std::left << std::setw(22) << mode << std::right << std::fixed << std::setprecision(4)
+                      << std::setw(14) << seconds << std::setprecision(2) << std::setw(18) << records / seconds / 1e6
+                      << std::setw(13) << vm_seconds / seconds << "x" << std::endl;
+        }
+    }
+
+    return 0;
+}